@@ -4,6 +4,7 @@
 	Copyright (c) 2021 Andrew Trotman
 	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
 */
+#include "simd.h"
 #include "timer.h"
 #include "threads.h"
 #include "run_export.h"
@@ -120,6 +121,13 @@ JASS_ERROR JASS_anytime_api::load_index(size_t index_version, const std::string
 			return JASS_ERROR_TOO_MANY_DOCUMENTS;
 			}
 
+		/*
+			Choose the SIMD kernels (cumulative sum, sort) for this CPU.  A portable build can then use AVX-512 if it is there.
+		*/
+		JASS::simd::set_simd_level(JASS::hardware_support::best_simd());
+		if (verbose)
+			std::cout << "SIMD level:" << (JASS::simd::get_simd_level() == JASS::hardware_support::avx512 ? "AVX-512" : JASS::simd::get_simd_level() == JASS::hardware_support::avx2 ? "AVX2" : "scalar") << "\n";
+
 		/*
 			Set up the accumulators array (and other thread-local data). First the Score-at-a-Time table
 		*/
@@ -563,6 +571,10 @@ void JASS_anytime_api::anytime(JASS_anytime_thread_result &output, std::vector<J
 			}
 		rsv_at_k = rsv_at_k == 0 ? 1 : rsv_at_k;			// rsv_at_k cannot be 0 (because at least one search term must be in the document)
 
+		/*
+			No more documents than postings can be touched, so short queries on rare terms can use a sparse accumulator table
+		*/
+		local.jass_query->expect_documents(total_postings_for_query);
 		local.jass_query->rewind(smallest_possible_rsv, rsv_at_k, largest_possible_rsv);
 //std::cout << "MAXRSV:" << largest_possible_rsv << " MINRSV:" << smallest_possible_rsv << "\n";
 
@@ -579,7 +591,7 @@ void JASS_anytime_api::anytime(JASS_anytime_thread_result &output, std::vector<J
 		for (auto *header = local.segment_order.get(); header < current_segment; header++)
 			{
 			if (scale_rsv_scores)
-				header->impact = (JASS::query::ACCUMULATOR_TYPE)((double)header->impact / (double)largest_possible_rsv_with_overflow * ((double)JASS::query::MAX_RSV - query_terms_count) + 1);
+				header->impact = (JASS::query::RSV_TYPE)((double)header->impact / (double)largest_possible_rsv_with_overflow * ((double)JASS::query::MAX_RSV - query_terms_count) + 1);
 
 //std::cout << "Process Segment->(" << header->impact << ":" << header->segment_frequency << ")\n";
 			/*
@@ -594,7 +606,7 @@ void JASS_anytime_api::anytime(JASS_anytime_thread_result &output, std::vector<J
 			/*
 				Process the postings
 			*/
-			JASS::query::ACCUMULATOR_TYPE impact = header->impact;
+			JASS::query::RSV_TYPE impact = header->impact;
 			local.jass_query->decode_and_process(impact, header->segment_frequency, index->postings() + header->offset, header->end - header->offset);
 
 			/*
@@ -625,7 +637,7 @@ void JASS_anytime_api::anytime(JASS_anytime_thread_result &output, std::vector<J
 			Serialise the results list (don't time this)
 		*/
 		std::ostringstream results_list;
-#if defined(ACCUMULATOR_64s) || defined(QUERY_HEAP) || defined(QUERY_MAXBLOCK_HEAP)
+#if defined(ACCUMULATOR_64s) || defined(QUERY_HEAP) || defined(QUERY_MAXBLOCK_HEAP) || defined(QUERY_HEAP_OVERFLOW) || defined(QUERY_HISTOGRAM)
 		JASS::run_export(JASS::run_export::TREC, results_list, query_id.c_str(), *local.jass_query, "JASSv2", true, true);
 #else
 		JASS::run_export(JASS::run_export::TREC, results_list, query_id.c_str(), *local.jass_query, "JASSv2", true, false);
@@ -7,12 +7,17 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <memory>
+#include <sstream>
 #include <algorithm>
 #include <exception>
 
+#include "file.h"
 #include "ascii.h"
+#include "timer.h"
 #include "query_heap.h"
 #include "string_cpp.h"
+#include "commandline.h"
 #include "channel_file.h"
 #include "parser_query.h"
 #include "allocator_pool.h"
@@ -23,7 +28,7 @@
 /*
 	If the line below is enabled then the global operator new and operator delete methods are overwridden
 	to check whether any memory is allocated during the processing of a query.  If the line is commented
-	out then the checks are disabled and the global operators are not overridden. 
+	out then the checks are disabled and the global operators are not overridden.
 */
 //#define ENSURE_NO_ALLOCATIONS false				// uncomment this line to check for spurious memory allocations
 
@@ -37,94 +42,204 @@
 extern std::vector<std::string> primary_key;
 
 /*
-	MAIN()
-	------
+	PARAMETERS
+	----------
+*/
+static std::string parameter_queryfilename;							///< Name of file containing the queries (if not given then read from stdin)
+static size_t parameter_top_k = 10;									///< Number of results to return
+static bool parameter_help = false;									///< Print the usage information
+
+static std::string parameters_errors;								///< Any errors as a result of command line parsing
+static auto parameters = std::make_tuple							///< The  command line parameter block
+	(
+	JASS::commandline::parameter("-?", "--help",      "           Print this help.", parameter_help),
+	JASS::commandline::parameter("-k", "--top-k",     "<top-k>    Number of results to return to the user (top-k value) [default = -k10]", parameter_top_k),
+	JASS::commandline::parameter("-q", "--queryfile", "<filename> Name of file containing a list of queries (1 per line, each line prefixed with query-id) [default = interactive]", parameter_queryfilename)
+	);
+
+/*
+	USAGE()
+	-------
 */
-int main(int argc, char *argv[])
+static uint8_t usage(const std::string &exename)
 	{
-	try
+	std::cout << JASS::commandline::usage(exename, parameters) << "\n";
+	return 1;
+	}
+
+/*
+	SEARCH()
+	--------
+*/
+/*!
+	@brief Search for the given query and sort the top-k.
+	@param jass_query [in] The query object (re-used from query to query).
+	@param query [in] The query, a TREC style query number might be the first term.
+	@return The query number (or 0 if there is none).
+*/
+static uint64_t search(JASS::query_heap &jass_query, const std::string &query)
+	{
+	/*
+		Parse the query then iterate over the terms
+	*/
+	jass_query.rewind();
+	jass_query.parse(query);
+	uint32_t term_number = 0;
+	uint64_t query_id = 0;
+	for (const auto &term : jass_query.terms())
 		{
 		/*
-			Sort the dictionary - because it was probably generated in the
-			order of the hash-table which isn't alphabetical.
+			if the first term in the query is numeric then assume its a TREC style query number.
 		*/
-		std::sort(&dictionary[0], &dictionary[dictionary_length]);
+		if (term_number == 0 && JASS::ascii::isdigit(term.token()[0]))
+			{
+			query_id = atol(reinterpret_cast<const char *>(term.token().address()));
+			continue;
+			}
+		term_number++;
 
 		/*
-			Use a JASS channel to read the input query
+			Search the vocabulary for the query term and if we find it all the attached method to process the postings.
 		*/
-		JASS::channel_file input;							// read from here
-		JASS::channel_file output;							// write to here.
+		auto low = std::lower_bound (&dictionary[0], &dictionary[dictionary_length], JASS_ci_vocab(term.token()));
+		if ((low != &dictionary[dictionary_length] && !(JASS_ci_vocab(term.token()) < *low)))
+			low->method(jass_query);
+		}
+
+	jass_query.sort();
+
+	return query_id;
+	}
 
-		while (1)
+/*
+	MAIN_EVENT()
+	------------
+*/
+static int main_event(int argc, const char *argv[])
+	{
+	/*
+		Parse the command line parameters
+	*/
+	if (!JASS::commandline::parse(argc, argv, parameters, parameters_errors))
+		{
+		std::cout << parameters_errors;
+		return 1;
+		}
+	if (parameter_help)
+		return usage(argv[0]);
+	if (parameter_top_k > JASS::query::MAX_TOP_K)
+		{
+		std::cout << "The top-k specified (" << parameter_top_k << ") is larger than maximum TOP-K (" << JASS::query::MAX_TOP_K << ")\n";
+		return 1;
+		}
+
+	/*
+		Sort the dictionary - because it was probably generated in the
+		order of the hash-table which isn't alphabetical.
+	*/
+	std::sort(&dictionary[0], &dictionary[dictionary_length]);
+
+	/*
+		Allocate the query object once and re-use it for every query.  Documents are numbered from 1 (primary_key[0] is a place holder)
+		so the accumulators must be one larger than the number of documents.
+	*/
+	auto jass_query = std::make_unique<JASS::query_heap>();
+	jass_query->init(primary_key, static_cast<JASS::query::DOCID_TYPE>(primary_key.size()), parameter_top_k);
+
+	if (parameter_queryfilename != "")
+		{
+		/*
+			Batch mode: search for each query in the file, timing each, and write the run and the timings to disk
+		*/
+		JASS::channel_file input(parameter_queryfilename);
+		std::ostringstream TREC_file;
+		std::ostringstream stats_file;
+		std::string query;
+		size_t queries = 0;
+		uint64_t total_search_time_in_ns = 0;
+
+		stats_file << "<JASSv2stats>\n";
+		for (input.gets(query); query.size() != 0; input.gets(query))
 			{
-			/*
-				If we're checking to make sure that no memory allocation (outside JASS custom allocation) then turn
-				off checking for the sole purpose of allocating the arena.
-			*/
-			#ifdef ENSURE_NO_ALLOCATIONS
-				global_new_delete_return();					// disable checking
-				JASS::allocator_pool memory;				// allocate memory
-				global_new_delete_replace();				// enable checking
-			#else
-				JASS::allocator_pool memory;				// allocate memory
-			#endif
-			
-			JASS::string query(memory);					// allocate a string to read into
-
-			auto jass_query_memory = std::make_shared<JASS::query_heap>();	// allocate a JASS query object
-			jass_query_memory->init(primary_key, 1024, 10);
-			auto &jass_query = *jass_query_memory.get();		// pretend its an object
-
-			/*
-				Read a query from a user
-			*/
-			std::cout << "]";
-			input.gets(query);
-
-			/*
-				Check to see if we're at the end of the query stream
-			*/
-			if (query.compare(0, 5, ".quit") == 0)
-				break;
-
-#ifdef NEVER
-			/*
-				Echo the query
-			*/
-			output << query;
-#endif
-			/*
-				Parse the query then iterate over the terms
-			*/
-			jass_query.parse(query);
-			uint32_t term_number = 0;
-			uint64_t query_id = 0;
-			for (const auto &term : jass_query.terms())
-				{
-				/*
-					if the first term in the query is numeric then assume its a TREC style query number.
-				*/
-				if (term_number == 0 && JASS::ascii::isdigit(term.token()[0]))
-					{
-					query_id = atol(reinterpret_cast<const char *>(term.token().address()));
-					continue;
-					}
-				term_number++;
-
-				/*
-					Search the vocabulary for the query term and if we find it all the attached method to process the postings.
-				*/
-				auto low = std::lower_bound (&dictionary[0], &dictionary[dictionary_length], JASS_ci_vocab(term.token()));
-				if ((low != &dictionary[dictionary_length] && !(JASS_ci_vocab(term.token()) < *low)))
-					low->method(jass_query);
-				}
-
-			/*
-				Dump the top-k to the output in trec_eval format.
-			*/
-			JASS::run_export_trec(std::cout, query_id, jass_query, "JASSv2", true, false);
+			query.erase(query.find_last_not_of(" \t\f\v\n\r") + 1);
+			if (query.size() == 0)
+				continue;
+
+			auto timer = JASS::timer::start();
+			auto query_id = search(*jass_query, query);
+			auto search_time_in_ns = JASS::timer::stop(timer).nanoseconds();
+
+			JASS::run_export_trec(TREC_file, query_id, *jass_query, "JASSv2", true, true);
+			stats_file << "<id>" << query_id << "</id><query>" << query << "</query><time_ns>" << search_time_in_ns << "</time_ns>\n";
+
+			total_search_time_in_ns += search_time_in_ns;
+			queries++;
 			}
+		stats_file << "</JASSv2stats>\n";
+
+		JASS::file::write_entire_file("ranking.txt", TREC_file.str());
+		JASS::file::write_entire_file("JASSv2Stats.txt", stats_file.str());
+
+		std::cout << "Documents          :" << primary_key.size() - 1 << "\n";
+		std::cout << "Terms              :" << dictionary_length << "\n";
+		std::cout << "Queries            :" << queries << "\n";
+		std::cout << "Total search time  :" << total_search_time_in_ns << " ns\n";
+		std::cout << "Mean time per query:" << (queries == 0 ? 0 : total_search_time_in_ns / queries) << " ns\n";
+		return 0;
+		}
+
+	/*
+		Interactive mode: use a JASS channel to read the input queries
+	*/
+	JASS::channel_file input;							// read from here
+	std::string query;
+
+	/*
+		If we're checking to make sure that no memory allocation (outside JASS custom allocation) then turn
+		on checking once all the memory the search loop needs has been allocated.
+	*/
+	#ifdef ENSURE_NO_ALLOCATIONS
+		query.reserve(1024);
+		global_new_delete_replace();				// enable checking
+	#endif
+
+	while (1)
+		{
+		/*
+			Read a query from a user
+		*/
+		std::cout << "]";
+		input.gets(query);
+
+		/*
+			Check to see if we're at the end of the query stream
+		*/
+		if (query.size() == 0 || query.compare(0, 5, ".quit") == 0)
+			break;
+
+		/*
+			Search then dump the top-k to the output in trec_eval format.
+		*/
+		auto query_id = search(*jass_query, query);
+		JASS::run_export_trec(std::cout, query_id, *jass_query, "JASSv2", true, true);
+		}
+
+	#ifdef ENSURE_NO_ALLOCATIONS
+		global_new_delete_return();					// disable memorty checking (so that the memory object can be deallocated without fuss).
+	#endif
+
+	return 0;
+	}
+
+/*
+	MAIN()
+	------
+*/
+int main(int argc, const char *argv[])
+	{
+	try
+		{
+		return main_event(argc, argv);
 		}
 	catch (std::exception &error)
 		{
@@ -135,8 +250,5 @@ int main(int argc, char *argv[])
 		printf("CAUGHT AN EXCEPTION OF UNKNOWN TYPE)\n");
 		}
 
-	#ifdef ENSURE_NO_ALLOCATIONS
-		global_new_delete_return();					// disable memorty checking (so that the memory object can be deallocated without fuss).
-	#endif
-	return 0;
+	return 1;
 	}
@@ -1,4 +1,6 @@
-#include "streamvbyte.h"
+// LCOV_EXCL_START
+
+#include "../include/streamvbyte.h"
 #if defined(_MSC_VER)
 /* Microsoft C/C++-compatible compiler */
 #include <intrin.h>
@@ -159,7 +161,7 @@ static __m128i _write_avx_d1(uint32_t *out, __m128i Vec, __m128i Prev) {
 }
 
 #ifndef _MSC_VER
-static __m128i High16To32 = {0xFFFF0B0AFFFF0908, 0xFFFF0F0EFFFF0D0C};
+static __m128i High16To32 = {(long long)0xFFFF0B0AFFFF0908, (long long)0xFFFF0F0EFFFF0D0C};
 #else
 static __m128i High16To32 = {8,  9,  -1, -1, 10, 11, -1, -1,
                              12, 13, -1, -1, 14, 15, -1, -1};
@@ -355,3 +357,4 @@ size_t streamvbyte_delta_decode(const uint8_t *in, uint32_t *out,
   return svb_decode_scalar_d1_init(out, keyPtr, dataPtr, count, prev) - in;
 #endif
 }
+// LCOV_EXCL_STOP
@@ -385,7 +385,7 @@ namespace JASS
 				@param element [in] The accumulator numbers.
 				@return The clean flag numbers.
 			*/
-			forceinline __m512i which_dirty_flag(__m512i element) const
+			JASS_TARGET_AVX512 forceinline __m512i which_dirty_flag(__m512i element) const
 				{
 				return _mm512_srli_epi32(element, shift);
 				}
@@ -402,7 +402,7 @@ namespace JASS
 				@param which [in] The accumulators to return.
 				@return The values of the accumulators.
 			*/
-			forceinline __m512i operator[](__m512i which)
+			JASS_TARGET_AVX512 forceinline __m512i operator[](__m512i which)
 				{
 				__m512i indexes = which_dirty_flag(which);
 				__m512i flags = simd::gather(&dirty_flag[0], indexes);
@@ -448,6 +448,46 @@ namespace JASS
 #endif
 				}
 
+			/*
+				ACCUMULATOR_2D::SCATTER()
+				-------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+				@details There is no 8-bit scatter instruction and emulating one with masked 32-bit scatters (simd::scatter()) measured
+				twice as slow as spilling the vectors and storing each lane, so the latter is used.
+			*/
+			forceinline void scatter(__m256i which, __m256i values)
+				{
+				alignas(32) uint32_t lane[8];
+				alignas(32) uint32_t value[8];
+				_mm256_store_si256(reinterpret_cast<__m256i *>(lane), which);
+				_mm256_store_si256(reinterpret_cast<__m256i *>(value), values);
+				for (size_t element = 0; element < 8; element++)
+					accumulator[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
+			/*
+				ACCUMULATOR_2D::SCATTER()
+				-------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+			*/
+			JASS_TARGET_AVX512 forceinline void scatter(__m512i which, __m512i values)
+				{
+				alignas(64) uint32_t lane[16];
+				alignas(64) uint32_t value[16];
+				_mm512_store_si512(lane, which);
+				_mm512_store_si512(value, values);
+				for (size_t element = 0; element < 16; element++)
+					accumulator[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
 			/*
 				ACCUMULATOR_2D::GET_INDEX()
 				---------------------------
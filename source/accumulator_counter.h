@@ -19,7 +19,9 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <immintrin.h>
 
+#include "simd.h"
 #include "maths.h"
 #include "forceinline.h"
 
@@ -151,6 +153,137 @@ namespace JASS
 				return accumulator[which];
 				}
 
+			/*
+				ACCUMULATOR_COUNTER::CLEAN_FLAGS()
+				----------------------------------
+			*/
+			/*!
+				@brief Return the clean flags of a set of accumulators, one per 32-bit lane.
+				@param which [in] The accumulators.
+				@return The clean flags.
+			*/
+			forceinline __m256i clean_flags(__m256i which) const
+				{
+				if constexpr (COUNTER_BITSIZE == 8)
+					return simd::gather(&clean_flag[0], which);
+				else
+					{
+					__m256i flags = simd::gather(&clean_flag[0], _mm256_srli_epi32(which, 1));
+					__m256i shift = _mm256_slli_epi32(_mm256_and_si256(which, _mm256_set1_epi32(1)), 2);
+					return _mm256_and_si256(_mm256_srlv_epi32(flags, shift), _mm256_set1_epi32(max_clean_id));
+					}
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::CLEAN_FLAGS()
+				----------------------------------
+			*/
+			/*!
+				@brief Return the clean flags of a set of accumulators, one per 32-bit lane.
+				@param which [in] The accumulators.
+				@return The clean flags.
+			*/
+			JASS_TARGET_AVX512 forceinline __m512i clean_flags(__m512i which) const
+				{
+				if constexpr (COUNTER_BITSIZE == 8)
+					return simd::gather(&clean_flag[0], which);
+				else
+					{
+					__m512i flags = simd::gather(&clean_flag[0], _mm512_srli_epi32(which, 1));
+					__m512i shift = _mm512_slli_epi32(_mm512_and_epi32(which, _mm512_set1_epi32(1)), 2);
+					return _mm512_and_epi32(_mm512_srlv_epi32(flags, shift), _mm512_set1_epi32(max_clean_id));
+					}
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::OPERATOR[]()
+				---------------------------------
+			*/
+			/*!
+				@brief Return a set of accumulators
+				@details The clean flags of all the accumulators are checked at once and only those that are stale are initialised (one at a time).
+				@param which [in] The accumulators to return.
+				@return The values of the accumulators.
+			*/
+			forceinline __m256i operator[](__m256i which)
+				{
+				__m256i current = _mm256_cmpeq_epi32(clean_flags(which), _mm256_set1_epi32(clean_id));
+				uint32_t stale = ~_mm256_movemask_ps(_mm256_castsi256_ps(current)) & 0xFF;
+				if (stale != 0)
+					{
+					alignas(32) uint32_t lane[8];
+					_mm256_store_si256(reinterpret_cast<__m256i *>(lane), which);
+					do
+						(*this)[lane[_tzcnt_u32(stale)]];
+					while ((stale &= stale - 1) != 0);
+					}
+
+				return simd::gather(&accumulator[0], which);
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::OPERATOR[]()
+				---------------------------------
+			*/
+			/*!
+				@brief Return a set of accumulators
+				@details The clean flags of all the accumulators are checked at once and only those that are stale are initialised (one at a time).
+				@param which [in] The accumulators to return.
+				@return The values of the accumulators.
+			*/
+			JASS_TARGET_AVX512 forceinline __m512i operator[](__m512i which)
+				{
+				uint32_t stale = _mm512_cmpneq_epi32_mask(clean_flags(which), _mm512_set1_epi32(clean_id));
+				if (stale != 0)
+					{
+					alignas(64) uint32_t lane[16];
+					_mm512_store_si512(lane, which);
+					do
+						(*this)[lane[_tzcnt_u32(stale)]];
+					while ((stale &= stale - 1) != 0);
+					}
+
+				return simd::gather(&accumulator[0], which);
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::SCATTER()
+				------------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+			*/
+			forceinline void scatter(__m256i which, __m256i values)
+				{
+				alignas(32) uint32_t lane[8];
+				alignas(32) uint32_t value[8];
+				_mm256_store_si256(reinterpret_cast<__m256i *>(lane), which);
+				_mm256_store_si256(reinterpret_cast<__m256i *>(value), values);
+				for (size_t element = 0; element < 8; element++)
+					accumulator[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::SCATTER()
+				------------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+			*/
+			JASS_TARGET_AVX512 forceinline void scatter(__m512i which, __m512i values)
+				{
+				alignas(64) uint32_t lane[16];
+				alignas(64) uint32_t value[16];
+				_mm512_store_si512(lane, which);
+				_mm512_store_si512(value, values);
+				for (size_t element = 0; element < 16; element++)
+					accumulator[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
 			/*
 				ACCUMULTOR_COUNTER::GET_INDEX()
 				-------------------------------
@@ -199,6 +332,50 @@ namespace JASS
 				clean_id++;
 				}
 
+			/*
+				ACCUMULATOR_COUNTER::UNITTEST_VECTOR_512()
+				------------------------------------------
+			*/
+			/*!
+				@brief Unit test the AVX-512 interface by adding 2 to accumulators 16, 18, ... 46 (only call if the CPU has AVX-512).
+				@param array [in] The accumulators to use.
+			*/
+			JASS_TARGET_AVX512 static void unittest_vector_512(accumulator_counter<uint8_t, 64, 4> &array)
+				{
+				__m512i which = _mm512_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46);
+				array.scatter(which, _mm512_add_epi32(array[which], _mm512_set1_epi32(2)));
+				}
+
+			/*
+				ACCUMULATOR_COUNTER::UNITTEST_VECTOR()
+				--------------------------------------
+			*/
+			/*!
+				@brief Unit test the vector interface (gather, add, scatter) of an array of 64 8-bit accumulators
+				@param array [in] The accumulators to use.
+			*/
+			static void unittest_vector(accumulator_counter<uint8_t, 64, 4> &array)
+				{
+				array.init(64);
+				array.rewind();
+				array[3] = 7;
+
+				__m256i which = _mm256_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15);
+				array.scatter(which, _mm256_add_epi32(array[which], _mm256_set1_epi32(1)));
+
+				bool avx512 = simd::get_simd_level() >= hardware_support::avx512;
+				if (avx512)
+					unittest_vector_512(array);
+
+				for (size_t element = 0; element < 48; element++)
+					if (element == 3)
+						JASS_assert(array.get_value(element) == 8);
+					else if (element < 16)
+						JASS_assert(array.get_value(element) == (element & 1));
+					else
+						JASS_assert(array.get_value(element) == ((avx512 && (element & 1) == 0) ? 2 : 0));
+				}
+
 			/*
 				ACCUMULATOR_COUNTER::UNITTEST()
 				-------------------------------
@@ -238,6 +415,12 @@ namespace JASS
 				for (size_t element = 0; element < array.size(); element++)
 					JASS_assert(array[element] == element);
 
+				/*
+					Check the vector interface using 4-bit counters (so that neighbouring accumulators share a flag byte)
+				*/
+				accumulator_counter<uint8_t, 64, 4> bytes;
+				unittest_vector(bytes);
+
 				puts("accumulator_counter::PASSED");
 				}
 		};
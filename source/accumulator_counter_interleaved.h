@@ -20,7 +20,9 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <immintrin.h>
 
+#include "simd.h"
 #include "maths.h"
 #include "forceinline.h"
 
@@ -282,6 +284,84 @@ namespace JASS
 				return accumulator_chunk[chunk].allocate_accumulator(part_of_chunk, clean_id);
 				}
 
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::OPERATOR[]()
+				--------------------------------------------
+			*/
+			/*!
+				@brief Return a set of accumulators
+				@details The accumulators are interleaved with their clean flags so they cannot be gathered, each is initialised and read in turn.
+				@param which [in] The accumulators to return.
+				@return The values of the accumulators.
+			*/
+			forceinline __m256i operator[](__m256i which)
+				{
+				alignas(32) uint32_t lane[8];
+				_mm256_store_si256(reinterpret_cast<__m256i *>(lane), which);
+				for (auto &element : lane)
+					element = (*this)[element];
+
+				return _mm256_load_si256(reinterpret_cast<__m256i *>(lane));
+				}
+
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::OPERATOR[]()
+				--------------------------------------------
+			*/
+			/*!
+				@brief Return a set of accumulators
+				@details The accumulators are interleaved with their clean flags so they cannot be gathered, each is initialised and read in turn.
+				@param which [in] The accumulators to return.
+				@return The values of the accumulators.
+			*/
+			JASS_TARGET_AVX512 forceinline __m512i operator[](__m512i which)
+				{
+				alignas(64) uint32_t lane[16];
+				_mm512_store_si512(lane, which);
+				for (auto &element : lane)
+					element = (*this)[element];
+
+				return _mm512_load_si512(lane);
+				}
+
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::SCATTER()
+				-----------------------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+			*/
+			forceinline void scatter(__m256i which, __m256i values)
+				{
+				alignas(32) uint32_t lane[8];
+				alignas(32) uint32_t value[8];
+				_mm256_store_si256(reinterpret_cast<__m256i *>(lane), which);
+				_mm256_store_si256(reinterpret_cast<__m256i *>(value), values);
+				for (size_t element = 0; element < 8; element++)
+					(*this)[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::SCATTER()
+				-----------------------------------------
+			*/
+			/*!
+				@brief Write back a set of accumulators previously returned by operator[]().
+				@param which [in] The accumulators to write (no two may be the same).
+				@param values [in] The values to write, one per 32-bit lane (truncated to ELEMENT).
+			*/
+			JASS_TARGET_AVX512 forceinline void scatter(__m512i which, __m512i values)
+				{
+				alignas(64) uint32_t lane[16];
+				alignas(64) uint32_t value[16];
+				_mm512_store_si512(lane, which);
+				_mm512_store_si512(value, values);
+				for (size_t element = 0; element < 16; element++)
+					(*this)[lane[element]] = static_cast<ELEMENT>(value[element]);
+				}
+
 			/*
 				ACCUMULTOR_COUNTER_INTERLEAVED::GET_INDEX()
 				-------------------------------------------
@@ -336,6 +416,50 @@ namespace JASS
 				clean_id++;
 				}
 
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::UNITTEST_VECTOR_512()
+				-----------------------------------------------------
+			*/
+			/*!
+				@brief Unit test the AVX-512 interface by adding 2 to accumulators 16, 18, ... 46 (only call if the CPU has AVX-512).
+				@param array [in] The accumulators to use.
+			*/
+			JASS_TARGET_AVX512 static void unittest_vector_512(accumulator_counter_interleaved<uint8_t, 64, 8> &array)
+				{
+				__m512i which = _mm512_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30, 32, 34, 36, 38, 40, 42, 44, 46);
+				array.scatter(which, _mm512_add_epi32(array[which], _mm512_set1_epi32(2)));
+				}
+
+			/*
+				ACCUMULTOR_COUNTER_INTERLEAVED::UNITTEST_VECTOR()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Unit test the vector interface (gather, add, scatter) of an array of 64 8-bit accumulators
+				@param array [in] The accumulators to use.
+			*/
+			static void unittest_vector(accumulator_counter_interleaved<uint8_t, 64, 8> &array)
+				{
+				array.init(64);
+				array.rewind();
+				array[3] = 7;
+
+				__m256i which = _mm256_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15);
+				array.scatter(which, _mm256_add_epi32(array[which], _mm256_set1_epi32(1)));
+
+				bool avx512 = simd::get_simd_level() >= hardware_support::avx512;
+				if (avx512)
+					unittest_vector_512(array);
+
+				for (size_t element = 0; element < 48; element++)
+					if (element == 3)
+						JASS_assert(array.get_value(element) == 8);
+					else if (element < 16)
+						JASS_assert(array.get_value(element) == (element & 1));
+					else
+						JASS_assert(array.get_value(element) == ((avx512 && (element & 1) == 0) ? 2 : 0));
+				}
+
 			/*
 				ACCUMULTOR_COUNTER_INTERLEAVED::UNITTEST()
 				------------------------------------------
@@ -375,6 +499,12 @@ namespace JASS
 				for (size_t element = 0; element < array.size(); element++)
 					JASS_assert(array[element] == element);
 
+				/*
+					Check the vector interface
+				*/
+				accumulator_counter_interleaved<uint8_t, 64, 8> bytes;
+				unittest_vector(bytes);
+
 				puts("accumulator_counter_interleaved::PASSED");
 				}
 		};
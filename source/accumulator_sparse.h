@@ -0,0 +1,250 @@
+/*
+	ACCUMULATOR_SPARSE.H
+	--------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Store the accumulators in an open-addressed hash table keyed on document id.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <map>
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "maths.h"
+#include "asserts.h"
+#include "forceinline.h"
+
+namespace JASS
+	{
+	/*
+		CLASS ACCUMULATOR_SPARSE
+		------------------------
+	*/
+	/*!
+		@brief Store the accumulators in an open-addressed (linear probing) hash table keyed on document id.
+		@details The other accumulator classes are sized to the collection, and so are the costs of rewind() and of
+		initialising an accumulator (accumulator_2d clears a whole row).  For a query that touches few documents those costs
+		dominate.  This class is sized (at rewind()) from an upper bound on the number of documents the query can touch so
+		all its costs are proportional to the query, not the collection.  The table is never resized during a query so
+		pointers to accumulators are stable (and can be stored in a heap), and it is at most half full so probe sequences
+		are short.
+		@tparam ELEMENT The type of accumulator being used
+	*/
+	template <typename ELEMENT>
+	class accumulator_sparse
+		{
+		private:
+			static constexpr uint32_t empty = (std::numeric_limits<uint32_t>::max)();		///< The key of an unused slot (not a valid document id)
+
+		public:
+			std::vector<uint32_t> key;						///< The document id stored in each slot (or empty)
+			std::vector<ELEMENT> accumulator;			///< The accumulator in each slot
+			size_t slots;										///< The number of slots in use for this query (a power of 2)
+			size_t shift;										///< The amount to shift the (32-bit) hash by to get a slot number
+			size_t maximum_documents;						///< The largest number of documents rewind() can be asked for
+
+		private:
+			/*
+				ACCUMULATOR_SPARSE::SLOTS_NEEDED()
+				----------------------------------
+			*/
+			/*!
+				@brief Return the size of table needed to hold the given number of documents at most half full.
+				@param documents [in] The number of documents.
+				@return A whole power of 2 at least twice documents (and at least 16).
+			*/
+			static size_t slots_needed(size_t documents)
+				{
+				return (size_t)1 << (maths::floor_log2(maths::maximum(documents * 2, (size_t)16) - 1) + 1);
+				}
+
+		public:
+			/*
+				ACCUMULATOR_SPARSE::ACCUMULATOR_SPARSE()
+				----------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+			*/
+			accumulator_sparse() :
+				slots(0),
+				shift(32),
+				maximum_documents(0)
+				{
+				/* Nothing */
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::INIT()
+				--------------------------
+			*/
+			/*!
+				@brief Initialise this object before first use.
+				@param maximum_documents [in] The largest number of documents any one query will touch (larger queries should use a different accumulator class).
+			*/
+			void init(size_t maximum_documents)
+				{
+				this->maximum_documents = maximum_documents;
+				key.assign(slots_needed(maximum_documents), empty);
+				accumulator.resize(key.size());
+				slots = 0;
+				rewind(0);
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::OPERATOR[]()
+				--------------------------------
+			*/
+			/*!
+				@brief Return a reference to the accumulator for the given document, adding it (as 0) if it isn't already in the table.
+				@param document_id [in] The document.
+				@return A reference to the accumulator.
+			*/
+			forceinline ELEMENT &operator[](uint32_t document_id)
+				{
+				size_t slot = static_cast<uint32_t>(document_id * 2654435761U) >> shift;
+
+				while (true)
+					{
+					uint32_t in_slot = key[slot];
+					if (in_slot == document_id)
+						return accumulator[slot];
+					if (in_slot == empty)
+						{
+						key[slot] = document_id;
+						accumulator[slot] = 0;
+						return accumulator[slot];
+						}
+					slot = (slot + 1) & (slots - 1);
+					}
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::GET_VALUE()
+				-------------------------------
+			*/
+			/*!
+				@brief Return the value of the given accumulator
+				@details This interface does not add an accumulator, it returns 0 if the document is not in the table
+				@param document_id [in] The accumulator to return.
+				@return The accumulator value or 0.
+			*/
+			forceinline ELEMENT get_value(uint32_t document_id) const
+				{
+				size_t slot = static_cast<uint32_t>(document_id * 2654435761U) >> shift;
+
+				while (true)
+					{
+					uint32_t in_slot = key[slot];
+					if (in_slot == document_id)
+						return accumulator[slot];
+					if (in_slot == empty)
+						return 0;
+					slot = (slot + 1) & (slots - 1);
+					}
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::GET_INDEX()
+				-------------------------------
+			*/
+			/*!
+				@brief Given a pointer to an accumulator, return the document id
+				@param return a value such that get_index(&operator[](x)) == x
+			*/
+			forceinline size_t get_index(const ELEMENT *pointer) const
+				{
+				return key[pointer - &accumulator[0]];
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::IS_USED()
+				-----------------------------
+			*/
+			/*!
+				@brief Is the given slot in use in this query (used to iterate over the table)
+				@param slot [in] The slot (less than slots).
+				@return true if the slot holds an accumulator.
+			*/
+			forceinline bool is_used(size_t slot) const
+				{
+				return key[slot] != empty;
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::REWIND()
+				----------------------------
+			*/
+			/*!
+				@brief Clear the accumulators and size the table for the next query.
+				@details The cost is proportional to the size of the previous query plus the next query (not the collection).
+				@param documents [in] An upper bound on the number of distinct documents the next query will touch (no more than maximum_documents).
+			*/
+			void rewind(size_t documents)
+				{
+				std::fill(key.begin(), key.begin() + slots, empty);
+
+				slots = slots_needed(documents);
+				shift = 32 - maths::floor_log2(slots);
+				}
+
+			/*
+				ACCUMULATOR_SPARSE::UNITTEST()
+				------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				accumulator_sparse<ELEMENT> table;
+				table.init(1000);
+
+				std::mt19937 random(42);
+				for (size_t query = 0; query < 3; query++)
+					{
+					/*
+						Fill the table (to capacity on the last pass) and check against a std::map
+					*/
+					size_t documents = query == 2 ? 1000 : 100;
+					table.rewind(documents);
+					std::map<uint32_t, ELEMENT> expected;
+					while (expected.size() < documents)
+						{
+						uint32_t document_id = random() % 10'000'000;
+						table[document_id] += 3;
+						expected[document_id] += 3;
+						}
+					for (size_t which = 0; which < 1000; which++)
+						{
+						uint32_t document_id = random() % 10'000'000;
+						JASS_assert(table.get_value(document_id) == (expected.count(document_id) ? expected[document_id] : 0));
+						}
+
+					size_t found = 0;
+					for (size_t slot = 0; slot < table.slots; slot++)
+						if (table.is_used(slot))
+							{
+							found++;
+							size_t document_id = table.get_index(&table.accumulator[slot]);
+							JASS_assert(expected[document_id] == table.accumulator[slot]);
+							JASS_assert(&table[document_id] == &table.accumulator[slot]);
+							}
+					JASS_assert(found == documents);
+					}
+
+				puts("accumulator_sparse::PASSED");
+				}
+		};
+	}
@@ -68,20 +68,9 @@ namespace JASS
 	*/
 	size_t compress_general_zstd::decode(void *decoded, size_t destination_length, const void *source, size_t source_bytes)
 		{
-		/*
-		if (inflateReset(&instream) != Z_OK)
-			return 0;
-
-		instream.avail_in = source_bytes;
-		instream.next_in = (Bytef *)source;
-		instream.avail_out = destination_length;
-		instream.next_out = (Bytef *)decoded;
+		size_t decoded_length = ZSTD_decompress(decoded, destination_length, source, source_bytes);
 
-		auto status = inflate(&instream, Z_FINISH);
-
-		return status == Z_STREAM_END ? (destination_length - instream.avail_out) : 0;
-		*/
-		return 0;
+		return ZSTD_isError(decoded_length) ? 0 : decoded_length;
 		}
 		
 	/*
@@ -6,8 +6,10 @@
 */
 #include <stdint.h>
 
+#include <string>
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 #include "asserts.h"
 #include "compress_integer.h"
@@ -90,4 +92,48 @@ namespace JASS
 		JASS_assert(got == every_case.size());
 		JASS_assert(every_decoded == every_case);
 		}
+
+	/*
+		COMPRESS_INTEGER::UNITTEST_DECODE_WITH_WRITER()
+		-----------------------------------------------
+	*/
+	void compress_integer::unittest_decode_with_writer(compress_integer &compressor)
+		{
+		const size_t documents = 1000;
+		std::vector<std::string> primary_keys;
+		for (size_t document = 0; document < documents; document++)
+			primary_keys.push_back(std::to_string(document));
+		compressor.init(primary_keys, documents, documents);
+
+		/*
+			Lengths either side of the SIMD register widths so that the ends of the lists are checked.
+		*/
+		for (size_t length : {1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 127, 128, 129, 200, 300})
+			{
+			std::vector<integer> document_ids;
+			integer document_id = 2;
+			for (size_t posting = 0; posting < length; posting++)
+				{
+				document_ids.push_back(document_id);
+				document_id += 1 + (posting * 7) % 5;
+				}
+
+			std::vector<integer> gaps(length);
+			d1_encode(&gaps[0], &document_ids[0], length);
+			std::vector<uint8_t> compressed(length * sizeof(integer) * 2 + 1024);
+			size_t compressed_size = compressor.encode(&compressed[0], compressed.size(), &gaps[0], length);
+
+			compressor.rewind();
+			compressor.decode_and_process(3, length, &compressed[0], compressed_size);
+
+			std::vector<integer> found;
+			for (const auto &result : compressor)
+				{
+				JASS_assert(result.rsv == 3);
+				found.push_back(static_cast<integer>(result.document_id));
+				}
+			std::sort(found.begin(), found.end());
+			JASS_assert(found == document_ids);
+			}
+		}
 	}
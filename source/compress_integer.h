@@ -23,6 +23,8 @@
 #include "query_bucket.h"
 #include "query_maxblock.h"
 #include "query_maxblock_heap.h"
+#include "query_heap_overflow.h"
+#include "query_histogram.h"
 
 namespace JASS
 	{
@@ -42,6 +44,10 @@ namespace JASS
 	class compress_integer : public query_maxblock
 #elif defined(QUERY_MAXBLOCK_HEAP)
 	class compress_integer : public query_maxblock_heap
+#elif defined(QUERY_HEAP_OVERFLOW)
+	class compress_integer : public query_heap_overflow
+#elif defined(QUERY_HISTOGRAM)
+	class compress_integer : public query_histogram
 #elif defined(QUERY_HEAP)
 //	class compress_integer : public query_heap
 	class compress_integer : public query_heap_clean
@@ -241,6 +247,122 @@ namespace JASS
 			*/
 			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length) = 0;
 
+		protected:
+			static constexpr size_t FUSED_BLOCK_SIZE = 256;		///< The number of document ids a fused decoder places in decompress_buffer before adding them to the accumulators (this stays in the L1 cache).
+
+			/*
+				COMPRESS_INTEGER::ADD_RSV_BLOCK()
+				---------------------------------
+			*/
+			/*!
+				@brief Add the impact to each of the (up to) remaining documents at the start of decompress_buffer.
+				@param filled [in] The number of document ids (already d1 decoded) at the start of decompress_buffer.
+				@param remaining [in, out] The number of postings still to be processed, decreased by the number processed.
+				@return true if there are more postings to process, false if this was the last of them.
+			*/
+			forceinline bool add_rsv_block(size_t filled, size_t &remaining)
+				{
+				const DOCID_TYPE *document_ids = reinterpret_cast<const DOCID_TYPE *>(decompress_buffer.data());
+				size_t count = filled < remaining ? filled : remaining;
+				const DOCID_TYPE *end = document_ids + count;
+
+#if defined(__clang__)
+				#pragma unroll 8
+#elif defined(__GNUC__) || defined(__GNUG__)
+				#pragma GCC unroll 8
+#endif
+				for (const DOCID_TYPE *current = document_ids; current < end; current++)
+					add_rsv(*current, impact);
+
+				remaining -= count;
+				return remaining != 0;
+				}
+
+			/*
+				COMPRESS_INTEGER::ADD_RSV_D1_FUSED()
+				------------------------------------
+			*/
+			/*!
+				@brief Prefix sum a register of d-gaps (continuing from the previous register) and pass the document ids on to the accumulators.
+				@details This is the accumulate half of a fused decode-and-accumulate kernel.  A decoder's decode_with_writer() calls this with
+				each register of d-gaps as it is unpacked.  Rather than decoding the whole list into decompress_buffer then making two more passes
+				over it (the cumulative sum then add_rsv()), the document ids are collected in a small block at the start of decompress_buffer
+				(which stays in the L1 cache) and added to the accumulators each time the block fills.  Once the list is decoded the decoder
+				must call add_rsv_block(filled, remaining) to process the final partial block.  Padding at the end of the list is ignored.
+				add_rsv() might throw Done.
+				@param gaps [in] The d-gaps.
+				@param filled [in, out] The number of document ids in the block.
+				@param remaining [in, out] The number of postings still to be processed, decreased by the number processed.
+				@return true if there are more postings to process, false if this was the last of them.
+			*/
+			forceinline bool add_rsv_d1_fused(__m256i gaps, size_t &filled, size_t &remaining)
+				{
+				__m256i document_ids = _mm256_add_epi32(simd::cumulative_sum(gaps), _mm256_set1_epi32(d1_cumulative_sum));
+				d1_cumulative_sum = _mm256_extract_epi32(document_ids, 7);
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data()) + filled), document_ids);
+
+				filled += 8;
+				if (filled < FUSED_BLOCK_SIZE)
+					return true;
+
+				bool more = add_rsv_block(filled, remaining);
+				filled = 0;
+				return more;
+				}
+
+			/*
+				COMPRESS_INTEGER::ADD_RSV_D1_FUSED()
+				------------------------------------
+			*/
+			/*!
+				@brief Prefix sum a register of d-gaps (continuing from the previous register) and pass the document ids on to the accumulators.
+				@param gaps [in] The d-gaps.
+				@param filled [in, out] The number of document ids in the block.
+				@param remaining [in, out] The number of postings still to be processed, decreased by the number processed.
+				@return true if there are more postings to process, false if this was the last of them.
+			*/
+			forceinline bool add_rsv_d1_fused(__m128i gaps, size_t &filled, size_t &remaining)
+				{
+				__m128i document_ids = _mm_add_epi32(simd::cumulative_sum(gaps), _mm_set1_epi32(d1_cumulative_sum));
+				d1_cumulative_sum = _mm_extract_epi32(document_ids, 3);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data()) + filled), document_ids);
+
+				filled += 4;
+				if (filled < FUSED_BLOCK_SIZE)
+					return true;
+
+				bool more = add_rsv_block(filled, remaining);
+				filled = 0;
+				return more;
+				}
+
+			/*
+				COMPRESS_INTEGER::ADD_RSV_FUSED()
+				---------------------------------
+			*/
+			/*!
+				@brief Pass a register of document ids (not d-gaps) on to the accumulators.
+				@details This is add_rsv_d1_fused() for codexes that decode document ids directly (such as Elias-Fano), so there is no cumulative sum.
+				@param document_ids [in] The document ids.
+				@param filled [in, out] The number of document ids in the block.
+				@param remaining [in, out] The number of postings still to be processed, decreased by the number processed.
+				@return true if there are more postings to process, false if this was the last of them.
+			*/
+			forceinline bool add_rsv_fused(__m256i document_ids, size_t &filled, size_t &remaining)
+				{
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data()) + filled), document_ids);
+
+				filled += 8;
+				if (filled < FUSED_BLOCK_SIZE)
+					return true;
+
+				bool more = add_rsv_block(filled, remaining);
+				filled = 0;
+				return more;
+				}
+
+		public:
+
 			/*
 				COMPRESS_INTEGER::UNITTEST_ONE()
 				--------------------------------
@@ -262,5 +384,15 @@ namespace JASS
 				@param staring_from [in] normally 0.  The bitness to start testing from (some schemes cannot encode a 0 (e.g. Elias gama) so use 1 in those cases).
 			*/
 			static void unittest(compress_integer &compressor, uint32_t staring_from = 0);
+
+			/*
+				COMPRESS_INTEGER::UNITTEST_DECODE_WITH_WRITER()
+				-----------------------------------------------
+			*/
+			/*!
+				@brief Check that decode_with_writer() (decode, d1 decode, and add_rsv()) adds the impact to exactly the right documents, assert if not.
+				@param compressor [in] a compressor (this method will call init()).
+			*/
+			static void unittest_decode_with_writer(compress_integer &compressor);
 		} ;
 	}
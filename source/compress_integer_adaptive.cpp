@@ -0,0 +1,211 @@
+/*
+	COMPRESS_INTEGER_ADAPTIVE.CPP
+	-----------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+
+#include <random>
+#include <limits>
+
+#include "timer.h"
+#include "asserts.h"
+#include "compress_integer_all.h"
+#include "compress_integer_adaptive.h"
+
+namespace JASS
+	{
+	/*
+		COMPRESS_INTEGER_ADAPTIVE::CANDIDATE_NAMES
+		------------------------------------------
+		These are stored on disk (as the tag) so only add to the end of this list.  QMX is not a candidate because it needs
+		its input to be aligned and the tag byte prevents that.
+	*/
+	const std::array<const char *, compress_integer_adaptive::candidates> compress_integer_adaptive::candidate_names =
+		{
+		"None",
+		"Variable Byte",
+		"Stream VByte",
+		"Group Elias Gamma SIMD",
+		"Group Elias Delta SIMD",
+		"Binpack into 256-bit SIMD integers",
+		"Binpack into 128-bit SIMD integers",
+		"Optimal Packed Simple-8b",
+		"Optimal Packed Simple-16",
+		"Carryover-12",
+		"Relative-10",
+		"Group Elias Delta SIMD with Variable Byte"
+		};
+
+	/*
+		COMPRESS_INTEGER_ADAPTIVE::COMPRESS_INTEGER_ADAPTIVE()
+		------------------------------------------------------
+	*/
+	compress_integer_adaptive::compress_integer_adaptive(selection policy, double cost_weight) :
+		policy(policy),
+		cost_weight(cost_weight),
+		calibrated(false),
+		nanoseconds_per_integer{}
+		{
+		for (size_t which = 0; which < candidates; which++)
+			codex[which] = compress_integer_all::get_by_name(candidate_names[which]);
+		}
+
+	/*
+		COMPRESS_INTEGER_ADAPTIVE::CALIBRATE()
+		--------------------------------------
+	*/
+	void compress_integer_adaptive::calibrate(void)
+		{
+		/*
+			A d-gap like sequence (mostly small with the occasional large gap).  Seeded so that it's the same every time.
+		*/
+		const size_t length = 16384;
+		std::mt19937 generator(1);
+		std::geometric_distribution<integer> distribution(0.05);
+		std::vector<integer> sequence(length);
+		for (auto &gap : sequence)
+			gap = distribution(generator) + 1;
+
+		std::vector<uint8_t> encoded(length * sizeof(integer) * 2 + 4096);
+		std::vector<integer> decoded(length + 4096);
+
+		for (size_t which = 0; which < candidates; which++)
+			{
+			size_t took = codex[which]->encode(encoded.data(), encoded.size(), sequence.data(), length);
+			if (took == 0)
+				{
+				nanoseconds_per_integer[which] = (std::numeric_limits<double>::max)();
+				continue;
+				}
+
+			/*
+				Take the fastest of several runs to remove noise from the measurement
+			*/
+			auto fastest = (std::numeric_limits<decltype(timer::stop(timer::start()).nanoseconds())>::max)();
+			for (size_t run = 0; run < 10; run++)
+				{
+				auto clock = timer::start();
+				codex[which]->decode(decoded.data(), length, encoded.data(), took);
+				fastest = (std::min)(fastest, timer::stop(clock).nanoseconds());
+				}
+			nanoseconds_per_integer[which] = static_cast<double>(fastest) / length;
+			}
+
+		calibrated = true;
+		}
+
+	/*
+		COMPRESS_INTEGER_ADAPTIVE::ENCODE()
+		-----------------------------------
+	*/
+	size_t compress_integer_adaptive::encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers)
+		{
+		/*
+			Some codexes ignore the buffer length so make sure the trial buffer is too large to overflow, and some decode more integers than asked for.
+		*/
+		size_t scratch_size = source_integers * sizeof(integer) * 2 + 4096;
+		if (trial.size() < scratch_size)
+			{
+			trial.resize(scratch_size);
+			best.resize(scratch_size);
+			check.resize(source_integers + 4096);
+			}
+		if (check.size() < source_integers + 4096)
+			check.resize(source_integers + 4096);
+
+		/*
+			The cost model needs the decode speed of each candidate.  This is done here rather than in the constructor so that decoders don't pay for it.
+		*/
+		if (policy == cost_model && !calibrated)
+			calibrate();
+
+		size_t best_tag = candidates;
+		size_t best_size = 0;
+		double best_cost = (std::numeric_limits<double>::max)();
+
+		for (size_t which = 0; which < candidates; which++)
+			{
+			size_t took = codex[which]->encode(trial.data(), trial.size(), source, source_integers);
+			if (took == 0 || took + 1 > encoded_buffer_length)
+				continue;
+
+			double cost = policy == smallest ? took : took + cost_weight * source_integers * nanoseconds_per_integer[which];
+			if (cost >= best_cost)
+				continue;
+
+			/*
+				Not all codexes can encode all sequences (Elias gamma, for example, cannot encode 0), so make sure it decodes correctly.
+			*/
+			codex[which]->decode(check.data(), source_integers, trial.data(), took);
+			if (memcmp(check.data(), source, source_integers * sizeof(integer)) != 0)
+				continue;
+
+			best_tag = which;
+			best_size = took;
+			best_cost = cost;
+			std::swap(trial, best);
+			}
+
+		if (best_tag == candidates)
+			return 0;
+
+		/*
+			Write the tag then the encoding
+		*/
+		uint8_t *into = static_cast<uint8_t *>(encoded);
+		*into = static_cast<uint8_t>(best_tag);
+		memcpy(into + 1, best.data(), best_size);
+
+		return best_size + 1;
+		}
+
+	/*
+		COMPRESS_INTEGER_ADAPTIVE::UNITTEST()
+		-------------------------------------
+	*/
+	void compress_integer_adaptive::unittest(void)
+		{
+		/*
+			A compress_integer is also a query (with accumulators) so it is too large for the stack
+		*/
+		auto owner = std::make_unique<compress_integer_adaptive>();
+		compress_integer_adaptive &compressor = *owner;
+		compress_integer::unittest(compressor, 0);
+
+		/*
+			Different sequences should result in different codexes being chosen.  A run of 1s suits a packed scheme, a few large integers do not.
+		*/
+		std::vector<integer> ones(1024, 1);
+		std::vector<integer> large = {0xFFFFFFFF, 0x7FFFFFFF, 0xFFFFFFF};
+		std::vector<uint8_t> encoded(8192);
+		std::vector<integer> decoded(8192);
+
+		size_t took = compressor.encode(encoded.data(), encoded.size(), ones.data(), ones.size());
+		std::string ones_codex = codex_used(encoded.data());
+		compressor.decode(decoded.data(), ones.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), ones.data(), ones.size() * sizeof(integer)) == 0);
+		JASS_assert(took < ones.size() / 4);
+
+		took = compressor.encode(encoded.data(), encoded.size(), large.data(), large.size());
+		std::string large_codex = codex_used(encoded.data());
+		compressor.decode(decoded.data(), large.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), large.data(), large.size() * sizeof(integer)) == 0);
+
+		JASS_assert(ones_codex != large_codex);
+
+		/*
+			Check the overflow case
+		*/
+		JASS_assert(compressor.encode(encoded.data(), 2, ones.data(), ones.size()) == 0);
+
+		/*
+			The cost model must also round-trip
+		*/
+		auto costed = std::make_unique<compress_integer_adaptive>(cost_model);
+		compress_integer::unittest(*costed, 0);
+
+		puts("compress_integer_adaptive::PASSED");
+		}
+	}
@@ -0,0 +1,161 @@
+/*
+	COMPRESS_INTEGER_ADAPTIVE.H
+	---------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Choose the best codex for each sequence (postings segment) and store which was used in front of the encoding.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+
+#include "compress_integer.h"
+
+namespace JASS
+	{
+	/*
+		CLASS COMPRESS_INTEGER_ADAPTIVE
+		-------------------------------
+	*/
+	/*!
+		@brief Choose the best codex for each sequence (postings segment) and store which was used in front of the encoding.
+		@details Each codex in JASS has different strengths.  Some are good on short lists, some on long, some on dense, and some on
+		sparse.  This codex encodes each sequence with every one of a fixed set of candidate codexes, checks that each decodes
+		correctly, and keeps the best.  The encoding is a one byte codex tag followed by the encoding of that codex.  Decoding dispatches
+		through a table (indexed by the tag) to the candidate's decode().  Used by serialise_jass_v1 and serialise_jass_v2 (as
+		jass_v1_codex::adaptive) this gives a codex per impact segment.
+
+		"Best" is either the smallest encoding, or the lowest cost, where the cost is the size plus a weighted estimate of the
+		time to decode (measured once, on this machine, before the first sequence is encoded).  The smallest encoding is deterministic,
+		the cost model is not (it depends on the speed of the machine that built the index).
+
+		The tags are written to disk so the order of the candidates must never change, new candidates must go at the end.
+	*/
+	class compress_integer_adaptive : public compress_integer
+		{
+		public:
+			/*
+				ENUM COMPRESS_INTEGER_ADAPTIVE::SELECTION
+				-----------------------------------------
+			*/
+			/*!
+				@brief How to choose between the candidate codexes.
+			*/
+			enum selection
+				{
+				smallest,			///< choose the codex that results in the smallest encoding.
+				cost_model			///< choose the codex with the lowest size + cost_weight * integers * measured decode time (in nanoseconds per integer).
+				};
+
+		public:
+			static constexpr size_t candidates = 12;			///< The number of candidate codexes (the names are in candidate_names)
+
+		private:
+			static const std::array<const char *, candidates> candidate_names;		///< The compress_integer_all names of each candidate (in tag order).
+
+		private:
+			selection policy;																			///< How to choose the best codex.
+			double cost_weight;																		///< The number of bytes one nanosecond-per-integer of decode time is worth (cost_model only).
+			bool calibrated;																			///< Has nanoseconds_per_integer been measured yet.
+			std::array<std::unique_ptr<compress_integer>, candidates> codex;			///< The candidate codexes (indexed by tag).
+			std::array<double, candidates> nanoseconds_per_integer;						///< The measured time to decode (cost_model only).
+			std::vector<uint8_t> trial;															///< The encoding by the candidate being tested.
+			std::vector<uint8_t> best;																///< The best encoding so far.
+			std::vector<integer> check;															///< The decoding of trial (checked against the source before use).
+
+		private:
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::CALIBRATE()
+				--------------------------------------
+			*/
+			/*!
+				@brief Measure the decoding speed of each of the candidates (for the cost model).
+			*/
+			void calibrate(void);
+
+		public:
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::COMPRESS_INTEGER_ADAPTIVE()
+				------------------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+				@param policy [in] How to choose between the candidate codexes (default = smallest).
+				@param cost_weight [in] For the cost model, the number of bytes that 1 nanosecond per integer of decoding is worth (default = 1.0).
+			*/
+			compress_integer_adaptive(selection policy = smallest, double cost_weight = 1.0);
+
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::~COMPRESS_INTEGER_ADAPTIVE()
+				-------------------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~compress_integer_adaptive()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::ENCODE()
+				-----------------------------------
+			*/
+			/*!
+				@brief Encode a sequence of integers returning the number of bytes used for the encoding, or 0 if the encoded sequence doesn't fit in the buffer.
+				@param encoded [out] The sequence of bytes that is the encoded sequence.
+				@param encoded_buffer_length [in] The length (in bytes) of the output buffer, encoded.
+				@param source [in] The sequence of integers to encode.
+				@param source_integers [in] The length (in integers) of the source buffer.
+				@return The number of bytes used to encode the integer sequence, or 0 on error (i.e. overflow).
+			*/
+			virtual size_t encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::DECODE()
+				-----------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with this codex.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length)
+				{
+				const uint8_t *tag = static_cast<const uint8_t *>(source);
+				codex[*tag]->decode(decoded, integers_to_decode, tag + 1, source_length - 1);
+				}
+
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::CODEX_USED()
+				---------------------------------------
+			*/
+			/*!
+				@brief Return the name of the codex used to encode a sequence (for reporting).
+				@param encoded [in] The encoded sequence.
+				@return The compress_integer_all name of the codex that was used.
+			*/
+			static const char *codex_used(const void *encoded)
+				{
+				return candidate_names[*static_cast<const uint8_t *>(encoded)];
+				}
+
+			/*
+				COMPRESS_INTEGER_ADAPTIVE::UNITTEST()
+				-------------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
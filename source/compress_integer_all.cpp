@@ -10,11 +10,13 @@
 #include "compress_integer_none.h"
 #include "compress_integer_carry_8b.h"
 #include "compress_integer_simple_9.h"
+#include "compress_integer_adaptive.h"
 #include "compress_integer_simple_8b.h"
 #include "compress_integer_simple_16.h"
 #include "compress_integer_bitpack_64.h"
 #include "compress_integer_elias_gamma.h"
 #include "compress_integer_elias_delta.h"
+#include "compress_integer_elias_fano.h"
 #include "compress_integer_bitpack_128.h"
 #include "compress_integer_bitpack_256.h"
 #include "compress_integer_qmx_jass_v1.h"
@@ -24,6 +26,7 @@
 #include "compress_integer_qmx_improved.h"
 #include "compress_integer_qmx_original.h"
 #include "compress_integer_stream_vbyte.h"
+#include "compress_integer_stream_vbyte_d1.h"
 #include "compress_integer_simple_9_packed.h"
 #include "compress_integer_elias_delta_simd.h"
 #include "compress_integer_simple_16_packed.h"
@@ -33,6 +36,7 @@
 #include "compress_integer_elias_gamma_bitwise.h"
 #include "compress_integer_elias_delta_bitwise.h"
 #include "compress_integer_elias_gamma_simd_vb.h"
+#include "compress_integer_elias_fano_partitioned.h"
 
 namespace JASS
 	{
@@ -48,11 +52,13 @@ namespace JASS
 			{"-cD",    "--compress_elias_delta_bitwise", "Elias delta with bit instuctions (slow)"},
 			{"-ce",    "--compress_elias_delta_SIMD", "Group Elias Delta SIMD"},
 			{"-cE",    "--compress_elias_gamma_SIMD", "Group Elias Gamma SIMD"},
+			{"-cf",    "--compress_elias_fano", "Elias-Fano"},
 			{"-cF",    "--compress_elias_gamma_SIMD_vb", "Group Elias Delta SIMD with Variable Byte"},
 			{"-cg",    "--compress_elias_gamma", "Elias gamma"},
 			{"-cG",    "--compress_elias_gamma_bitwise", "Elias gamma with bit instuctions (slow)"},
 			{"-cn",    "--compress_none", "None"},
 			{"-cp",    "--compress_simple_9_packed", "Optimal Packed Simple-9"},
+			{"-cP",    "--compress_partitioned_elias_fano", "Partitioned Elias-Fano"},
 			{"-cq",    "--compress_simple_16_packed", "Optimal Packed Simple-16"},
 			{"-cQ",    "--compress_simple_8b_packed", "Optimal Packed Simple-8b"},
 			{"-cr",    "--compress_relative_10", "Relative-10"},
@@ -61,6 +67,7 @@ namespace JASS
 			{"-cT",    "--compress_simple_8b", "Simple-8b"},
 			{"-cv",    "--compress_vbyte", "Variable Byte"},
 			{"-cV",    "--compress_stream_vbyte", "Stream VByte"},
+			{"-cS",    "--compress_d1_stream_vbyte", "Stream VByte D1"},
 			{"-cX",    "--compress_qmx_improved", "QMX Improved"},
 			{"-cx",    "--compress_qmx_original", "QMX Original"},
 			{"-cZ",    "--compress_qmx_jass_v1", "QMX JASS v1"},
@@ -68,6 +75,7 @@ namespace JASS
 			{"-c256",  "--compress_256", "Binpack into 256-bit SIMD integers"},
 			{"-c32r",  "--compress_32", "Binpack into 32-bit integers with 8 selectors"},
 			{"-c64",   "--compress_64", "Binpack into 64-bit integers"},
+			{"-cA",    "--compress_adaptive", "Adaptive (best codex per sequence)"},
 			}
 		};
 
@@ -136,6 +144,14 @@ namespace JASS
 			return std::make_unique<compress_integer_elias_gamma_bitwise>();
 		if (shortname == "-cD")
 			return std::make_unique<compress_integer_elias_delta_bitwise>();
+		if (shortname == "-cA")
+			return std::make_unique<compress_integer_adaptive>();
+		if (shortname == "-cf")
+			return std::make_unique<compress_integer_elias_fano>();
+		if (shortname == "-cP")
+			return std::make_unique<compress_integer_elias_fano_partitioned>();
+		if (shortname == "-cS")
+			return std::make_unique<compress_integer_stream_vbyte_d1>();
 
 		assert(0);	// Unknown compressor;
 		return nullptr;
@@ -26,12 +26,12 @@ namespace JASS
 	alignas(16) static uint32_t static_mask_1[]  = {0x01, 0x01, 0x01, 0x01};								///< AND mask for 1-bit integers
 
 	/*
-		COMPRESS_INTEGER_BITPACK_128::DECODE()
+		COMPRESS_INTEGER_BITPACK_128::UNPACK()
 		--------------------------------------
 	*/
-	void compress_integer_bitpack_128::decode(integer *decoded, size_t integers_to_decode, const void *source_as_void, size_t source_length)
+	template <typename EMITTER>
+	forceinline void compress_integer_bitpack_128::unpack(EMITTER &emit, const void *source_as_void, size_t source_length)
 		{
-		__m128i *into = (__m128i *)decoded;
 		__m128i data;
 		const uint8_t *source = (uint8_t *)source_as_void;
 		const uint8_t *end_of_source = source + source_length;
@@ -54,205 +54,320 @@ namespace JASS
 			switch (width)
 				{
 				case 0:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 5, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 6, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 7, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 8, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 9, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 10, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 11, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 12, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 13, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 14, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 15, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 16, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 17, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 18, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 19, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 20, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 21, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 22, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 23, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 24, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 25, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 26, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 27, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 28, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 29, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 30, _mm_and_si128(data, mask_1));
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					data = _mm_srli_epi32(data, 1);
-					_mm_storeu_si128(into + 31, _mm_and_si128(data, mask_1));
-					into += 32;
+					if (!emit(_mm_and_si128(data, mask_1)))
+						return;
 					break;
 				case 1:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 5, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 6, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 7, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 8, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 9, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 10, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 11, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 12, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 13, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 14, _mm_and_si128(data, mask_2));
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					data = _mm_srli_epi32(data, 2);
-					_mm_storeu_si128(into + 15, _mm_and_si128(data, mask_2));
-					into += 16;
+					if (!emit(_mm_and_si128(data, mask_2)))
+						return;
 					break;
 				case 2:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 5, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 6, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 7, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 8, _mm_and_si128(data, mask_3));
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					data = _mm_srli_epi32(data, 3);
-					_mm_storeu_si128(into + 9, _mm_and_si128(data, mask_3));
-					into += 10;
+					if (!emit(_mm_and_si128(data, mask_3)))
+						return;
 					break;
 				case 3:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 5, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 6, _mm_and_si128(data, mask_4));
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					data = _mm_srli_epi32(data, 4);
-					_mm_storeu_si128(into + 7, _mm_and_si128(data, mask_4));
-					into += 8;
+					if (!emit(_mm_and_si128(data, mask_4)))
+						return;
 					break;
 				case 4:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_5));
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					data = _mm_srli_epi32(data, 5);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_5));
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					data = _mm_srli_epi32(data, 5);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_5));
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					data = _mm_srli_epi32(data, 5);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_5));
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					data = _mm_srli_epi32(data, 5);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_5));
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					data = _mm_srli_epi32(data, 5);
-					_mm_storeu_si128(into + 5, _mm_and_si128(data, mask_5));
-					into += 6;
+					if (!emit(_mm_and_si128(data, mask_5)))
+						return;
 					break;
 				case 5:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_6));
+					if (!emit(_mm_and_si128(data, mask_6)))
+						return;
 					data = _mm_srli_epi32(data, 6);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_6));
+					if (!emit(_mm_and_si128(data, mask_6)))
+						return;
 					data = _mm_srli_epi32(data, 6);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_6));
+					if (!emit(_mm_and_si128(data, mask_6)))
+						return;
 					data = _mm_srli_epi32(data, 6);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_6));
+					if (!emit(_mm_and_si128(data, mask_6)))
+						return;
 					data = _mm_srli_epi32(data, 6);
-					_mm_storeu_si128(into + 4, _mm_and_si128(data, mask_6));
-					into += 5;
+					if (!emit(_mm_and_si128(data, mask_6)))
+						return;
 					break;
 				case 6:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_8));
+					if (!emit(_mm_and_si128(data, mask_8)))
+						return;
 					data = _mm_srli_epi32(data, 8);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_8));
+					if (!emit(_mm_and_si128(data, mask_8)))
+						return;
 					data = _mm_srli_epi32(data, 8);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_8));
+					if (!emit(_mm_and_si128(data, mask_8)))
+						return;
 					data = _mm_srli_epi32(data, 8);
-					_mm_storeu_si128(into + 3, _mm_and_si128(data, mask_8));
-					into += 4;
+					if (!emit(_mm_and_si128(data, mask_8)))
+						return;
 					break;
 				case 7:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_10));
+					if (!emit(_mm_and_si128(data, mask_10)))
+						return;
 					data = _mm_srli_epi32(data, 10);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_10));
+					if (!emit(_mm_and_si128(data, mask_10)))
+						return;
 					data = _mm_srli_epi32(data, 10);
-					_mm_storeu_si128(into + 2, _mm_and_si128(data, mask_10));
-					into += 3;
+					if (!emit(_mm_and_si128(data, mask_10)))
+						return;
 					break;
 				case 8:
-					_mm_storeu_si128(into + 0, _mm_and_si128(data, mask_16));
+					if (!emit(_mm_and_si128(data, mask_16)))
+						return;
 					data = _mm_srli_epi32(data, 16);
-					_mm_storeu_si128(into + 1, _mm_and_si128(data, mask_16));
-					into += 2;
+					if (!emit(_mm_and_si128(data, mask_16)))
+						return;
 					break;
 				case 9:
-					_mm_storeu_si128(into, data);
-					into++;
+					if (!emit(data))
+						return;
 					break;
 				}
 			source += sizeof(__m128i);
 			}
 		}
-	}
 
+	/*
+		COMPRESS_INTEGER_BITPACK_128::DECODE()
+		--------------------------------------
+	*/
+	void compress_integer_bitpack_128::decode(integer *decoded, size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		__m128i *into = (__m128i *)decoded;
 
+		auto store = [&into](__m128i integers)
+			{
+			_mm_storeu_si128(into++, integers);
+			return true;
+			};
 
+		unpack(store, source_as_void, source_length);
+		}
 
+	/*
+		COMPRESS_INTEGER_BITPACK_128::DECODE_WITH_WRITER()
+		--------------------------------------------------
+	*/
+	void compress_integer_bitpack_128::decode_with_writer(size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		size_t filled = 0;
+
+		auto accumulate = [this, &filled, &remaining](__m128i gaps)
+			{
+			return add_rsv_d1_fused(gaps, filled, remaining);
+			};
+
+		try
+			{
+			unpack(accumulate, source_as_void, source_length);
+			add_rsv_block(filled, remaining);
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+	}
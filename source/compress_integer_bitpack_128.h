@@ -39,6 +39,22 @@ namespace JASS
 	*/
 	class compress_integer_bitpack_128: public compress_integer_bitpack
 		{
+		private:
+			/*
+				COMPRESS_INTEGER_BITPACK_128::UNPACK()
+				--------------------------------------
+			*/
+			/*!
+				@brief Unpack the encoded sequence one SIMD register at a time, passing each register (of 4 integers) to emit().
+				@details This is the decode loop shared by decode() (which stores each register) and decode_with_writer() (which
+				accumulates each register).  Unpacking stops early if emit() returns false.
+				@param emit [in] The callback, bool emit(__m128i integers).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			template <typename EMITTER>
+			void unpack(EMITTER &emit, const void *source, size_t source_length);
+
 		public:
 			/*
 				COMPRESS_INTEGER_BITPACK_128::ENCODE()
@@ -70,6 +86,18 @@ namespace JASS
 			*/
 			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
 
+			/*
+				COMPRESS_INTEGER_BITPACK_128::DECODE_WITH_WRITER()
+				--------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of d-gaps and add the impact to the accumulator of each document without going through decompress_buffer.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
 			/*
 				COMPRESS_INTEGER_BITPACK_128::UNITTEST()
 				----------------------------------------
@@ -81,6 +109,7 @@ namespace JASS
 				{
 				compress_integer_bitpack_128 *compressor = new compress_integer_bitpack_128;
 				compress_integer::unittest(*compressor);
+				compress_integer::unittest_decode_with_writer(*compressor);
 				delete compressor;
 				puts("compress_integer_bitpack_128::PASSED");
 				}
@@ -26,12 +26,12 @@ namespace JASS
 	alignas(32) static uint32_t static_mask_1[]  = {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01};								///< AND mask for 1-bit integers
 
 	/*
-		COMPRESS_INTEGER_BITPACK_256::DECODE()
+		COMPRESS_INTEGER_BITPACK_256::UNPACK()
 		--------------------------------------
 	*/
-	void compress_integer_bitpack_256::decode(integer *decoded, size_t integers_to_decode, const void *source_as_void, size_t source_length)
+	template <typename EMITTER>
+	forceinline void compress_integer_bitpack_256::unpack(EMITTER &emit, const void *source_as_void, size_t source_length)
 		{
-		__m256i *into = (__m256i *)decoded;
 		__m256i data;
 		const uint8_t *source = (uint8_t *)source_as_void;
 		const uint8_t *end_of_source = source + source_length;
@@ -54,205 +54,417 @@ namespace JASS
 			switch (width)
 				{
 				case 0:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 5, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 6, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 7, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 8, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 9, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 10, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 11, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 12, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 13, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 14, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 15, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 16, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 17, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 18, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 19, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 20, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 21, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 22, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 23, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 24, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 25, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 26, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 27, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 28, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 29, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 30, _mm256_and_si256(data, mask_1));
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					data = _mm256_srli_epi32(data, 1);
-					_mm256_storeu_si256(into + 31, _mm256_and_si256(data, mask_1));
-					into += 32;
+					if (!emit(_mm256_and_si256(data, mask_1)))
+						return;
 					break;
 				case 1:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 5, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 6, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 7, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 8, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 9, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 10, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 11, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 12, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 13, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 14, _mm256_and_si256(data, mask_2));
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					data = _mm256_srli_epi32(data, 2);
-					_mm256_storeu_si256(into + 15, _mm256_and_si256(data, mask_2));
-					into += 16;
+					if (!emit(_mm256_and_si256(data, mask_2)))
+						return;
 					break;
 				case 2:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 5, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 6, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 7, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 8, _mm256_and_si256(data, mask_3));
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					data = _mm256_srli_epi32(data, 3);
-					_mm256_storeu_si256(into + 9, _mm256_and_si256(data, mask_3));
-					into += 10;
+					if (!emit(_mm256_and_si256(data, mask_3)))
+						return;
 					break;
 				case 3:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 5, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 6, _mm256_and_si256(data, mask_4));
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					data = _mm256_srli_epi32(data, 4);
-					_mm256_storeu_si256(into + 7, _mm256_and_si256(data, mask_4));
-					into += 8;
+					if (!emit(_mm256_and_si256(data, mask_4)))
+						return;
 					break;
 				case 4:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_5));
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					data = _mm256_srli_epi32(data, 5);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_5));
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					data = _mm256_srli_epi32(data, 5);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_5));
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					data = _mm256_srli_epi32(data, 5);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_5));
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					data = _mm256_srli_epi32(data, 5);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_5));
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					data = _mm256_srli_epi32(data, 5);
-					_mm256_storeu_si256(into + 5, _mm256_and_si256(data, mask_5));
-					into += 6;
+					if (!emit(_mm256_and_si256(data, mask_5)))
+						return;
 					break;
 				case 5:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_6));
+					if (!emit(_mm256_and_si256(data, mask_6)))
+						return;
 					data = _mm256_srli_epi32(data, 6);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_6));
+					if (!emit(_mm256_and_si256(data, mask_6)))
+						return;
 					data = _mm256_srli_epi32(data, 6);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_6));
+					if (!emit(_mm256_and_si256(data, mask_6)))
+						return;
 					data = _mm256_srli_epi32(data, 6);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_6));
+					if (!emit(_mm256_and_si256(data, mask_6)))
+						return;
 					data = _mm256_srli_epi32(data, 6);
-					_mm256_storeu_si256(into + 4, _mm256_and_si256(data, mask_6));
-					into += 5;
+					if (!emit(_mm256_and_si256(data, mask_6)))
+						return;
 					break;
 				case 6:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_8));
+					if (!emit(_mm256_and_si256(data, mask_8)))
+						return;
 					data = _mm256_srli_epi32(data, 8);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_8));
+					if (!emit(_mm256_and_si256(data, mask_8)))
+						return;
 					data = _mm256_srli_epi32(data, 8);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_8));
+					if (!emit(_mm256_and_si256(data, mask_8)))
+						return;
 					data = _mm256_srli_epi32(data, 8);
-					_mm256_storeu_si256(into + 3, _mm256_and_si256(data, mask_8));
-					into += 4;
+					if (!emit(_mm256_and_si256(data, mask_8)))
+						return;
 					break;
 				case 7:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_10));
+					if (!emit(_mm256_and_si256(data, mask_10)))
+						return;
 					data = _mm256_srli_epi32(data, 10);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_10));
+					if (!emit(_mm256_and_si256(data, mask_10)))
+						return;
 					data = _mm256_srli_epi32(data, 10);
-					_mm256_storeu_si256(into + 2, _mm256_and_si256(data, mask_10));
-					into += 3;
+					if (!emit(_mm256_and_si256(data, mask_10)))
+						return;
 					break;
 				case 8:
-					_mm256_storeu_si256(into + 0, _mm256_and_si256(data, mask_16));
+					if (!emit(_mm256_and_si256(data, mask_16)))
+						return;
 					data = _mm256_srli_epi32(data, 16);
-					_mm256_storeu_si256(into + 1, _mm256_and_si256(data, mask_16));
-					into += 2;
+					if (!emit(_mm256_and_si256(data, mask_16)))
+						return;
 					break;
 				case 9:
-					_mm256_storeu_si256(into, data);
-					into++;
+					if (!emit(data))
+						return;
 					break;
 				}
 			source += sizeof(__m256i);
 			}
 		}
-	}
 
+	/*
+		COMPRESS_INTEGER_BITPACK_256::DECODE()
+		--------------------------------------
+	*/
+	void compress_integer_bitpack_256::decode(integer *decoded, size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		if (simd::get_simd_level() >= hardware_support::avx512)
+			decode_avx512(decoded, source_as_void, source_length);
+		else
+			decode_avx2(decoded, source_as_void, source_length);
+		}
+
+	/*
+		COMPRESS_INTEGER_BITPACK_256::DECODE_AVX2()
+		-------------------------------------------
+	*/
+	void compress_integer_bitpack_256::decode_avx2(integer *decoded, const void *source_as_void, size_t source_length)
+		{
+		__m256i *into = (__m256i *)decoded;
+
+		auto store = [&into](__m256i integers)
+			{
+			_mm256_storeu_si256(into++, integers);
+			return true;
+			};
+
+		unpack(store, source_as_void, source_length);
+		}
+
+	/*
+		UNPACK_PAIRS()
+		--------------
+		Decode one 256-bit word of REGISTERS * 8 integers of BITS bits each, 16 integers at a time.  The bottom half of the 512-bit
+		register holds integers 0, 2, 4, ... (of each lane), the top half holds integers 1, 3, 5, ...
+	*/
+	template <uint32_t BITS, uint32_t REGISTERS>
+	JASS_TARGET_AVX512 forceinline static compress_integer::integer *unpack_pairs(compress_integer::integer *into, __m256i data)
+		{
+		/*
+			The zero-masked forms (with all lanes selected) are used because GCC's unmasked forms pass an undefined register as
+			the merge source, which -Wmaybe-uninitialized warns about.  They compile to the same instructions.
+		*/
+		const __m512i mask = _mm512_set1_epi32(BITS == 32 ? -1 : (1 << (BITS % 32)) - 1);
+		__m512i pair = _mm512_maskz_broadcast_i64x4((__mmask8)0xFF, data);
+		pair = _mm512_maskz_srlv_epi32((__mmask16)0xFFFF, pair, _mm512_set_epi32(BITS, BITS, BITS, BITS, BITS, BITS, BITS, BITS, 0, 0, 0, 0, 0, 0, 0, 0));
+
+		for (uint32_t pairs = 0; pairs < REGISTERS / 2; pairs++)
+			{
+			_mm512_storeu_si512(into, _mm512_and_si512(pair, mask));
+			pair = _mm512_maskz_srli_epi32((__mmask16)0xFFFF, pair, (2 * BITS) % 32);
+			into += 16;
+			}
+		if (REGISTERS & 1)
+			{
+			_mm512_mask_storeu_epi32(into, (__mmask16)0x00FF, _mm512_and_si512(pair, mask));
+			into += 8;
+			}
+		return into;
+		}
 
+	/*
+		COMPRESS_INTEGER_BITPACK_256::DECODE_AVX512()
+		---------------------------------------------
+	*/
+	JASS_TARGET_AVX512 void compress_integer_bitpack_256::decode_avx512(integer *decoded, const void *source_as_void, size_t source_length)
+		{
+		const uint8_t *source = static_cast<const uint8_t *>(source_as_void);
+		const uint8_t *end_of_source = source + source_length;
+		integer *into = decoded;
 
+		while (source < end_of_source)
+			{
+			uint32_t width = *source;
+			source++;
+			__m256i data = _mm256_loadu_si256((__m256i *)source);
+			source += sizeof(__m256i);
 
+			switch (width)
+				{
+				case 0:
+					into = unpack_pairs<1, 32>(into, data);
+					break;
+				case 1:
+					into = unpack_pairs<2, 16>(into, data);
+					break;
+				case 2:
+					into = unpack_pairs<3, 10>(into, data);
+					break;
+				case 3:
+					into = unpack_pairs<4, 8>(into, data);
+					break;
+				case 4:
+					into = unpack_pairs<5, 6>(into, data);
+					break;
+				case 5:
+					into = unpack_pairs<6, 5>(into, data);
+					break;
+				case 6:
+					into = unpack_pairs<8, 4>(into, data);
+					break;
+				case 7:
+					into = unpack_pairs<10, 3>(into, data);
+					break;
+				case 8:
+					into = unpack_pairs<16, 2>(into, data);
+					break;
+				case 9:
+					_mm256_storeu_si256((__m256i *)into, data);
+					into += 8;
+					break;
+				}
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_BITPACK_256::DECODE_WITH_WRITER()
+		--------------------------------------------------
+	*/
+	void compress_integer_bitpack_256::decode_with_writer(size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		size_t filled = 0;
+
+		auto accumulate = [this, &filled, &remaining](__m256i gaps)
+			{
+			return add_rsv_d1_fused(gaps, filled, remaining);
+			};
+
+		try
+			{
+			unpack(accumulate, source_as_void, source_length);
+			add_rsv_block(filled, remaining);
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+	}
@@ -14,6 +14,10 @@
 
 #include <stdint.h>
 
+#include <vector>
+
+#include "simd.h"
+#include "hardware_support.h"
 #include "compress_integer_bitpack.h"
 
 namespace JASS
@@ -39,6 +43,50 @@ namespace JASS
 	*/
 	class compress_integer_bitpack_256 : public compress_integer_bitpack
 		{
+		private:
+			/*
+				COMPRESS_INTEGER_BITPACK_256::UNPACK()
+				--------------------------------------
+			*/
+			/*!
+				@brief Unpack the encoded sequence one SIMD register at a time, passing each register (of 8 integers) to emit().
+				@details This is the decode loop shared by decode() (which stores each register) and decode_with_writer() (which
+				accumulates each register).  Unpacking stops early if emit() returns false.
+				@param emit [in] The callback, bool emit(__m256i integers).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			template <typename EMITTER>
+			void unpack(EMITTER &emit, const void *source, size_t source_length);
+
+		public:
+			/*
+				COMPRESS_INTEGER_BITPACK_256::DECODE_AVX2()
+				-------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers one 256-bit register at a time (using AVX2).
+				@param decoded [out] The sequence of decoded integers.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			void decode_avx2(integer *decoded, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_BITPACK_256::DECODE_AVX512()
+				---------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers two 256-bit registers at a time (using AVX-512).
+				@details Each 256-bit word is loaded into both halves of a 512-bit register and the top half is shifted right by one
+				integer width, so each shift / AND / store decodes 16 integers rather than 8.  The encoding is unchanged.  decode() uses this
+				if the CPU has AVX-512.
+				@param decoded [out] The sequence of decoded integers.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			JASS_TARGET_AVX512 static void decode_avx512(integer *decoded, const void *source, size_t source_length);
+
 		public:
 			/*
 				COMPRESS_INTEGER_BITPACK_256::ENCODE()
@@ -70,6 +118,18 @@ namespace JASS
 			*/
 			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
 
+			/*
+				COMPRESS_INTEGER_BITPACK_256::DECODE_WITH_WRITER()
+				--------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of d-gaps and add the impact to the accumulator of each document without going through decompress_buffer.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
 			/*
 				COMPRESS_INTEGER_BITPACK_256::UNITTEST()
 				----------------------------------------
@@ -81,6 +141,41 @@ namespace JASS
 				{
 				compress_integer_bitpack_256 *compressor = new compress_integer_bitpack_256;
 				compress_integer::unittest(*compressor);
+				compress_integer::unittest_decode_with_writer(*compressor);
+
+				/*
+					The AVX2 and AVX-512 decoders must agree for every width
+				*/
+				if (hardware_support::detected().simd() >= hardware_support::avx512)
+					for (uint32_t bits = 0; bits <= 32; bits++)
+						{
+						std::vector<integer> sequence;
+						for (integer which = 0; which < 1000; which++)
+							sequence.push_back((which * 2654435761U) & (bits == 32 ? 0xFFFFFFFF : (1U << bits) - 1));
+						std::vector<uint8_t> encoded(sequence.size() * sizeof(integer) * 2 + 1024);
+						std::vector<integer> avx2(sequence.size() + 512);
+						std::vector<integer> avx512(sequence.size() + 512);
+
+						size_t took = compressor->encode(encoded.data(), encoded.size(), sequence.data(), sequence.size());
+						compressor->decode_avx2(avx2.data(), encoded.data(), took);
+						decode_avx512(avx512.data(), encoded.data(), took);
+						avx2.resize(sequence.size());
+						avx512.resize(sequence.size());
+						JASS_assert(avx2 == sequence);
+						JASS_assert(avx512 == sequence);
+						}
+
+				/*
+					decode() uses the level set with simd::set_simd_level(), check it at each level
+				*/
+				auto previous_level = simd::get_simd_level();
+				for (auto level : {hardware_support::avx2, hardware_support::avx512})
+					{
+					simd::set_simd_level(level);
+					compress_integer::unittest(*compressor);
+					}
+				simd::set_simd_level(previous_level);
+
 				delete compressor;
 				puts("compress_integer_bitpack_256::PASSED");
 				}
@@ -0,0 +1,298 @@
+/*
+	COMPRESS_INTEGER_BLOCKED.CPP
+	----------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <random>
+#include <algorithm>
+
+#include "asserts.h"
+#include "compress_integer_all.h"
+#include "compress_integer_blocked.h"
+
+namespace JASS
+	{
+	/*
+		COMPRESS_INTEGER_BLOCKED::ENCODE()
+		----------------------------------
+	*/
+	size_t compress_integer_blocked::encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers)
+		{
+		if (source_integers <= block_size)
+			return codex->encode(encoded, encoded_buffer_length, source, source_integers);
+
+		size_t blocks = (source_integers + block_size - 1) / block_size;
+		size_t table_size = blocks * skip_entry_size;
+		if (encoded_buffer_length <= table_size)
+			return 0;
+
+		uint8_t *skips = static_cast<uint8_t *>(encoded);
+		uint8_t *payload = skips + table_size;
+		size_t payload_length = encoded_buffer_length - table_size;
+		size_t used = 0;
+		integer last = 0;
+
+		for (size_t block = 0; block < blocks; block++)
+			{
+			const integer *from = source + block * block_size;
+			size_t integers = (std::min)(block_size, source_integers - block * block_size);
+
+			size_t took = codex->encode(payload + used, payload_length - used, from, integers);
+			if (took == 0)
+				return 0;
+			used += took;
+
+			for (size_t which = 0; which < integers; which++)
+				last += from[which];
+
+			uint32_t end = static_cast<uint32_t>(used);
+			memcpy(skips + block * skip_entry_size, &last, sizeof(last));
+			memcpy(skips + block * skip_entry_size + sizeof(last), &end, sizeof(end));
+			}
+
+		return table_size + used;
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::DECODE()
+		----------------------------------
+	*/
+	void compress_integer_blocked::decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length)
+		{
+		if (integers_to_decode <= block_size)
+			{
+			codex->decode(decoded, integers_to_decode, source, source_length);
+			return;
+			}
+
+		/*
+			The d-gap at the start of each block is relative to the end of the previous block so decode them one after the other
+		*/
+		size_t blocks = (integers_to_decode + block_size - 1) / block_size;
+		const uint8_t *skips = static_cast<const uint8_t *>(source);
+		const uint8_t *payload = skips + blocks * skip_entry_size;
+		uint32_t start = 0;
+
+		for (size_t block = 0; block < blocks; block++)
+			{
+			uint32_t end;
+			memcpy(&end, skips + block * skip_entry_size + sizeof(uint32_t), sizeof(end));
+			codex->decode(decoded + block * block_size, (std::min)(block_size, integers_to_decode - block * block_size), payload + start, end - start);
+			start = end;
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::CURSOR::CURSOR()
+		------------------------------------------
+	*/
+	compress_integer_blocked::cursor::cursor(compress_integer_blocked &owner, const void *source, size_t source_length, size_t integers) :
+		codex(*owner.codex),
+		skips(nullptr),
+		payload(static_cast<const uint8_t *>(source)),
+		payload_length(source_length),
+		integers(integers),
+		blocks(integers == 0 ? 0 : 1),
+		current_block(0),
+		current_block_integers(0),
+		position(0),
+		blocks_decoded(0),
+		buffer(block_size + decode_overrun)
+		{
+		if (integers > block_size)
+			{
+			blocks = (integers + block_size - 1) / block_size;
+			skips = payload;
+			payload += blocks * skip_entry_size;
+			payload_length -= blocks * skip_entry_size;
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::CURSOR::DECODE_BLOCK()
+		------------------------------------------------
+	*/
+	void compress_integer_blocked::cursor::decode_block(size_t block)
+		{
+		size_t start = 0;
+		size_t end = payload_length;
+		integer base = 0;
+
+		current_block_integers = integers;
+		if (skips != nullptr)
+			{
+			if (block != 0)
+				{
+				start = block_end(block - 1);
+				base = block_last(block - 1);
+				}
+			end = block_end(block);
+			current_block_integers = (std::min)(block_size, integers - block * block_size);
+			}
+
+		codex.decode(buffer.data(), current_block_integers, payload + start, end - start);
+		buffer[0] += base;
+		simd::cumulative_sum(buffer.data(), current_block_integers);
+
+		current_block = block;
+		position = 0;
+		blocks_decoded++;
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::CURSOR::FIND_BLOCK()
+		----------------------------------------------
+	*/
+	size_t compress_integer_blocked::cursor::find_block(integer target) const
+		{
+		/*
+			Gallop: the last id of low is known to be less than target, double the step until we pass target (or the end)
+		*/
+		size_t low = current_block;
+		size_t step = 1;
+		size_t high = low + 1;
+		while (high < blocks && block_last(high) < target)
+			{
+			low = high;
+			step <<= 1;
+			high = low + step;
+			}
+		high = (std::min)(high, blocks);
+
+		/*
+			Binary search for the first block in (low, high] whose last id is at least target
+		*/
+		size_t first = low + 1;
+		size_t count = high - first;
+		while (count > 0)
+			{
+			size_t half = count / 2;
+			size_t middle = first + half;
+			if (block_last(middle) < target)
+				{
+				first = middle + 1;
+				count -= half + 1;
+				}
+			else
+				count = half;
+			}
+
+		return first;
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::CURSOR::NEXT_GEQ()
+		--------------------------------------------
+	*/
+	compress_integer::integer compress_integer_blocked::cursor::next_geq(integer target)
+		{
+		if (current_block >= blocks)
+			return end_of_list;
+
+		/*
+			Skip the blocks that end before target without decoding them
+		*/
+		size_t block = current_block;
+		if (skips != nullptr && block_last(block) < target)
+			if ((block = find_block(target)) >= blocks)
+				{
+				current_block = blocks;
+				return end_of_list;
+				}
+
+		if (block != current_block || current_block_integers == 0)
+			decode_block(block);
+
+		/*
+			Find target within the block
+		*/
+		position = std::lower_bound(buffer.data() + position, buffer.data() + current_block_integers, target) - buffer.data();
+		if (position >= current_block_integers)
+			{
+			current_block = blocks;
+			return end_of_list;
+			}
+
+		return buffer[position];
+		}
+
+	/*
+		COMPRESS_INTEGER_BLOCKED::UNITTEST()
+		------------------------------------
+	*/
+	void compress_integer_blocked::unittest(void)
+		{
+		/*
+			A compress_integer is also a query (with accumulators) so it is too large for the stack
+		*/
+		auto compressor = std::make_unique<compress_integer_blocked>(compress_integer_all::get_by_name("Group Elias Gamma SIMD"));
+		compress_integer::unittest(*compressor);
+
+		/*
+			A long random sequence (so lots of blocks)
+		*/
+		std::mt19937 random(7);
+		std::vector<integer> gaps(10 * block_size + 17);
+		std::vector<integer> document_ids(gaps.size());
+		integer sum = 0;
+		for (size_t which = 0; which < gaps.size(); which++)
+			{
+			gaps[which] = 1 + random() % 20;
+			document_ids[which] = sum += gaps[which];
+			}
+
+		std::vector<uint8_t> encoded(gaps.size() * sizeof(integer) * 2);
+		std::vector<integer> decoded(gaps.size() + decode_overrun);
+		size_t took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		JASS_assert(took != 0);
+		compressor->decode(decoded.data(), gaps.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), gaps.data(), gaps.size() * sizeof(integer)) == 0);
+
+		/*
+			Walk the whole list one document id at a time
+		*/
+		cursor walker(*compressor, encoded.data(), took, gaps.size());
+		integer previous = 0;
+		for (const auto id : document_ids)
+			JASS_assert((previous = walker.next_geq(previous + 1)) == id);
+		JASS_assert(walker.next_geq(previous + 1) == cursor::end_of_list);
+		JASS_assert(walker.get_blocks_decoded() == 11);
+
+		/*
+			Skip about, including targets that are (and are not) in the list and repeat targets
+		*/
+		cursor skipper(*compressor, encoded.data(), took, gaps.size());
+		for (integer target = 0; target < sum; target += 1 + random() % 700)
+			{
+			auto expected = *std::lower_bound(document_ids.begin(), document_ids.end(), target);
+			JASS_assert(skipper.next_geq(target) == expected);
+			JASS_assert(skipper.next_geq(target) == expected);
+			}
+		JASS_assert(skipper.next_geq(sum + 1) == cursor::end_of_list);
+
+		/*
+			Going straight to the end only decodes one block
+		*/
+		cursor jumper(*compressor, encoded.data(), took, gaps.size());
+		JASS_assert(jumper.next_geq(sum) == sum);
+		JASS_assert(jumper.get_blocks_decoded() == 1);
+
+		/*
+			Short sequences are not blocked
+		*/
+		gaps.resize(block_size);
+		took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		cursor short_list(*compressor, encoded.data(), took, gaps.size());
+		JASS_assert(short_list.next_geq(document_ids[5]) == document_ids[5]);
+		JASS_assert(short_list.next_geq(document_ids[block_size - 1] + 1) == cursor::end_of_list);
+
+		/*
+			The overflow case
+		*/
+		gaps.resize(10 * block_size);
+		JASS_assert(compressor->encode(encoded.data(), 10 * skip_entry_size, gaps.data(), gaps.size()) == 0);
+
+		puts("compress_integer_blocked::PASSED");
+		}
+	}
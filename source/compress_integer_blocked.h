@@ -0,0 +1,240 @@
+/*
+	COMPRESS_INTEGER_BLOCKED.H
+	--------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Break long sequences into blocks, each compressed separately, with a table of skip entries at the start.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <string.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "simd.h"
+#include "compress_integer.h"
+
+namespace JASS
+	{
+	/*
+		CLASS COMPRESS_INTEGER_BLOCKED
+		------------------------------
+	*/
+	/*!
+		@brief Break long sequences into blocks, each compressed separately, with a table of skip entries at the start.
+		@details An impact segment is normally decoded from start to finish, there is no way to find a given document id without decoding
+		everything before it.  This codex wraps another codex and, for sequences longer than block_size integers, breaks the sequence into
+		blocks of block_size integers (the last may be shorter), each of which is encoded by the wrapped codex.  In front of the blocks is a skip
+		table with one entry per block: the last document id in the block and the offset of the end of the block (both uint32_t, measured from
+		the start of the first block).  As the d-gaps at the start of each block are relative to the end of the previous block, decode() simply
+		decodes each block in turn, so the query processing path is unchanged.  Sequences of block_size integers or fewer are stored exactly as
+		the wrapped codex stores them (no skip table).
+
+		The skip entries are fixed width so a cursor can gallop (exponential then binary search) through them to find the block holding a
+		document id without decoding anything, then decode only that block.  See cursor::next_geq().  Used by serialise_jass_v1 and
+		serialise_jass_v2 (with the blocked constructor parameter) in which case the codex byte at the start of CIpostings.bin is
+		serialise_jass_v1::jass_v1_codex::blocked followed by the wrapped codex's byte.
+	*/
+	class compress_integer_blocked : public compress_integer
+		{
+		public:
+			static constexpr size_t block_size = 128;					///< The number of integers in each block (sequences no longer than this are not blocked).
+			static constexpr size_t skip_entry_size = 2 * sizeof(uint32_t);		///< Each skip entry is the last document id and the end of the block.
+			static constexpr size_t decode_overrun = 1024;			///< The number of integers the wrapped codex might write past the end of a block.
+
+		public:
+			/*
+				CLASS COMPRESS_INTEGER_BLOCKED::CURSOR
+				--------------------------------------
+			*/
+			/*!
+				@brief Move forward through a (blocked) sequence a document id at a time, skipping the blocks that are not needed.
+				@details The document ids are the cumulative sum of the encoded d-gaps (that is, what decode() followed by a cumulative sum
+				would produce, the values passed to add_rsv()).  Only the blocks that next_geq() lands in are decoded.
+			*/
+			class cursor
+				{
+				public:
+					static constexpr integer end_of_list = (std::numeric_limits<integer>::max)();		///< Returned by next_geq() when there are no more document ids.
+
+				private:
+					compress_integer &codex;					///< The wrapped codex (used to decode each block).
+					const uint8_t *skips;						///< The skip table (nullptr if the sequence is not blocked).
+					const uint8_t *payload;						///< The start of the first block.
+					size_t payload_length;						///< The length (in bytes) of the blocks.
+					size_t integers;								///< The number of integers in the sequence.
+					size_t blocks;									///< The number of blocks in the sequence.
+					size_t current_block;						///< The block currently in buffer (or blocks if at the end of the list).
+					size_t current_block_integers;			///< The number of integers in current_block.
+					size_t position;								///< The current position in buffer.
+					size_t blocks_decoded;						///< The number of blocks decoded so far.
+					std::vector<integer> buffer;				///< The document ids of current_block.
+
+				private:
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::BLOCK_LAST()
+						----------------------------------------------
+					*/
+					/*!
+						@brief Return the last document id in the given block (from the skip table).
+						@param block [in] The block number.
+						@return The last document id in the block.
+					*/
+					integer block_last(size_t block) const
+						{
+						integer last;
+						memcpy(&last, skips + block * skip_entry_size, sizeof(last));
+						return last;
+						}
+
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::BLOCK_END()
+						---------------------------------------------
+					*/
+					/*!
+						@brief Return the offset (from payload) of the end of the given block (from the skip table).
+						@param block [in] The block number.
+						@return The offset of the end of the block.
+					*/
+					size_t block_end(size_t block) const
+						{
+						uint32_t end;
+						memcpy(&end, skips + block * skip_entry_size + sizeof(uint32_t), sizeof(end));
+						return end;
+						}
+
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::DECODE_BLOCK()
+						------------------------------------------------
+					*/
+					/*!
+						@brief Decode the given block into buffer and convert the d-gaps into document ids.
+						@param block [in] The block number.
+					*/
+					void decode_block(size_t block);
+
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::FIND_BLOCK()
+						----------------------------------------------
+					*/
+					/*!
+						@brief Gallop forward through the skip table from the current block to find the first block whose last document id is at least target.
+						@param target [in] The document id to look for.
+						@return The block number, or blocks if there is no such block.
+					*/
+					size_t find_block(integer target) const;
+
+				public:
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::CURSOR()
+						------------------------------------------
+					*/
+					/*!
+						@brief Constructor.
+						@param owner [in] The codex that encoded the sequence.
+						@param source [in] The encoded sequence.
+						@param source_length [in] The length (in bytes) of the encoded sequence.
+						@param integers [in] The number of integers in the encoded sequence.
+					*/
+					cursor(compress_integer_blocked &owner, const void *source, size_t source_length, size_t integers);
+
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::NEXT_GEQ()
+						--------------------------------------------
+					*/
+					/*!
+						@brief Move forward to the first document id that is greater than or equal to target and return it.
+						@details The cursor never moves backwards, a target smaller than the current document id returns the current document id.
+						@param target [in] The document id to look for.
+						@return The document id, or end_of_list if there is no such document id.
+					*/
+					integer next_geq(integer target);
+
+					/*
+						COMPRESS_INTEGER_BLOCKED::CURSOR::GET_BLOCKS_DECODED()
+						------------------------------------------------------
+					*/
+					/*!
+						@brief Return the number of blocks this cursor has decoded (for reporting).
+						@return The number of blocks decoded.
+					*/
+					size_t get_blocks_decoded(void) const
+						{
+						return blocks_decoded;
+						}
+				};
+
+		private:
+			std::unique_ptr<compress_integer> codex;			///< The codex used to encode each block.
+
+		public:
+			/*
+				COMPRESS_INTEGER_BLOCKED::COMPRESS_INTEGER_BLOCKED()
+				----------------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+				@param codex [in] The codex used to encode each block (this object takes ownership).
+			*/
+			explicit compress_integer_blocked(std::unique_ptr<compress_integer> codex) :
+				codex(std::move(codex))
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_BLOCKED::~COMPRESS_INTEGER_BLOCKED()
+				-----------------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~compress_integer_blocked()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_BLOCKED::ENCODE()
+				----------------------------------
+			*/
+			/*!
+				@brief Encode a sequence of integers returning the number of bytes used for the encoding, or 0 if the encoded sequence doesn't fit in the buffer.
+				@param encoded [out] The sequence of bytes that is the encoded sequence.
+				@param encoded_buffer_length [in] The length (in bytes) of the output buffer, encoded.
+				@param source [in] The sequence of integers to encode.
+				@param source_integers [in] The length (in integers) of the source buffer.
+				@return The number of bytes used to encode the integer sequence, or 0 on error (i.e. overflow).
+			*/
+			virtual size_t encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_BLOCKED::DECODE()
+				----------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with this codex.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_BLOCKED::UNITTEST()
+				------------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
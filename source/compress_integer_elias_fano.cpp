@@ -0,0 +1,169 @@
+/*
+	COMPRESS_INTEGER_ELIAS_FANO.CPP
+	-------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "asserts.h"
+#include "compress_integer_elias_fano.h"
+
+namespace JASS
+	{
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO::ENCODE_ELIAS_FANO()
+		------------------------------------------------
+	*/
+	size_t compress_integer_elias_fano::encode_elias_fano(uint8_t *encoded, size_t encoded_buffer_length, const uint64_t *source, size_t source_integers, uint64_t base, uint32_t low_bits)
+		{
+		size_t low_bytes;
+		size_t high_bytes;
+		encoded_size(source[source_integers - 1] - base, source_integers, low_bits, low_bytes, high_bytes);
+		if (low_bytes + high_bytes > encoded_buffer_length)
+			return 0;
+
+		memset(encoded, 0, low_bytes + high_bytes);
+		uint8_t *high = encoded + low_bytes;
+		uint64_t mask = (1ULL << low_bits) - 1;
+
+		for (size_t which = 0; which < source_integers; which++)
+			{
+			uint64_t value = source[which] - base;
+
+			/*
+				The low bits, packed one after the other (the bits of the low part can span 5 bytes)
+			*/
+			size_t bit_offset = which * low_bits;
+			uint64_t low = (value & mask) << (bit_offset % 8);
+			for (uint8_t *into = encoded + bit_offset / 8; low != 0; into++, low >>= 8)
+				*into |= static_cast<uint8_t>(low);
+
+			/*
+				The high bits, in unary
+			*/
+			uint64_t position = (value >> low_bits) + which;
+			high[position / 8] |= 1 << (position % 8);
+			}
+
+		return low_bytes + high_bytes;
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO::ENCODE()
+		-------------------------------------
+	*/
+	size_t compress_integer_elias_fano::encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers)
+		{
+		if (source_integers == 0 || encoded_buffer_length < 1)
+			return 0;
+
+		/*
+			Convert the d-gaps into document ids (using 64 bits so that the sequence is non-decreasing even if the sum overflows 32 bits)
+		*/
+		document_ids.resize(source_integers);
+		uint64_t sum = 0;
+		for (size_t which = 0; which < source_integers; which++)
+			document_ids[which] = sum += source[which];
+
+		uint8_t *into = static_cast<uint8_t *>(encoded);
+		uint32_t low_bits = low_bits_for(sum, source_integers);
+		*into = static_cast<uint8_t>(low_bits);
+
+		size_t took = encode_elias_fano(into + 1, encoded_buffer_length - 1, document_ids.data(), source_integers, 0, low_bits);
+
+		return took == 0 ? 0 : took + 1;
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO::DECODE()
+		-------------------------------------
+	*/
+	void compress_integer_elias_fano::decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length)
+		{
+		const uint8_t *from = static_cast<const uint8_t *>(source);
+		integer *into = decoded;
+		auto writer = [&into](__m256i document_ids)
+			{
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(into), document_ids);
+			into += 8;
+			};
+
+		decode_elias_fano(writer, 0, integers_to_decode, *from, from + 1, source_length - 1);
+
+		/*
+			Callers of decode() expect d-gaps
+		*/
+		d1_encode(decoded, decoded, integers_to_decode);
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO::DECODE_WITH_WRITER()
+		-------------------------------------------------
+	*/
+	void compress_integer_elias_fano::decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		size_t filled = 0;
+		const uint8_t *from = static_cast<const uint8_t *>(source);
+
+		try
+			{
+			auto writer = [this, &filled, &remaining](__m256i document_ids)
+				{
+				add_rsv_fused(document_ids, filled, remaining);
+				};
+
+			decode_elias_fano(writer, 0, integers_to_decode, *from, from + 1, source_length - 1);
+			add_rsv_block(filled, remaining);
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO::UNITTEST()
+		---------------------------------------
+	*/
+	void compress_integer_elias_fano::unittest(void)
+		{
+		/*
+			A compress_integer is also a query (with accumulators) so it is too large for the stack
+		*/
+		auto compressor = std::make_unique<compress_integer_elias_fano>();
+		compress_integer::unittest(*compressor, 0);
+
+		/*
+			1000 d-gaps of 100 have a universe of 100,000 so there are 6 low bits, and 1000 + (100,000 >> 6) high bits.
+		*/
+		std::vector<integer> gaps(1000, 100);
+		std::vector<uint8_t> encoded(8192);
+		std::vector<integer> decoded(gaps.size() + 1024);
+		size_t took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		JASS_assert(encoded[0] == 6);
+		JASS_assert(took == 1 + (1000 * 6 + 7) / 8 + (1000 + (100'000 >> 6) + 7) / 8);
+		compressor->decode(decoded.data(), gaps.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), gaps.data(), gaps.size() * sizeof(integer)) == 0);
+
+		/*
+			A first d-gap of 0 (document 0), and the overflow case
+		*/
+		gaps = {0, 1, 1, 5, 1000, 1};
+		took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		compressor->decode(decoded.data(), gaps.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), gaps.data(), gaps.size() * sizeof(integer)) == 0);
+		JASS_assert(compressor->encode(encoded.data(), 2, gaps.data(), gaps.size()) == 0);
+
+		/*
+			Check the fused decode and accumulate
+		*/
+		compress_integer::unittest_decode_with_writer(*compressor);
+
+		puts("compress_integer_elias_fano::PASSED");
+		}
+	}
@@ -0,0 +1,343 @@
+/*
+	COMPRESS_INTEGER_ELIAS_FANO.H
+	-----------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Elias-Fano encoding of the document ids in a postings list (or impact segment).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <string.h>
+#include <immintrin.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "maths.h"
+#include "forceinline.h"
+#include "compress_integer.h"
+
+namespace JASS
+	{
+	/*
+		CLASS COMPRESS_INTEGER_ELIAS_FANO
+		---------------------------------
+	*/
+	/*!
+		@brief Elias-Fano encoding of the document ids in a postings list (or impact segment).
+		@details Like all the JASS codexes, the input is a sequence of d-gaps and decode() returns d-gaps.  Internally the d-gaps are summed to give
+		the (non-decreasing) document ids and these are Elias-Fano encoded.  Each document id is split into its low l bits and its high bits, where
+		l = floor(log2(universe / integers)).  The low bits are stored packed, one after the other.  The high bits are stored in unary as a bit
+		vector, for the i-th document id, bit (high + i) is set.  The encoding takes at most 2 + l bits per integer.  See:
+			P. Elias (1974), Efficient storage and retrieval by content and address of static files, Journal of the ACM, 21(2):246-260
+			R. M. Fano (1971), On the number of bits required to implement an associative memory, MIT Project MAC Computer Structures Group, Memo 61
+			S. Vigna (2013), Quasi-succinct indices, Proceedings of WSDM 2013, pp 83-92
+
+		The encoding is a byte holding l followed by the low bits then the high bits.
+
+		Decoding is done 8 integers at a time.  The high bits are found with TZCNT, the low bits are extracted with an AVX2 gather (each group of 8
+		low parts is exactly l bytes long), and the two are combined in an AVX2 register.  As this codex decodes document ids rather than d-gaps,
+		decode_with_writer() passes them directly to the accumulators without the cumulative sum.  decode() has to convert them back into d-gaps.
+		All arithmetic on the decoded document ids is done modulo 2^32 so sequences whose sum exceeds 32 bits are still decoded correctly.
+	*/
+	class compress_integer_elias_fano : public compress_integer
+		{
+		protected:
+			static constexpr uint32_t max_gather_low_bits = 25;		///< The gather reads 32 bits and the low part can start 7 bits into the first byte.
+
+		protected:
+			std::vector<uint64_t> document_ids;							///< The (64-bit) cumulative sum of the d-gaps being encoded.
+
+		protected:
+			/*
+				CLASS COMPRESS_INTEGER_ELIAS_FANO::SET_BIT_ITERATOR
+				---------------------------------------------------
+			*/
+			/*!
+				@brief Iterate over the positions of the set bits in a (little-endian) bit vector of a given length in bytes.
+				@details The bit vector is read 64 bits at a time, but never past its end.
+			*/
+			class set_bit_iterator
+				{
+				private:
+					const uint8_t *bytes;			///< The bit vector.
+					size_t length;						///< The length of the bit vector (in bytes).
+					size_t word_at;					///< The byte offset of the current 64-bit word.
+					uint64_t word;						///< The current word (with the already returned bits turned off).
+
+				private:
+					/*
+						COMPRESS_INTEGER_ELIAS_FANO::SET_BIT_ITERATOR::LOAD()
+						-----------------------------------------------------
+					*/
+					/*!
+						@brief Load the 64-bit word that starts at the given byte offset (padded with 0s if the bit vector ends before the word does).
+						@param at [in] The byte offset.
+						@return The word.
+					*/
+					forceinline uint64_t load(size_t at) const
+						{
+						uint64_t got = 0;
+						if (at + sizeof(got) <= length)
+							memcpy(&got, bytes + at, sizeof(got));
+						else if (at < length)
+							memcpy(&got, bytes + at, length - at);
+						return got;
+						}
+
+				public:
+					/*
+						COMPRESS_INTEGER_ELIAS_FANO::SET_BIT_ITERATOR::SET_BIT_ITERATOR()
+						-----------------------------------------------------------------
+					*/
+					/*!
+						@brief Constructor.
+						@param bytes [in] The bit vector.
+						@param length [in] The length of the bit vector (in bytes).
+					*/
+					set_bit_iterator(const uint8_t *bytes, size_t length) :
+						bytes(bytes),
+						length(length),
+						word_at(0),
+						word(load(0))
+						{
+						/* Nothing */
+						}
+
+					/*
+						COMPRESS_INTEGER_ELIAS_FANO::SET_BIT_ITERATOR::NEXT()
+						-----------------------------------------------------
+					*/
+					/*!
+						@brief Return the position of the next set bit (there must be one).
+						@return The bit position (from the start of the bit vector).
+					*/
+					forceinline uint64_t next(void)
+						{
+						while (word == 0)
+							{
+							word_at += sizeof(word);
+							word = load(word_at);
+							}
+						uint64_t position = word_at * 8 + _tzcnt_u64(word);
+						word &= word - 1;
+						return position;
+						}
+				};
+
+		protected:
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::LOW_BITS_FOR()
+				-------------------------------------------
+			*/
+			/*!
+				@brief Return the number of low bits that minimises the size of the Elias-Fano encoding.
+				@param universe [in] The largest value being encoded.
+				@param integers [in] The number of values being encoded.
+				@return floor(log2(universe / integers)), which is at most 32.
+			*/
+			static uint32_t low_bits_for(uint64_t universe, size_t integers)
+				{
+				uint64_t average = universe / integers;
+				return average == 0 ? 0 : (std::min)(static_cast<uint32_t>(maths::floor_log2(average)), static_cast<uint32_t>(32));
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::ENCODED_SIZE()
+				-------------------------------------------
+			*/
+			/*!
+				@brief Return the size (in bytes) of the low bits and high bits of an Elias-Fano encoding.
+				@param universe [in] The largest value being encoded.
+				@param integers [in] The number of values being encoded.
+				@param low_bits [in] The number of low bits.
+				@param low_bytes [out] The size of the low bits.
+				@param high_bytes [out] The size of the high bits.
+			*/
+			static void encoded_size(uint64_t universe, size_t integers, uint32_t low_bits, size_t &low_bytes, size_t &high_bytes)
+				{
+				low_bytes = (integers * low_bits + 7) / 8;
+				high_bytes = (integers + (universe >> low_bits) + 7) / 8;
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::READ_BITS()
+				----------------------------------------
+			*/
+			/*!
+				@brief Extract bits bits from a bit string without reading past its end.
+				@param bytes [in] The bit string.
+				@param length [in] The length of the bit string (in bytes).
+				@param bit_offset [in] The offset (in bits) of the first bit.
+				@param bits [in] The number of bits to extract (at most 32).
+				@return The bits.
+			*/
+			static forceinline uint32_t read_bits(const uint8_t *bytes, size_t length, size_t bit_offset, uint32_t bits)
+				{
+				uint64_t word = 0;
+				size_t byte = bit_offset / 8;
+				if (byte < length)
+					memcpy(&word, bytes + byte, (std::min)(sizeof(word), length - byte));
+				return static_cast<uint32_t>((word >> (bit_offset % 8)) & ((1ULL << bits) - 1));
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::ENCODE_ELIAS_FANO()
+				------------------------------------------------
+			*/
+			/*!
+				@brief Elias-Fano encode a non-decreasing sequence of values relative to a base.
+				@param encoded [out] The low bits followed by the high bits.
+				@param encoded_buffer_length [in] The length (in bytes) of encoded.
+				@param source [in] The values (each at least base).
+				@param source_integers [in] The number of values.
+				@param base [in] The value subtracted from each value before encoding.
+				@param low_bits [in] The number of low bits (see low_bits_for()).
+				@return The number of bytes used, or 0 if encoded is too small.
+			*/
+			static size_t encode_elias_fano(uint8_t *encoded, size_t encoded_buffer_length, const uint64_t *source, size_t source_integers, uint64_t base, uint32_t low_bits);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::DECODE_ELIAS_FANO()
+				------------------------------------------------
+			*/
+			/*!
+				@brief Decode an Elias-Fano encoded sequence 8 integers at a time, passing each register of (base + value) to the writer.
+				@details The final register is padded with garbage if integers is not a multiple of 8.  Nothing is read past the end of source.
+				@param writer [in] A callable taking an __m256i of document ids.
+				@param base [in] The value to add to each decoded value.
+				@param integers [in] The number of integers to decode.
+				@param low_bits [in] The number of low bits.
+				@param source [in] The low bits followed by the high bits.
+				@param source_length [in] The number of bytes that can be read from source (at least the size of the encoding).
+			*/
+			template <typename WRITER>
+			static forceinline void decode_elias_fano(WRITER &writer, integer base, size_t integers, uint32_t low_bits, const uint8_t *source, size_t source_length)
+				{
+				size_t low_bytes = (integers * low_bits + 7) / 8;
+				set_bit_iterator high(source + low_bytes, source_length - low_bytes);
+
+				const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+				const __m256i lane_bit = _mm256_mullo_epi32(lane, _mm256_set1_epi32(low_bits));
+				const __m256i lane_byte = _mm256_srli_epi32(lane_bit, 3);
+				const __m256i lane_shift = _mm256_and_si256(lane_bit, _mm256_set1_epi32(7));
+				const __m256i mask = _mm256_set1_epi32(static_cast<int>((1ULL << low_bits) - 1));
+				const __m128i shift = _mm_cvtsi32_si128(low_bits);
+				const __m256i bases = _mm256_set1_epi32(base);
+
+				/*
+					Each full group of 8 low parts is low_bits bytes long.  The gather reads 4 bytes from each lane's first byte, so it can only be used
+					if that stays inside the source.
+				*/
+				size_t groups = (integers + 7) / 8;
+				size_t gather_groups;
+				if (low_bits == 0)
+					gather_groups = groups;
+				else if (low_bits > max_gather_low_bits || source_length < 3)
+					gather_groups = 0;
+				else
+					gather_groups = (std::min)(integers / 8, (source_length - 3) / low_bits);
+
+				alignas(32) uint32_t high_parts[8] = {};
+				alignas(32) uint32_t low_parts[8] = {};
+				size_t index = 0;
+				for (size_t group = 0; group < groups; group++, index += 8)
+					{
+					size_t valid = (std::min)(static_cast<size_t>(8), integers - index);
+					for (size_t which = 0; which < valid; which++)
+						high_parts[which] = static_cast<uint32_t>(high.next() - (index + which));
+
+					__m256i low;
+					if (group < gather_groups)
+						low = low_bits == 0 ? _mm256_setzero_si256() : _mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(reinterpret_cast<const int *>(source + group * low_bits), lane_byte, 1), lane_shift), mask);
+					else
+						{
+						for (size_t which = 0; which < valid; which++)
+							low_parts[which] = read_bits(source, low_bytes, (index + which) * low_bits, low_bits);
+						low = _mm256_load_si256(reinterpret_cast<const __m256i *>(low_parts));
+						}
+
+					__m256i high_part = _mm256_sll_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(high_parts)), shift);
+					writer(_mm256_add_epi32(bases, _mm256_or_si256(high_part, low)));
+					}
+				}
+
+		public:
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::COMPRESS_INTEGER_ELIAS_FANO()
+				----------------------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+			*/
+			compress_integer_elias_fano()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::~COMPRESS_INTEGER_ELIAS_FANO()
+				-----------------------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~compress_integer_elias_fano()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::ENCODE()
+				-------------------------------------
+			*/
+			/*!
+				@brief Encode a sequence of integers returning the number of bytes used for the encoding, or 0 if the encoded sequence doesn't fit in the buffer.
+				@param encoded [out] The sequence of bytes that is the encoded sequence.
+				@param encoded_buffer_length [in] The length (in bytes) of the output buffer, encoded.
+				@param source [in] The sequence of integers to encode.
+				@param source_integers [in] The length (in integers) of the source buffer.
+				@return The number of bytes used to encode the integer sequence, or 0 on error (i.e. overflow).
+			*/
+			virtual size_t encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::DECODE()
+				-------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with this codex.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::DECODE_WITH_WRITER()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Decode the document ids and add the impact to the accumulator of each document without the cumulative sum.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO::UNITTEST()
+				---------------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
@@ -0,0 +1,212 @@
+/*
+	COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED.CPP
+	-------------------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include "asserts.h"
+#include "compress_integer_variable_byte.h"
+#include "compress_integer_elias_fano_partitioned.h"
+
+namespace JASS
+	{
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::ENCODE()
+		-------------------------------------------------
+	*/
+	size_t compress_integer_elias_fano_partitioned::encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers)
+		{
+		if (source_integers == 0)
+			return 0;
+
+		/*
+			Convert the d-gaps into document ids (using 64 bits so that the sequence is non-decreasing even if the sum overflows 32 bits)
+		*/
+		document_ids.resize(source_integers);
+		uint64_t sum = 0;
+		for (size_t which = 0; which < source_integers; which++)
+			document_ids[which] = sum += source[which];
+
+		uint8_t *into = static_cast<uint8_t *>(encoded);
+		uint8_t *end = into + encoded_buffer_length;
+		uint64_t base = 0;
+
+		for (size_t index = 0; index < source_integers; index += partition_size)
+			{
+			size_t count = (std::min)(partition_size, source_integers - index);
+			const uint64_t *partition = document_ids.data() + index;
+			uint64_t span = partition[count - 1] - base;
+
+			/*
+				Is it a run (base + 1, base + 2, ...) or strictly increasing (so a bitmap can be used)?
+			*/
+			bool run = span == count;
+			bool strictly_increasing = true;
+			for (size_t which = 0; which < count; which++)
+				{
+				uint64_t previous = which == 0 ? base : partition[which - 1];
+				if (partition[which] != previous + 1)
+					run = false;
+				if (which != 0 && partition[which] == previous)
+					strictly_increasing = false;
+				}
+
+			if (run)
+				{
+				if (into >= end)
+					return 0;
+				*into++ = type_run;
+				base = partition[count - 1];
+				continue;
+				}
+
+			/*
+				Choose the smaller of Elias-Fano and a bitmap (which needs a bit for every document id in the range).
+			*/
+			uint32_t low_bits = low_bits_for(span, count);
+			size_t low_bytes;
+			size_t high_bytes;
+			encoded_size(span, count, low_bits, low_bytes, high_bytes);
+			size_t bitmap_bytes = static_cast<size_t>(span / 8 + 1);
+			bool bitmap = strictly_increasing && bitmap_bytes < low_bytes + high_bytes;
+
+			size_t header_bytes = 1 + compress_integer_variable_byte::bytes_needed_for(span);
+			if (static_cast<size_t>(end - into) < header_bytes)
+				return 0;
+			*into++ = bitmap ? type_bitmap : static_cast<uint8_t>(low_bits);
+			compress_integer_variable_byte::compress_into(into, span);
+
+			if (bitmap)
+				{
+				if (static_cast<size_t>(end - into) < bitmap_bytes)
+					return 0;
+				memset(into, 0, bitmap_bytes);
+				for (size_t which = 0; which < count; which++)
+					{
+					uint64_t position = partition[which] - base;
+					into[position / 8] |= 1 << (position % 8);
+					}
+				into += bitmap_bytes;
+				}
+			else
+				{
+				size_t took = encode_elias_fano(into, end - into, partition, count, base, low_bits);
+				if (took == 0)
+					return 0;
+				into += took;
+				}
+
+			base = partition[count - 1];
+			}
+
+		return into - static_cast<uint8_t *>(encoded);
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::DECODE()
+		-------------------------------------------------
+	*/
+	void compress_integer_elias_fano_partitioned::decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length)
+		{
+		integer *into = decoded;
+		auto writer = [&into](__m256i document_ids)
+			{
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(into), document_ids);
+			into += 8;
+			};
+
+		decode_partitions(writer, integers_to_decode, static_cast<const uint8_t *>(source), source_length);
+
+		/*
+			Callers of decode() expect d-gaps
+		*/
+		d1_encode(decoded, decoded, integers_to_decode);
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::DECODE_WITH_WRITER()
+		-------------------------------------------------------------
+	*/
+	void compress_integer_elias_fano_partitioned::decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		size_t filled = 0;
+
+		try
+			{
+			auto writer = [this, &filled, &remaining](__m256i document_ids)
+				{
+				add_rsv_fused(document_ids, filled, remaining);
+				};
+
+			decode_partitions(writer, integers_to_decode, static_cast<const uint8_t *>(source), source_length);
+			add_rsv_block(filled, remaining);
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::UNITTEST()
+		---------------------------------------------------
+	*/
+	void compress_integer_elias_fano_partitioned::unittest(void)
+		{
+		/*
+			A compress_integer is also a query (with accumulators) so it is too large for the stack
+		*/
+		auto compressor = std::make_unique<compress_integer_elias_fano_partitioned>();
+		compress_integer::unittest(*compressor, 0);
+
+		std::vector<uint8_t> encoded(16384);
+		std::vector<integer> decoded(4096);
+
+		/*
+			A run of consecutive document ids is one byte per partition
+		*/
+		std::vector<integer> gaps(1000, 1);
+		size_t took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		JASS_assert(took == (1000 + partition_size - 1) / partition_size);
+		compressor->decode(decoded.data(), gaps.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), gaps.data(), gaps.size() * sizeof(integer)) == 0);
+
+		/*
+			Dense (a bitmap), then sparse (Elias-Fano), then dense again, then a run, and a partial partition at the end
+		*/
+		gaps.clear();
+		for (size_t which = 0; which < partition_size; which++)
+			gaps.push_back(1 + which % 2);
+		for (size_t which = 0; which < partition_size; which++)
+			gaps.push_back(1000 + which);
+		for (size_t which = 0; which < partition_size; which++)
+			gaps.push_back(1 + which % 3);
+		for (size_t which = 0; which < partition_size; which++)
+			gaps.push_back(1);
+		for (size_t which = 0; which < 13; which++)
+			gaps.push_back(7);
+
+		took = compressor->encode(encoded.data(), encoded.size(), gaps.data(), gaps.size());
+		JASS_assert(encoded[0] == type_bitmap);
+		compressor->decode(decoded.data(), gaps.size(), encoded.data(), took);
+		JASS_assert(memcmp(decoded.data(), gaps.data(), gaps.size() * sizeof(integer)) == 0);
+
+		/*
+			The overflow case
+		*/
+		JASS_assert(compressor->encode(encoded.data(), 8, gaps.data(), gaps.size()) == 0);
+
+		/*
+			Check the fused decode and accumulate
+		*/
+		compress_integer::unittest_decode_with_writer(*compressor);
+
+		puts("compress_integer_elias_fano_partitioned::PASSED");
+		}
+	}
@@ -0,0 +1,186 @@
+/*
+	COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED.H
+	-----------------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Partitioned Elias-Fano encoding of the document ids in a postings list (or impact segment).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include "compress_integer_elias_fano.h"
+
+namespace JASS
+	{
+	/*
+		CLASS COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED
+		---------------------------------------------
+	*/
+	/*!
+		@brief Partitioned Elias-Fano encoding of the document ids in a postings list (or impact segment).
+		@details The document ids are broken into partitions of partition_size integers and each partition is encoded relative to the last
+		document id of the previous partition, using whichever of three encodings is smallest: Elias-Fano (with the number of low bits chosen for
+		that partition), a bitmap, or (if the partition is a run of consecutive document ids) nothing at all.  Clustered document ids (dense regions
+		of a list) are therefore stored in fewer bits than with a single Elias-Fano encoding of the whole list.  See:
+			G. Ottaviano, R. Venturini (2014), Partitioned Elias-Fano indexes, Proceedings of SIGIR 2014, pp 273-282
+
+		Ottaviano and Venturini choose the partition boundaries with a dynamic program, here they are fixed.  Each partition is a one byte type
+		(0-32 is the number of Elias-Fano low bits, then bitmap or run) followed (except for runs) by the variable byte encoded difference between
+		its last document id and the previous partition's last document id, followed by the encoding.  Decoding (and decode_with_writer()) is done
+		8 integers at a time in AVX2 registers as with compress_integer_elias_fano.
+	*/
+	class compress_integer_elias_fano_partitioned : public compress_integer_elias_fano
+		{
+		protected:
+			static constexpr size_t partition_size = 128;			///< The number of integers in each partition (a multiple of 8).
+			static constexpr uint8_t type_bitmap = 33;				///< The partition is a bitmap (bit n is set if base + n is in the list).
+			static constexpr uint8_t type_run = 34;					///< The partition is the document ids base + 1 .. base + partition_size.
+
+		protected:
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::DECODE_PARTITIONS()
+				------------------------------------------------------------
+			*/
+			/*!
+				@brief Decode the partitions 8 integers at a time, passing each register of document ids to the writer.
+				@param writer [in] A callable taking an __m256i of document ids.
+				@param integers [in] The number of integers to decode.
+				@param source [in] The encoded partitions.
+				@param source_length [in] The length (in bytes) of source.
+			*/
+			template <typename WRITER>
+			static forceinline void decode_partitions(WRITER &writer, size_t integers, const uint8_t *source, size_t source_length)
+				{
+				const uint8_t *end = source + source_length;
+				integer base = 0;
+
+				for (size_t index = 0; index < integers; index += partition_size)
+					{
+					size_t count = (std::min)(partition_size, integers - index);
+					uint8_t type = *source++;
+
+					if (type == type_run)
+						{
+						__m256i document_ids = _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8));
+						for (size_t group = 0; group < count; group += 8)
+							{
+							writer(document_ids);
+							document_ids = _mm256_add_epi32(document_ids, _mm256_set1_epi32(8));
+							}
+						base += static_cast<integer>(count);
+						continue;
+						}
+
+					/*
+						Variable byte encoded upper bound (relative to base)
+					*/
+					uint64_t span = 0;
+					while ((*source & 0x80) == 0)
+						span = (span << 7) | *source++;
+					span = (span << 7) | (*source++ & 0x7F);
+
+					if (type == type_bitmap)
+						{
+						size_t bitmap_bytes = static_cast<size_t>(span / 8 + 1);
+						set_bit_iterator bits(source, bitmap_bytes);
+						alignas(32) uint32_t positions[8] = {};
+						for (size_t group = 0; group < count; group += 8)
+							{
+							size_t valid = (std::min)(static_cast<size_t>(8), count - group);
+							for (size_t which = 0; which < valid; which++)
+								positions[which] = static_cast<uint32_t>(bits.next());
+							writer(_mm256_add_epi32(_mm256_set1_epi32(base), _mm256_load_si256(reinterpret_cast<const __m256i *>(positions))));
+							}
+						source += bitmap_bytes;
+						}
+					else
+						{
+						size_t low_bytes;
+						size_t high_bytes;
+						encoded_size(span, count, type, low_bytes, high_bytes);
+						decode_elias_fano(writer, base, count, type, source, end - source);
+						source += low_bytes + high_bytes;
+						}
+
+					base += static_cast<integer>(span);
+					}
+				}
+
+		public:
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED()
+				----------------------------------------------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+			*/
+			compress_integer_elias_fano_partitioned()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::~COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED()
+				-----------------------------------------------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~compress_integer_elias_fano_partitioned()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::ENCODE()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Encode a sequence of integers returning the number of bytes used for the encoding, or 0 if the encoded sequence doesn't fit in the buffer.
+				@param encoded [out] The sequence of bytes that is the encoded sequence.
+				@param encoded_buffer_length [in] The length (in bytes) of the output buffer, encoded.
+				@param source [in] The sequence of integers to encode.
+				@param source_integers [in] The length (in integers) of the source buffer.
+				@return The number of bytes used to encode the integer sequence, or 0 on error (i.e. overflow).
+			*/
+			virtual size_t encode(void *encoded, size_t encoded_buffer_length, const integer *source, size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::DECODE()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with this codex.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::DECODE_WITH_WRITER()
+				-------------------------------------------------------------
+			*/
+			/*!
+				@brief Decode the document ids and add the impact to the accumulator of each document without the cumulative sum.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_ELIAS_FANO_PARTITIONED::UNITTEST()
+				---------------------------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
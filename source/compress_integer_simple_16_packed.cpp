@@ -11,13 +11,41 @@
 */
 #include <stdio.h>
 
+#include <random>
 #include <vector>
 
 #include "maths.h"
+#include "asserts.h"
+#include "simple_simd_decoder.h"
 #include "compress_integer_simple_16_packed.h"
 
 namespace JASS
 	{
+	/*
+		COMPRESS_INTEGER_SIMPLE_16_PACKED::SIMD_DECODER
+		-----------------------------------------------
+		The layout of each selector (low bits first) for the AVX2 and AVX-512 decoders
+	*/
+	static const simple_simd_decoder simd_decoder =
+		{
+		{{28, 1}},
+		{{7, 2}, {14, 1}},
+		{{7, 1}, {7, 2}, {7, 1}},
+		{{14, 1}, {7, 2}},
+		{{14, 2}},
+		{{1, 4}, {8, 3}},
+		{{1, 3}, {4, 4}, {3, 3}},
+		{{7, 4}},
+		{{4, 5}, {2, 4}},
+		{{2, 4}, {4, 5}},
+		{{3, 6}, {2, 5}},
+		{{2, 5}, {3, 6}},
+		{{4, 7}},
+		{{1, 10}, {2, 9}},
+		{{2, 14}},
+		{{1, 28}}
+		};
+
 	/*
 		COMPRESS_INTEGER_SIMPLE_16_PACKED::SIMPLE16_SHIFT_TABLE
 		-------------------------------------------------------
@@ -258,6 +286,18 @@ namespace JASS
 		-------------------------------------------
 	*/
 	void compress_integer_simple_16_packed::decode(integer *destination, size_t destination_integers, const void *source, size_t source_length)
+		{
+		if (simd_decoder.available())
+			simd_decoder.decode(destination, destination_integers, source);
+		else
+			decode_scalar(destination, destination_integers, source, source_length);
+		}
+
+	/*
+		COMPRESS_INTEGER_SIMPLE_16_PACKED::DECODE_SCALAR()
+		--------------------------------------------------
+	*/
+	void compress_integer_simple_16_packed::decode_scalar(integer *destination, size_t destination_integers, const void *source, size_t source_length)
 		{
 		const uint32_t *compressed_sequence = reinterpret_cast<const uint32_t *>(source);
 		integer *end = destination + destination_integers;
@@ -606,6 +646,46 @@ namespace JASS
 		compressor->decode(&decompressed[0], every_case.size(), &compressed[0], size_once_compressed);
 		decompressed.resize(every_case.size());
 		JASS_assert(decompressed == every_case);
+
+		/*
+			Make sure the scalar and each of the SIMD decoders (that this CPU can run) get the same answer, including on a random mix of selectors
+		*/
+		std::vector<integer> random_case;
+		std::mt19937 generator(1);
+		for (instance = 0; instance < 10000; instance++)
+			{
+			uint32_t bits = generator() % 29;
+			random_case.push_back(generator() & ((static_cast<uint64_t>(1) << bits) - 1));
+			}
+
+		for (const auto &sequence : {every_case, random_case})
+			{
+			std::vector<uint32_t> encoded(sequence.size() * 2 + 256);
+			std::vector<uint32_t> expected(sequence.size() + 256);
+			std::vector<uint32_t> got(sequence.size() + 256);
+
+			auto took = compressor->encode(&encoded[0], encoded.size() * sizeof(encoded[0]), &sequence[0], sequence.size());
+			JASS_assert(took != 0);
+
+			compressor->decode_scalar(&expected[0], sequence.size(), &encoded[0], took);
+			expected.resize(sequence.size());
+			JASS_assert(expected == sequence);
+
+			if (hardware_support::detected().simd() >= hardware_support::avx2)
+				{
+				std::fill(got.begin(), got.end(), 0);
+				simple_simd_decoder::decode_avx2(simd_decoder, &got[0], sequence.size(), &encoded[0]);
+				got.resize(sequence.size());
+				JASS_assert(got == sequence);
+				}
+			if (hardware_support::detected().simd() >= hardware_support::avx512)
+				{
+				got.assign(sequence.size() + 256, 0);
+				simple_simd_decoder::decode_avx512(simd_decoder, &got[0], sequence.size(), &encoded[0]);
+				got.resize(sequence.size());
+				JASS_assert(got == sequence);
+				}
+			}
 		
 		/*
 			Try the error cases and edge cases
@@ -102,6 +102,19 @@ namespace JASS
 			*/
 			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
 
+			/*
+				COMPRESS_INTEGER_SIMPLE_9_PACKED::DECODE_SCALAR()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with this codex without using SIMD instructions (decode() uses this if the CPU does not have AVX2).
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			void decode_scalar(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
+
 			/*
 				COMPRESS_INTEGER_SIMPLE_9_PACKED::UNITTEST()
 				--------------------------------------------
@@ -8,6 +8,7 @@
 #include <stdio.h>
 
 #include <random>
+#include <algorithm>
 
 #include "asserts.h"
 #include "compress_integer_stream_vbyte.h"
@@ -42,6 +43,76 @@ namespace JASS
 		streamvbyte::streamvbyte_decode(reinterpret_cast<uint8_t *>(const_cast<void *>(source_as_void)), decoded, static_cast<uint32_t>(integers_to_decode));
 		}
 
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE::BYTES_NEEDED_FOR()
+		-------------------------------------------------
+	*/
+	size_t compress_integer_stream_vbyte::bytes_needed_for(size_t source_integers)
+		{
+		return streamvbyte::streamvbyte_max_compressedbytes(static_cast<uint32_t>(source_integers));
+		}
+
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE::COMPRESS_INTO()
+		----------------------------------------------
+	*/
+	size_t compress_integer_stream_vbyte::compress_into(uint8_t *encoded, const integer *source, size_t source_integers)
+		{
+		return streamvbyte::streamvbyte_encode(const_cast<integer *>(source), static_cast<uint32_t>(source_integers), encoded);
+		}
+
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE::DECOMPRESS_INTO()
+		------------------------------------------------
+	*/
+	size_t compress_integer_stream_vbyte::decompress_into(integer *decoded, size_t integers_to_decode, const uint8_t *source)
+		{
+		return streamvbyte::streamvbyte_decode(source, decoded, static_cast<uint32_t>(integers_to_decode));
+		}
+
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE::DECODE_WITH_WRITER()
+		---------------------------------------------------
+	*/
+	void compress_integer_stream_vbyte::decode_with_writer(size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		size_t filled = 0;
+		const uint8_t *keys = static_cast<const uint8_t *>(source_as_void);
+		const uint8_t *data = keys + (integers_to_decode + 3) / 4;
+
+		try
+			{
+			/*
+				Each key byte describes 4 integers so decode 2 key bytes at a time into one AVX2 register
+			*/
+			const uint8_t *end_of_keys = keys + integers_to_decode / 8 * 2;
+			for (; keys < end_of_keys; keys += 2)
+				{
+				__m128i low = streamvbyte::_decode_avx(keys[0], &data);
+				__m128i high = streamvbyte::_decode_avx(keys[1], &data);
+				add_rsv_d1_fused(_mm256_set_m128i(high, low), filled, remaining);
+				}
+
+			/*
+				Decode the (up to 7) integers at the end one at a time (so as not to read past the end of the source)
+			*/
+			if (integers_to_decode % 8 != 0)
+				{
+				alignas(32) integer gaps[8] = {0};
+				for (size_t which = 0; which < integers_to_decode % 8; which++)
+					gaps[which] = streamvbyte::_decode_data(&data, (keys[which / 4] >> ((which % 4) * 2)) & 0x3);
+				add_rsv_d1_fused(_mm256_load_si256(reinterpret_cast<__m256i *>(gaps)), filled, remaining);
+				}
+
+			add_rsv_block(filled, remaining);
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+
 	/*
 		COMPRESS_INTEGER_STREAM_VBYTE::UNITTEST()
 		-----------------------------------------
@@ -79,6 +150,16 @@ namespace JASS
 
 		auto will_take = streamvbyte::streamvbyte_max_compressedbytes(128);
 		JASS_assert(will_take == 544);
+		JASS_assert(bytes_needed_for(128) == 544);
+
+		/*
+			The object-free encoder and decoder (which must report the number of bytes used)
+		*/
+		std::vector<uint8_t> encoded(bytes_needed_for(sequence.size()));
+		size_once_compressed = compress_into(&encoded[0], &sequence[0], sequence.size());
+		std::fill(decompressed.begin(), decompressed.end(), 0);
+		JASS_assert(decompress_into(&decompressed[0], sequence.size(), &encoded[0]) == size_once_compressed);
+		JASS_assert(decompressed == sequence);
 
 		sequence.clear();
 		uint32_t empty = 0;
@@ -90,6 +171,11 @@ namespace JASS
 		*/
 		compressor->decode(&decompressed[0], 0, &compressed[0], size_once_compressed);
 
+		/*
+			Check the fused decode and accumulate
+		*/
+		compress_integer::unittest_decode_with_writer(*compressor);
+
 		/*
 			The tests have passed
 		*/
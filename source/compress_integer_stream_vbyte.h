@@ -79,6 +79,54 @@ namespace JASS
 			*/
 			virtual void decode(integer *decoded, size_t integers_to_decode, const void *source, size_t source_length);
 
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE::DECODE_WITH_WRITER()
+				---------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of d-gaps and add the impact to the accumulator of each document without going through decompress_buffer.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE::BYTES_NEEDED_FOR()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Return the largest number of bytes compress_into() might use to encode a sequence of the given length.
+				@param source_integers [in] The length (in integers) of the sequence.
+				@return The worst case size (in bytes) of the encoded sequence.
+			*/
+			static size_t bytes_needed_for(size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE::COMPRESS_INTO()
+				----------------------------------------------
+			*/
+			/*!
+				@brief Encode a sequence of integers without a compress_integer object (which is also a query, so large).
+				@param encoded [out] The encoded sequence (which must be at least bytes_needed_for(source_integers) bytes long).
+				@param source [in] The sequence of integers to encode.
+				@param source_integers [in] The length (in integers) of the source buffer.
+				@return The number of bytes used to encode the integer sequence.
+			*/
+			static size_t compress_into(uint8_t *encoded, const integer *source, size_t source_integers);
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE::DECOMPRESS_INTO()
+				------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers encoded with compress_into() (or encode()) without a compress_integer object.
+				@param decoded [out] The sequence of decoded integers (exactly integers_to_decode are written).
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@return The number of bytes of source that were decoded.
+			*/
+			static size_t decompress_into(integer *decoded, size_t integers_to_decode, const uint8_t *source);
 
 			/*
 				COMPRESS_INTEGER_STREAM_VBYTE::UNITTEST()
@@ -0,0 +1,141 @@
+/*
+	COMPRESS_INTEGER_STREAM_VBYTE_D1.CPP
+	------------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+#include <stdio.h>
+
+#include <random>
+#include <algorithm>
+
+#include "asserts.h"
+#include "compress_integer_stream_vbyte_d1.h"
+
+namespace streamvbyte
+	{
+	size_t streamvbyte_encode4(__m128i in, uint8_t *outData, uint8_t *outCode);		// in compress_integer_stream_vbyte.cpp
+	}
+
+namespace streamvbyte_d1
+	{
+	#ifdef _MSC_VER
+		#define __restrict__ __restrict
+	#endif
+
+	/*
+		Only the delta decoder is used from these, so the encoding table and streamvbyte_max_compressedbytes() are unused here
+	*/
+	#ifdef __GNUC__
+		#pragma GCC diagnostic push
+		#pragma GCC diagnostic ignored "-Wunused-variable"
+		#pragma GCC diagnostic ignored "-Wunused-function"
+	#endif
+
+	#include "../external/streamvbyte/src/streamvbyte_shuffle_tables.h"
+	#include "../external/streamvbyte/src/streamvbytedelta.c"
+
+	#ifdef __GNUC__
+		#pragma GCC diagnostic pop
+	#endif
+
+	/*
+		STREAMVBYTE_ENCODE4()
+		---------------------
+		The delta encoder in streamvbytedelta.c calls the encoder in streamvbyte.c, which is compiled (in its own namespace) with compress_integer_stream_vbyte
+	*/
+	size_t streamvbyte_encode4(__m128i in, uint8_t *outData, uint8_t *outCode)
+		{
+		return streamvbyte::streamvbyte_encode4(in, outData, outCode);
+		}
+	}
+
+namespace JASS
+	{
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE_D1::DECODE_WITH_WRITER()
+		------------------------------------------------------
+	*/
+	void compress_integer_stream_vbyte_d1::decode_with_writer(size_t integers_to_decode, const void *source_as_void, size_t source_length)
+		{
+		size_t remaining = integers_to_decode;
+		const uint8_t *keys = static_cast<const uint8_t *>(source_as_void);
+		const uint8_t *data = keys + (integers_to_decode + 3) / 4;
+		DOCID_TYPE *document_ids = reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data());
+
+		try
+			{
+			/*
+				Decode FUSED_BLOCK_SIZE (a multiple of 4, so a whole number of key bytes) document ids at a time into the block at the start of
+				decompress_buffer, then add them to the accumulators.  The running document id is carried from one block to the next.
+			*/
+			while (remaining != 0)
+				{
+				size_t block = (std::min)(remaining, FUSED_BLOCK_SIZE);
+				data = streamvbyte_d1::svb_decode_avx_d1_init(document_ids, keys, data, block, d1_cumulative_sum);
+				keys += block / 4;
+				d1_cumulative_sum = document_ids[block - 1];
+				add_rsv_block(block, remaining);
+				}
+			}
+		catch (Done &)
+			{
+			/* Nothing */
+			}
+		}
+
+	/*
+		COMPRESS_INTEGER_STREAM_VBYTE_D1::UNITTEST()
+		--------------------------------------------
+	*/
+	void compress_integer_stream_vbyte_d1::unittest(void)
+		{
+		/*
+			A compress_integer is also a query (with accumulators) so it is too large for the stack
+		*/
+		auto compressor = std::make_unique<compress_integer_stream_vbyte_d1>();
+		compress_integer::unittest(*compressor);
+
+		/*
+			Check the fused decode and accumulate
+		*/
+		compress_integer::unittest_decode_with_writer(*compressor);
+
+		/*
+			A long list (several blocks) with a mix of 1 and 2 byte d-gaps, including runs of 1 byte d-gaps (the 16-bit path)
+		*/
+		std::mt19937 random(38);
+		std::vector<integer> gaps;
+		std::vector<integer> document_ids;
+		integer document_id = 0;
+		for (size_t posting = 0; posting < 900; posting++)
+			{
+			integer gap = posting % 200 < 100 ? 1 + random() % 3 : 1 + random() % (random() % 2 == 0 ? 200 : 3000);
+			document_ids.push_back(document_id += gap);
+			gaps.push_back(gap);
+			}
+
+		std::vector<std::string> primary_keys;
+		for (size_t document = 0; document <= document_id; document++)
+			primary_keys.push_back(std::to_string(document));
+		compressor->init(primary_keys, document_id + 1, gaps.size());
+
+		std::vector<uint8_t> compressed(gaps.size() * sizeof(integer) * 2 + 1024);
+		size_t compressed_size = compressor->encode(&compressed[0], compressed.size(), &gaps[0], gaps.size());
+
+		compressor->rewind();
+		compressor->decode_and_process(5, gaps.size(), &compressed[0], compressed_size);
+
+		std::vector<integer> found;
+		for (const auto &result : *compressor)
+			{
+			JASS_assert(result.rsv == 5);
+			found.push_back(static_cast<integer>(result.document_id));
+			}
+		std::sort(found.begin(), found.end());
+		JASS_assert(found == document_ids);
+
+		puts("compress_integer_stream_vbyte_d1::PASSED");
+		}
+	}
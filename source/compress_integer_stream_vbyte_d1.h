@@ -0,0 +1,80 @@
+/*
+	COMPRESS_INTEGER_STREAM_VBYTE_D1.H
+	----------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Stream VByte with the prefix sum (d1 decoding) done inside the decode kernel.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include "compress_integer_stream_vbyte.h"
+
+namespace JASS
+	{
+	/*
+		CLASS COMPRESS_INTEGER_STREAM_VBYTE_D1
+		--------------------------------------
+	*/
+	/*!
+		@brief Stream VByte with the prefix sum (d1 decoding) done inside the decode kernel.
+		@details The encoding is exactly that of compress_integer_stream_vbyte (the d-gaps are Stream VByte encoded) so encode() and decode()
+		are inherited.  decode_with_writer() uses Lemire's delta-aware decoder (svb_decode_avx_d1_init()) which prefix sums each register of
+		4 d-gaps as it is unpacked, carrying the running document id across registers (and, here, across blocks of FUSED_BLOCK_SIZE integers).
+		The document ids are written straight into the block at the start of decompress_buffer and passed on to the accumulators each time
+		the block fills.  So the d-gaps are never stored and there is no separate cumulative sum pass.  Runs of 32 one-byte d-gaps (common in
+		low-impact segments) are prefix summed 8 at a time in 16-bit lanes.
+	*/
+	class compress_integer_stream_vbyte_d1 : public compress_integer_stream_vbyte
+		{
+		public:
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE_D1::COMPRESS_INTEGER_STREAM_VBYTE_D1()
+				--------------------------------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+			*/
+			compress_integer_stream_vbyte_d1()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE_D1::~COMPRESS_INTEGER_STREAM_VBYTE_D1()
+				---------------------------------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~compress_integer_stream_vbyte_d1()
+				{
+				/* Nothing */
+				}
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE_D1::DECODE_WITH_WRITER()
+				------------------------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of d-gaps into document ids (in the decode kernel) and add the impact to the accumulator of each document.
+				@param integers_to_decode [in] The number of integers to decode.
+				@param source [in] The encoded integers.
+				@param source_length [in] The length (in bytes) of the source buffer.
+			*/
+			virtual void decode_with_writer(size_t integers_to_decode, const void *source, size_t source_length);
+
+			/*
+				COMPRESS_INTEGER_STREAM_VBYTE_D1::UNITTEST()
+				--------------------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
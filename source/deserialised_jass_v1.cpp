@@ -203,6 +203,15 @@ namespace JASS
 			d_ness = 0;
 			return compress_integer_all::get_by_name("None");
 			}
+
+		/*
+			The compact headers prefix does not change the codex
+		*/
+		if (memory[0] == serialise_jass_v1::jass_v1_codex::compact_headers)
+			memory++;
+
+		if (memory[0] == serialise_jass_v1::jass_v1_codex::blocked)
+			return serialise_jass_v1::get_compressor(static_cast<serialise_jass_v1::jass_v1_codex>(memory[1]), name, d_ness, true);
 		else
 			return serialise_jass_v1::get_compressor(static_cast<serialise_jass_v1::jass_v1_codex>(memory[0]), name, d_ness);
 		}
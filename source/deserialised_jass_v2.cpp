@@ -4,7 +4,11 @@
 	Copyright (c) 2021 Andrew Trotman
 	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
 */
+#include "simd.h"
 #include "deserialised_jass_v2.h"
+#include "serialise_jass_v1.h"
+#include "index_postings_impact.h"
+#include "compress_integer_stream_vbyte.h"
 
 namespace JASS
 	{
@@ -130,4 +134,61 @@ namespace JASS
 		*/
 		return documents;
 		}
+	
+	/*
+		DESERIALISED_JASS_V2::READ_POSTINGS()
+		-------------------------------------
+	*/
+	size_t deserialised_jass_v2::read_postings(const std::string &filename)
+		{
+		auto postings_memory_length = deserialised_jass_v1::read_postings(filename);
+
+		compact_headers = postings_memory_length != 0 && postings()[0] == serialise_jass_v1::jass_v1_codex::compact_headers;
+
+		return postings_memory_length;
+		}
+
+	/*
+		DESERIALISED_JASS_V2::GET_COMPACT_SEGMENT_LIST()
+		------------------------------------------------
+	*/
+	size_t deserialised_jass_v2::get_compact_segment_list(segment_header *segments, metadata &metadata, size_t query_term_frequency, uint32_t &smallest, uint32_t &largest, query::DOCID_TYPE &document_frequency) const
+		{
+		/*
+			There is at most one segment per impact score so the headers fit on the stack
+		*/
+		alignas(64) compress_integer::integer headers[3 * index_postings_impact::largest_impact + 16];		// simd::cumulative_sum() can write 15 integers past the end
+		size_t segment_count = metadata.impacts;
+		const compress_integer::integer *impact = headers;
+		const compress_integer::integer *frequency = headers + segment_count;
+		compress_integer::integer *end = headers + 2 * segment_count;
+
+		/*
+			Decode the impacts, frequencies, and lengths, then turn the lengths into the ends of the segments (relative to the end of the headers)
+		*/
+		const uint8_t *segment_start = metadata.offset + compress_integer_stream_vbyte::decompress_into(headers, 3 * segment_count, metadata.offset);
+		simd::cumulative_sum(end, segment_count);
+
+		uint64_t base = segment_start - postings();
+		uint64_t start = base;
+		document_frequency = 0;
+		for (size_t segment = 0; segment < segment_count; segment++)
+			{
+			segments[segment].impact = impact[segment] * static_cast<uint32_t>(query_term_frequency);
+			segments[segment].offset = start;
+			segments[segment].end = start = base + end[segment];
+			segments[segment].segment_frequency = frequency[segment];
+			document_frequency += frequency[segment];
+			}
+
+		/*
+			Compute the smallest and largest impact scores and return them in the right order
+		*/
+		smallest = segments->impact;
+		largest = segments[segment_count - 1].impact;
+		if (smallest > largest)
+			std::swap(smallest, largest);
+
+		return segment_count;
+		}
 	}
@@ -26,6 +26,9 @@ namespace JASS
 	*/
 	class deserialised_jass_v2 : public deserialised_jass_v1
 		{
+		protected:
+			bool compact_headers;				///< The impact headers are in the compact format (see serialise_jass_v2).
+
 		protected:
 			/*
 				DESERIALISED_JASS_V2::READ_VOCABULARY()
@@ -50,6 +53,33 @@ namespace JASS
 			*/
 			virtual size_t read_primary_keys(const std::string &primary_key_filename = "CIdoclist.bin");
 
+			/*
+				DESERIALISED_JASS_V2::READ_POSTINGS()
+				-------------------------------------
+			*/
+			/*!
+				@brief Read the JASS v2 index postings file (and note the format of the impact headers)
+				@param postings_filename [in] the name of the file containing the postings ("CIpostings.bin")
+				@return The size of the postings file (in bytes) or 0 on error
+			*/
+			virtual size_t read_postings(const std::string &postings_filename = "CIpostings.bin");
+
+			/*
+				DESERIALISED_JASS_V2::GET_COMPACT_SEGMENT_LIST()
+				------------------------------------------------
+			*/
+			/*!
+				@brief get_segment_list() for compact impact headers (see serialise_jass_v2)
+				@param segments [out] The list of segments for the given search term (caller must ensure this ponts to a large enough array)
+				@param metadata [in] The metadata for the given search term
+				@param query_term_frequency [in] The number of times the term occurs in the query (the impact scores are multiplied by this)
+				@param smallest [out] The largest impact score for this term
+				@param largest [out] The smallest impact score for this term
+				@param document_frequency [out] The number of documents containing the term
+				@return The number of segments extracted and added to the list
+			*/
+			size_t get_compact_segment_list(segment_header *segments, metadata &metadata, size_t query_term_frequency, uint32_t &smallest, uint32_t &largest, query::DOCID_TYPE &document_frequency) const;
+
 		public:
 			/*
 				DESERIALISED_JASS_V2::DESERIALISED_JASS_V2()
@@ -60,7 +90,8 @@ namespace JASS
 				@param verbose [in] Should the index reading methods produce messages on stdout?
 			*/
 			explicit deserialised_jass_v2(bool verbose = false) :
-				deserialised_jass_v1(verbose)
+				deserialised_jass_v1(verbose),
+				compact_headers(false)
 				{
 				/* Nothing */
 				}
@@ -126,6 +157,9 @@ namespace JASS
 			*/
 			virtual size_t get_segment_list(segment_header *segments, metadata &metadata, size_t query_term_frequency, uint32_t &smallest, uint32_t &largest, query::DOCID_TYPE &document_frequency) const
 				{
+				if (compact_headers)
+					return get_compact_segment_list(segments, metadata, query_term_frequency, smallest, largest, document_frequency);
+
 				document_frequency = 0;
 				/*
 					Extract all the segments
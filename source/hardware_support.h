@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef HARDWARE_SUPPORT_STAND_ALONE
@@ -42,6 +43,20 @@
 	#include "../external/valgrind/valgrind.h"
 #endif
 
+/*
+	JASS_TARGET_AVX2 and JASS_TARGET_AVX512
+	---------------------------------------
+	Compile a single function for a given instruction set regardless of the compiler flags used for the rest of the program.  Such functions
+	must only be called if hardware_support::simd() says the CPU can execute them (normally through a function pointer chosen at startup).
+*/
+#if defined(__GNUC__) || defined(__clang__)
+	#define JASS_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+	#define JASS_TARGET_AVX512 __attribute__((target("avx512f,avx512cd,avx512bw,avx512dq,avx512vl,avx2,bmi,bmi2,popcnt")))
+#else
+	#define JASS_TARGET_AVX2
+	#define JASS_TARGET_AVX512
+#endif
+
 namespace JASS
 	{
 	/*
@@ -582,6 +597,105 @@ namespace JASS
 				}
 
 
+			/*
+				ENUM HARDWARE_SUPPORT::SIMD_LEVEL
+				---------------------------------
+			*/
+			/*!
+				@brief The instruction set levels that JASS has hand-vectorised code for (in increasing order).
+			*/
+			enum simd_level
+				{
+				scalar = 0,			///< No vector unit that JASS uses (use the plain C++ code).
+				avx2 = 1,			///< AVX2, BMI1, and BMI2 (Haswell and later, Zen and later).
+				avx512 = 2			///< AVX-512 F, CD, BW, DQ, and VL (Skylake-X, Ice Lake, Zen 4, and later).
+				};
+
+		protected:
+			/*
+				HARDWARE_SUPPORT::OS_SAVES_REGISTERS()
+				--------------------------------------
+			*/
+			/*!
+				@brief Check (using XGETBV) that the operating system saves the given register state on a context switch.
+				@param state_mask [in] The XCR0 bits that must all be set (0x06 for AVX, 0xE6 for AVX-512).
+				@return true if the OS saves the registers, else false.
+			*/
+			bool os_saves_registers(uint64_t state_mask) const
+				{
+				if (!OSXSAVE)
+					return false;
+			#ifdef _MSC_VER
+				uint64_t xcr0 = _xgetbv(0);
+			#else
+				uint32_t eax;
+				uint32_t edx;
+				__asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+				uint64_t xcr0 = (static_cast<uint64_t>(edx) << 32) | eax;
+			#endif
+				return (xcr0 & state_mask) == state_mask;
+				}
+
+		public:
+			/*
+				HARDWARE_SUPPORT::SIMD()
+				------------------------
+			*/
+			/*!
+				@brief Return the best simd_level this CPU (and operating system) can execute.
+				@return The best simd_level.
+			*/
+			simd_level simd(void) const
+				{
+				if (AVX512F && AVX512CD && AVX512BW && AVX512DQ && AVX512VL && AVX2 && BMI1 && BMI2 && os_saves_registers(0xE6))
+					return avx512;
+				if (AVX2 && BMI1 && BMI2 && os_saves_registers(0x06))
+					return avx2;
+				return scalar;
+				}
+
+			/*
+				HARDWARE_SUPPORT::DETECTED()
+				----------------------------
+			*/
+			/*!
+				@brief Return the details of the CPU this program is running on (CPUID is only executed the first time this is called).
+				@return A reference to a (static) hardware_support object.
+			*/
+			static const hardware_support &detected(void)
+				{
+				static const hardware_support cpu;
+				return cpu;
+				}
+
+			/*
+				HARDWARE_SUPPORT::BEST_SIMD()
+				-----------------------------
+			*/
+			/*!
+				@brief Return the simd_level code that chooses between implementations at runtime should use.
+				@details This is the best level the CPU supports, but it can be lowered (never raised) by setting the environment variable
+				JASS_SIMD to "scalar", "avx2", or "avx512".  That way the code paths used on older machines can be tested (and timed) on newer ones.
+				@return The simd_level to use.
+			*/
+			static simd_level best_simd(void)
+				{
+				static const simd_level level = []()
+					{
+					simd_level best = detected().simd();
+					const char *requested = getenv("JASS_SIMD");
+					if (requested == nullptr)
+						return best;
+					else if (::strcmp(requested, "scalar") == 0)
+						return scalar;
+					else if (::strcmp(requested, "avx2") == 0)
+						return best < avx2 ? best : avx2;
+					return best;
+					}();
+
+				return level;
+				}
+
 			/*
 				HARDWARE_SUPPORT::UNITTEST()
 				----------------------------
@@ -597,6 +711,15 @@ namespace JASS
 				data << hardware;
 								   
 				JASS_assert(hardware.x64 == true);
+
+				/*
+					The levels are ordered and the level in use can never be better than the hardware
+				*/
+				JASS_assert(scalar < avx2 && avx2 < avx512);
+				JASS_assert(best_simd() <= detected().simd());
+				JASS_assert(hardware.simd() == detected().simd());
+				if (hardware.simd() >= avx2)
+					JASS_assert(hardware.AVX2);
 				puts("hardware_support::PASSED");
 				}
 		};
@@ -696,6 +819,8 @@ namespace JASS
 
 		stream << "AVX5124VNNIW    :" << data.AVX5124VNNIW << "\n";
 		stream << "AVX5124FMAPS    :" << data.AVX5124FMAPS << "\n";
+
+		stream << "SIMD level      :" << (data.simd() == hardware_support::avx512 ? "AVX-512" : data.simd() == hardware_support::avx2 ? "AVX2" : "scalar") << "\n";
 		return stream;
 		}
 	}
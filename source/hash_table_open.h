@@ -0,0 +1,537 @@
+/*
+	HASH_TABLE_OPEN.H
+	-----------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Non-thread-safe, resizable, open-addressing hash table (without delete).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <string.h>
+
+#include <memory>
+#include <utility>
+#include <sstream>
+#include <iostream>
+
+#include <immintrin.h>
+
+#include "slice.h"
+#include "asserts.h"
+#include "allocator_pool.h"
+
+namespace JASS
+	{
+	/*
+		CLASS HASH_TABLE_OPEN
+		---------------------
+	*/
+	/*!
+		@brief Non-thread-safe, resizable, open-addressing hash table (without delete).
+		@details The table is an array of slots (pointers to key / element nodes) alongside a parallel array of one-byte control
+		values.  A control value is either empty or holds a 7-bit fingerprint of the hash of the key in that slot.  The slots are
+		grouped into groups of 16 and a lookup compares the fingerprint against all 16 control bytes of a group at once (using SSE2), so a key
+		comparison is only done when the fingerprints match.  Groups are probed using triangular steps, which visits every group when the number
+		of groups is a power of 2.  When the table reaches its load limit it doubles in size, so small collections start small and large collections
+		do not degrade into long chains (as the fixed-size hash_table does).
+		The nodes (keys and elements) are allocated from the pool allocator and never move, so references returned by operator[]() remain
+		valid across a resize.  The slot and control arrays are owned by this object and are freed when the table grows.  As with hash_table,
+		there is no way to remove an element once added, and the destructors of KEY and ELEMENT are never called.
+		@tparam KEY The type used as the key to the element (must include KEY(allocator, KEY) copy constructor, address(), and size()).
+		@tparam ELEMENT The element data returned given the key (must include ELEMENT(allocator) constructur).
+	*/
+	template <typename KEY, typename ELEMENT>
+	class hash_table_open
+		{
+		/*!
+			@brief Output a human readable serialisation to an ostream
+			@relates hash_table_open
+		*/
+		template<typename A, typename B> friend std::ostream &operator<<(std::ostream &stream, const hash_table_open<A, B> &map);
+
+		protected:
+			static constexpr size_t group_width = 16;						///< The number of slots examined at once (the width of an SSE2 register in bytes).
+			static constexpr uint8_t empty = 0x80;							///< Control byte for an unused slot (fingerprints are always less than this).
+			static constexpr size_t default_initial_size = 1024;		///< The default number of slots in a new table.
+
+		protected:
+			/*
+				CLASS HASH_TABLE_OPEN::NODE
+				---------------------------
+			*/
+			/*!
+				@brief A key and its element, stored together in memory from the pool allocator.
+			*/
+			class node
+				{
+				public:
+					const KEY key;						///< Data in the table are keyed on this.
+					ELEMENT element;					///< This is the data stored in the table.
+
+				public:
+					/*
+						HASH_TABLE_OPEN::NODE::NODE()
+						-----------------------------
+					*/
+					/*!
+						@brief Constructor
+						@param key [in] The key to the element data.
+						@param pool [in] The pool allocator use for keys and elements.
+					*/
+					node(const KEY &key, allocator &pool) :
+						key(pool, key),
+						element(pool)
+						{
+						/* Nothing */
+						}
+				};
+
+		protected:
+			/*
+				CLASS HASH_TABLE_OPEN::ITERATOR
+				-------------------------------
+			*/
+			/*!
+				@brief Iterate over the hash table (in slot order).
+			*/
+			class iterator
+				{
+				private:
+					const hash_table_open<KEY, ELEMENT> &iterand;		///< The hash table being iterated over.
+					size_t location;												///< Current slot in the hash table.
+
+				public:
+					/*
+						HASH_TABLE_OPEN::ITERATOR::ITERATOR()
+						-------------------------------------
+					*/
+					/*!
+						@brief Constructor.
+						@param over [in] The hash table to iterate over.
+						@param current [in] The slot to start at.
+					*/
+					iterator(const hash_table_open &over, size_t current) :
+						iterand(over),
+						location(current)
+						{
+						while (location < iterand.capacity && iterand.slot[location] == nullptr)
+							location++;
+						}
+
+					/*
+						HASH_TABLE_OPEN::ITERATOR::OPERATOR*()
+						--------------------------------------
+					*/
+					/*!
+						@brief Return a reference to the object at the current location.
+						@return The current object.
+					*/
+					const typename std::pair<const KEY &, const ELEMENT &> operator*() const
+						{
+						return std::pair<const KEY &, const ELEMENT &>(iterand.slot[location]->key, iterand.slot[location]->element);
+						}
+
+					/*
+						HASH_TABLE_OPEN::ITERATOR::OPERATOR!=()
+						---------------------------------------
+					*/
+					/*!
+						@brief Compare two iterator objects for non-equality.
+						@param other [in] The iterator object to compare to.
+						@return true if they differ, else false.
+					*/
+					bool operator!=(const iterator &other) const
+						{
+						return location != other.location;
+						}
+
+					/*
+						HASH_TABLE_OPEN::ITERATOR::OPERATOR++()
+						---------------------------------------
+					*/
+					/*!
+						@brief Increment this iterator.
+					*/
+					iterator &operator++()
+						{
+						do
+							location++;
+						while (location < iterand.capacity && iterand.slot[location] == nullptr);
+
+						return *this;
+						}
+				};
+
+		protected:
+			allocator &memory_pool;							///< The pool allocator used for the keys and elements.
+			size_t capacity;									///< The number of slots in the table (always a power of 2, and at least group_width).
+			size_t groups_mask;								///< (capacity / group_width) - 1, used to wrap probing around the table.
+			size_t used;										///< The number of slots currently in use.
+			size_t grow_at;									///< Double the size of the table when used reaches this value.
+			std::unique_ptr<uint8_t []> control;		///< One byte per slot, either empty or the fingerprint of the key in the slot.
+			std::unique_ptr<node *[]> slot;				///< Pointers to the key / element pairs.
+
+		protected:
+			/*
+				HASH_TABLE_OPEN::HASH()
+				-----------------------
+			*/
+			/*!
+				@brief Compute a 64-bit hash of the given key.
+				@details The key is consumed 8 bytes at a time, each word is mixed in with a multiply and rotate, and the result is
+				passed through the 64-bit finaliser from MurmurHash3 so that both the low 7 bits (the fingerprint) and the high bits (the group) are well mixed.
+				@param key [in] The key to hash.
+				@return The hash value.
+			*/
+			static inline uint64_t hash(const KEY &key)
+				{
+				const uint8_t *byte = reinterpret_cast<const uint8_t *>(key.address());
+				size_t length = key.size();
+				uint64_t result = 0x9E3779B97F4A7C15 ^ length;
+
+				while (length >= sizeof(uint64_t))
+					{
+					uint64_t word;
+					memcpy(&word, byte, sizeof(word));
+					result = ((result ^ (word * 0x87C37B91114253D5)) << 31 | (result ^ (word * 0x87C37B91114253D5)) >> 33) * 0x4CF5AD432745937F;
+					byte += sizeof(uint64_t);
+					length -= sizeof(uint64_t);
+					}
+
+				if (length != 0)
+					{
+					uint64_t word = 0;
+					memcpy(&word, byte, length);
+					result = ((result ^ (word * 0x87C37B91114253D5)) << 31 | (result ^ (word * 0x87C37B91114253D5)) >> 33) * 0x4CF5AD432745937F;
+					}
+
+				result ^= result >> 33;
+				result *= 0xFF51AFD7ED558CCD;
+				result ^= result >> 33;
+				result *= 0xC4CEB9FE1A85EC53;
+				result ^= result >> 33;
+
+				return result;
+				}
+
+			/*
+				HASH_TABLE_OPEN::MATCH()
+				------------------------
+			*/
+			/*!
+				@brief Return a bitmap of the slots in a group whose control byte equals the given value.
+				@param group [in] Pointer to the first control byte of the group.
+				@param value [in] The value to look for.
+				@return A 16-bit bitmap with bit n set if group[n] == value.
+			*/
+			static inline uint32_t match(const uint8_t *group, uint8_t value)
+				{
+				__m128i control_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control_bytes, _mm_set1_epi8(static_cast<char>(value)))));
+				}
+
+			/*
+				HASH_TABLE_OPEN::ALLOCATE()
+				---------------------------
+			*/
+			/*!
+				@brief Allocate (and clear) the slot and control arrays to hold the given number of slots.
+				@param slots [in] The number of slots (must be a power of 2 and at least group_width).
+			*/
+			void allocate(size_t slots)
+				{
+				capacity = slots;
+				groups_mask = capacity / group_width - 1;
+				grow_at = capacity - capacity / 8;				// 87.5% full
+				control = std::make_unique<uint8_t []>(capacity);
+				slot = std::make_unique<node *[]>(capacity);
+				memset(control.get(), empty, capacity);
+				std::fill(slot.get(), slot.get() + capacity, nullptr);
+				}
+
+			/*
+				HASH_TABLE_OPEN::PLACE()
+				------------------------
+			*/
+			/*!
+				@brief Put a node into the first empty slot on its probe sequence (the key must not already be in the table).
+				@param fingerprint [in] The 7-bit fingerprint of the key's hash.
+				@param group [in] The first group to probe.
+				@param data [in] The node to add.
+			*/
+			void place(uint8_t fingerprint, size_t group, node *data)
+				{
+				for (size_t step = 1; ; step++)
+					{
+					uint8_t *group_control = control.get() + group * group_width;
+					uint32_t empties = match(group_control, empty);
+					if (empties != 0)
+						{
+						size_t where = group * group_width + _tzcnt_u32(empties);
+						control[where] = fingerprint;
+						slot[where] = data;
+						used++;
+						return;
+						}
+					group = (group + step) & groups_mask;
+					}
+				}
+
+			/*
+				HASH_TABLE_OPEN::GROW()
+				-----------------------
+			*/
+			/*!
+				@brief Double the size of the table and re-insert all the nodes.
+			*/
+			void grow(void)
+				{
+				auto old_capacity = capacity;
+				auto old_slot = std::move(slot);
+
+				allocate(capacity * 2);
+				used = 0;
+				for (size_t current = 0; current < old_capacity; current++)
+					if (old_slot[current] != nullptr)
+						{
+						uint64_t hash_value = hash(old_slot[current]->key);
+						place(hash_value & 0x7F, (hash_value >> 7) & groups_mask, old_slot[current]);
+						}
+				}
+
+		public:
+			/*
+				HASH_TABLE_OPEN::HASH_TABLE_OPEN()
+				----------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param pool [in] All keys and elements associated with this object are allocated using the pool.
+				@param initial_size [in] The number of slots to start with (rounded up to a power of 2, and to at least 16).
+			*/
+			hash_table_open(allocator &pool, size_t initial_size = default_initial_size) :
+				memory_pool(pool),
+				used(0)
+				{
+				size_t slots = group_width;
+				while (slots < initial_size)
+					slots *= 2;
+				allocate(slots);
+				}
+
+			/*
+				HASH_TABLE_OPEN::~HASH_TABLE_OPEN()
+				-----------------------------------
+			*/
+			/*!
+				@brief Destructor
+			*/
+			~hash_table_open()
+				{
+				/* Nothing */
+				}
+
+			/*
+				HASH_TABLE_OPEN::BEGIN()
+				------------------------
+			*/
+			/*!
+				@brief Return an iterator pointing to the first element in the hash table.
+				@return Iterator pointing to the first element in the hash table.
+			*/
+			iterator begin() const
+				{
+				return iterator(*this, 0);
+				}
+
+			/*
+				HASH_TABLE_OPEN::END()
+				----------------------
+			*/
+			/*!
+				@brief Return an iterator pointing past the end of the hash table.
+				@return Iterator pointing past the end of the hash table.
+			*/
+			iterator end() const
+				{
+				return iterator(*this, capacity);
+				}
+
+			/*
+				HASH_TABLE_OPEN::SIZE()
+				-----------------------
+			*/
+			/*!
+				@brief Return the number of elements in the hash table.
+				@return The number of elements in the hash table.
+			*/
+			size_t size(void) const
+				{
+				return used;
+				}
+
+			/*
+				HASH_TABLE_OPEN::TEXT_RENDER()
+				------------------------------
+			*/
+			/*!
+				@brief Write the contents of this object to the output steam.
+				@param stream [in] The stream to write to.
+			*/
+			void text_render(std::ostream &stream) const
+				{
+				for (size_t element = 0; element < capacity; element++)
+					if (slot[element] != nullptr)
+						stream << slot[element]->key << "->" << slot[element]->element << '\n';
+				}
+
+			/*
+				HASH_TABLE_OPEN::OPERATOR[]()
+				-----------------------------
+			*/
+			/*!
+				@brief Return a reference to the element associated with the key.  If there is no element the create an empty one.
+				@param key [in] The key to look up.
+				@return The element associated with the key.
+			*/
+			ELEMENT &operator[](const KEY &key)
+				{
+				uint64_t hash_value = hash(key);
+				uint8_t fingerprint = hash_value & 0x7F;
+				size_t group = (hash_value >> 7) & groups_mask;
+
+				for (size_t step = 1; ; step++)
+					{
+					uint8_t *group_control = control.get() + group * group_width;
+
+					/*
+						Check each slot in the group whose fingerprint matches
+					*/
+					for (uint32_t candidates = match(group_control, fingerprint); candidates != 0; candidates &= candidates - 1)
+						{
+						node *current = slot[group * group_width + _tzcnt_u32(candidates)];
+						if (current->key.size() == key.size() && memcmp(current->key.address(), key.address(), key.size()) == 0)
+							return current->element;
+						}
+
+					/*
+						If there is an empty slot in this group then the key is not in the table, so add it.
+					*/
+					if (match(group_control, empty) != 0)
+						{
+						node *new_node = new (memory_pool.malloc(sizeof(node), sizeof(void *))) node(key, memory_pool);
+						if (used >= grow_at)
+							{
+							grow();
+							place(fingerprint, (hash_value >> 7) & groups_mask, new_node);
+							}
+						else
+							place(fingerprint, group, new_node);
+						return new_node->element;
+						}
+
+					group = (group + step) & groups_mask;
+					}
+				}
+
+			/*
+				HASH_TABLE_OPEN::UNITTEST()
+				---------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				/*
+					Check inserting and finding (start small so that the table has to grow several times)
+				*/
+				allocator_pool pool;
+				hash_table_open<slice, slice> map(pool, 1);
+
+				map[slice("5")] = slice("five");
+				map[slice("3")] = slice("three");
+				map[slice("7")] = slice("seven");
+				map[slice("4")] = slice("four");
+				map[slice("2")] = slice("two");
+				map[slice("1")] = slice("one");
+				map[slice("9")] = slice("nine");
+				map[slice("6")] = slice("six");
+				map[slice("8")] = slice("eight");
+				map[slice("0")];
+
+				JASS_assert(map.size() == 10);
+				JASS_assert(map[slice("7")] == slice("seven"));
+				JASS_assert(map[slice("0")].size() == 0);
+
+				std::ostringstream key_name;
+				for (size_t key = 0; key < 10000; key++)
+					{
+					key_name.str("");
+					key_name << "key" << key;
+					map[slice(pool, key_name.str().c_str())] = slice(pool, key_name.str().c_str());
+					}
+
+				JASS_assert(map.size() == 10010);
+				JASS_assert(map.capacity >= 10010);
+				for (size_t key = 0; key < 10000; key++)
+					{
+					key_name.str("");
+					key_name << "key" << key;
+					JASS_assert(map[slice(key_name.str().c_str())] == slice(key_name.str().c_str()));
+					}
+				JASS_assert(map.size() == 10010);
+				JASS_assert(map[slice("3")] == slice("three"));
+
+				/*
+					Check the iterator visits each element exactly once
+				*/
+				size_t count = 0;
+				size_t digits = 0;
+				for (const auto element : map)
+					{
+					count++;
+					if (element.first.size() == 1)
+						digits++;
+					}
+				JASS_assert(count == 10010);
+				JASS_assert(digits == 10);
+
+				/*
+					Check the serialiser
+				*/
+				allocator_pool small_pool;
+				hash_table_open<slice, slice> small_map(small_pool);
+				small_map[slice("1")] = slice("one");
+				std::ostringstream serialised;
+				serialised << small_map;
+				JASS_assert(serialised.str() == "1->one\n");
+
+				puts("hash_table_open::PASSED");
+				}
+		};
+
+	/*
+		OPERATOR<<()
+		------------
+	*/
+	/*!
+		@brief Dump the contents of a hash table down an output stream.
+		@param stream [in] The stream to write to.
+		@param map [in] The hash table to write.
+		@tparam KEY The type used as the key to the elements.
+		@tparam ELEMENT The element data returned given the key.
+		@return The stream once the tree has been written.
+	*/
+	template <typename KEY, typename ELEMENT>
+	inline std::ostream &operator<<(std::ostream &stream, const hash_table_open<KEY, ELEMENT> &map)
+		{
+		map.text_render(stream);
+		return stream;
+		}
+	}
@@ -1,3 +1,9 @@
+/*
+	HASH_TABLE_OPEN uses the resizable open-addressing hash table (hash_table_open) for the vocabulary, the alternative is
+	the fixed-size (2^24 slot) hash_table of binary trees.  The iteration order (and so the order terms are serialised in) differs between the two.
+	HASH_TABLE_OPEN is set with cmake -DJASS_HASH_TABLE_OPEN=ON.
+*/
+
 /*
 	INDEX_MANAGER_SEQUENTIAL.H
 	--------------------------
@@ -18,6 +24,7 @@
 #include "parser.h"
 #include "posting.h"
 #include "hash_table.h"
+#include "hash_table_open.h"
 #include "index_manager.h"
 #include "unittest_data.h"
 #include "index_postings.h"
@@ -39,7 +46,11 @@ namespace JASS
 		{
 		private:
 			allocator_pool memory;														///< All memory in allocatged from this allocator.
+#ifdef HASH_TABLE_OPEN
+			hash_table_open<slice, index_postings> index;						///< The index is a hash table of index_postings keyed on the term (a slice).
+#else
 			hash_table<slice, index_postings, 24> index;							///< The index is a hash table of index_postings keyed on the term (a slice).
+#endif
 			dynamic_array<slice> primary_key;										///< The list of primary keys (i.e. external document identifiers) allocated in memory.
 			
 			/*
@@ -47,8 +58,7 @@ namespace JASS
 			*/
 			compress_integer::integer *document_ids;					///< The re-used buffer storing decoded document ids
 			index_postings_impact::impact_type *term_frequencies;	///< The re-used buffer storing the term frequencies
-			size_t temporary_size;											///< The number of bytes in temporary
-			uint8_t *temporary;												///< Temporary buffer - cannot be used to store anything between calls
+			size_t buffer_size;												///< The number of postings document_ids and term_frequencies can hold
 
 		public:
 			/*
@@ -148,11 +158,11 @@ namespace JASS
 			*/
 			void make_space(void)
 				{
-				auto new_temporary_size = get_highest_document_id() * (sizeof(*document_ids) / 7 + 1) * sizeof(*temporary);
+				size_t new_buffer_size = get_highest_document_id();
 
-				if (new_temporary_size > temporary_size)
+				if (new_buffer_size > buffer_size)
 					{
-					temporary_size = new_temporary_size;
+					buffer_size = new_buffer_size;
 					/*
 						we don't delete the old buffers because the memory object doesn't support allow us to do so
 						but, this would only be needed if the called serialises then adds then serialises without
@@ -160,7 +170,6 @@ namespace JASS
 					*/
 					document_ids = reinterpret_cast<decltype(document_ids)>(memory.malloc(get_highest_document_id() * sizeof(*document_ids)));
 					term_frequencies = reinterpret_cast<decltype(term_frequencies)>(memory.malloc(get_highest_document_id() * sizeof(*term_frequencies)));
-					temporary = reinterpret_cast<decltype(temporary)>(memory.malloc(temporary_size));
 					}
 				}
 
@@ -178,8 +187,7 @@ namespace JASS
 				primary_key(memory, 1000, 1.5),
 				document_ids(nullptr),
 				term_frequencies(nullptr),
-				temporary_size(0),
-				temporary(nullptr)
+				buffer_size(0)
 				{
 				/* Nothing */
 				}
@@ -306,7 +314,7 @@ namespace JASS
 				*/
 				for (const auto &[key, value] : index)
 					{
-					auto document_frequency = value.linearize(temporary, temporary_size, document_ids, term_frequencies, get_highest_document_id());
+					auto document_frequency = value.linearize(document_ids, term_frequencies, get_highest_document_id());
 					callback(key, value, document_frequency, document_ids, term_frequencies);
 					}
 
@@ -341,7 +349,7 @@ namespace JASS
 				*/
 				for (const auto &[term, postings] : index)
 					{
-					auto document_frequency = postings.linearize(temporary, temporary_size, document_ids, term_frequencies, get_highest_document_id());
+					auto document_frequency = postings.linearize(document_ids, term_frequencies, get_highest_document_id());
 					quantizer(callback, term, postings, document_frequency, document_ids, term_frequencies);
 					}
 					
@@ -441,8 +449,33 @@ namespace JASS
 			static void unittest(void)
 				{
 				/*
-					This is the postings answer that is expected
+					This is the postings answer that is expected (the order is the iteration order of the vocabulary's hash table)
 				*/
+#ifdef HASH_TABLE_OPEN
+				std::string answer
+					(
+					"ten-><1,1><2,1><3,1><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
+					"nine-><2,1><3,1><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
+					"8-><8,1>\n"
+					"9-><9,1>\n"
+					"seven-><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
+					"3-><3,1>\n"
+					"three-><8,1><9,1><10,1>\n"
+					"one-><10,1>\n"
+					"2-><2,1>\n"
+					"six-><5,1><6,1><7,1><8,1><9,1><10,1>\n"
+					"eight-><3,1><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
+					"five-><6,1><7,1><8,1><9,1><10,1>\n"
+					"two-><9,1><10,1>\n"
+					"1-><1,1>\n"
+					"7-><7,1>\n"
+					"four-><7,1><8,1><9,1><10,1>\n"
+					"5-><5,1>\n"
+					"10-><10,1>\n"
+					"6-><6,1>\n"
+					"4-><4,1>\n"
+					);
+#else
 				std::string answer
 					(
 					"6-><6,1>\n"
@@ -466,6 +499,7 @@ namespace JASS
 					"nine-><2,1><3,1><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
 					"ten-><1,1><2,1><3,1><4,1><5,1><6,1><7,1><8,1><9,1><10,1>\n"
 					);
+#endif
 				/*
 					This is the docid to primary_key answer
 				*/
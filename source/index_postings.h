@@ -22,7 +22,6 @@
 
 #include "maths.h"
 #include "posting.h"
-#include "dynamic_array.h"
 #include "compress_integer.h"
 #include "allocator_pool.h"
 #include "index_postings_impact.h"
@@ -40,45 +39,100 @@ namespace JASS
 	class index_postings
 		{
 		private:
-			static constexpr size_t initial_size = 16;		///< Initially allocate space for 4 elements
-			static constexpr double growth_factor = 1.5;		///< Grow dynamic arrays by a factor of 1.5
+			static constexpr size_t initial_size = 16;		///< The first chunk holds 16 bytes of postings (enough for several rare-term postings)
+			static constexpr size_t growth_factor = 2;		///< Each chunk is twice the size of the previous one
+			static constexpr size_t worst_case_posting = 7;	///< A d-gap (5 bytes) and a term frequency (2 bytes) can take at most this many bytes once variable-byte encoded
 
 		protected:
 			/*
-				INDEX_POSTINGS::POSTING
-				-----------------------
+				CLASS INDEX_POSTINGS::CHUNK
+				---------------------------
 			*/
 			/*!
-				@brief The representation of a single postings as a tuple of docid, term frequency and position.
+				@brief A block of variable-byte encoded postings.  The encoded bytes immediately follow the header in memory.
 			*/
-			class posting
+			class chunk
 				{
 				public:
-					compress_integer::integer document_id;						///< Internal document identifier
-					index_postings_impact::impact_type term_frequency;		///< Number of times the term occurs in this document
+					chunk *next;						///< The next chunk in the list (or nullptr if this is the tail).
+					uint32_t used;						///< The number of bytes of data[] that have been used.
+					uint32_t allocated;				///< The size of data[] measured in bytes.
 
 				public:
 					/*
-						INDEX_POSTINGS::POSTING::POSTING()
-						----------------------------------
+						INDEX_POSTINGS::CHUNK::DATA()
+						-----------------------------
+					*/
+					/*!
+						@brief Return a pointer to the encoded bytes that follow this header.
+						@return The encoded bytes in this chunk.
+					*/
+					uint8_t *data(void)
+						{
+						return reinterpret_cast<uint8_t *>(this + 1);
+						}
+
+					/*
+						INDEX_POSTINGS::CHUNK::DATA()
+						-----------------------------
 					*/
 					/*!
-						@brief Constructor.
-						@param document_id [in] the document ID to use
-						@param term_frequency [in] the term frequency to use
+						@brief Return a pointer to the encoded bytes that follow this header.
+						@return The encoded bytes in this chunk.
 					*/
-					posting(uint32_t document_id, uint32_t term_frequency) :
-						document_id(document_id),
-						term_frequency(term_frequency)
+					const uint8_t *data(void) const
 						{
-						/* Nothing */
+						return reinterpret_cast<const uint8_t *>(this + 1);
 						}
 				};
 
 		private:
+			allocator &pool;																		///< All chunks are allocated from this allocator.
+			chunk *head;																			///< The first chunk of the postings byte stream (or nullptr if empty).
+			chunk *tail;																			///< The chunk currently being written into.
 			compress_integer::integer highest_document;									///< The higest document number seen in this postings list (counting from 1)
-			dynamic_array<uint8_t> document_ids;											///< Array holding the docids (variable byte encoded)
-			dynamic_array<index_postings_impact::impact_type> term_frequencies;	///< Array holding the term frequencies (as integers)
+			compress_integer::integer document_frequency;								///< The number of documents in this postings list
+			index_postings_impact::impact_type pending_frequency;						///< The term frequency of highest_document (not yet in the byte stream as it might still change)
+
+		protected:
+			/*
+				INDEX_POSTINGS::APPEND()
+				------------------------
+			*/
+			/*!
+				@brief Add a new document to the end of the byte stream, flushing the term frequency of the previous document.
+				@details The stream is a sequence of <d-gap, tf> pairs, each variable-byte encoded.  The term frequency of the most
+				recent document is held back in pending_frequency because it is incremented as subsequent occurrences are seen.  Space for a whole
+				posting is reserved before writing so that no integer is split over two chunks.
+				@param gap [in] The d-gap from the previous document to this one.
+				@param frequency [in] The term frequency of this document.
+			*/
+			void append(compress_integer::integer gap, index_postings_impact::impact_type frequency)
+				{
+				if (tail == nullptr || tail->allocated - tail->used < worst_case_posting)
+					{
+					size_t bytes = tail == nullptr ? initial_size : tail->allocated * growth_factor;
+					chunk *another = new (pool.malloc(sizeof(chunk) + bytes, alignof(chunk))) chunk;
+					another->next = nullptr;
+					another->used = 0;
+					another->allocated = static_cast<uint32_t>(bytes);
+
+					if (tail == nullptr)
+						head = another;
+					else
+						tail->next = another;
+					tail = another;
+					}
+
+				uint8_t *ending = tail->data() + tail->used;
+				if (document_frequency != 0)
+					compress_integer_variable_byte::compress_into(ending, static_cast<uint32_t>(pending_frequency));
+				compress_integer_variable_byte::compress_into(ending, gap);
+				tail->used = static_cast<uint32_t>(ending - tail->data());
+
+				pending_frequency = frequency;
+				document_frequency++;
+				}
 
 		public:
 			index_postings() = delete;
@@ -92,9 +146,12 @@ namespace JASS
 				@param memory_pool [in] All allocation is from this allocator.
 			*/
 			index_postings(allocator &memory_pool) :
+				pool(memory_pool),
+				head(nullptr),
+				tail(nullptr),
 				highest_document(0),															// starts at 0, counts from 1
-				document_ids(memory_pool, initial_size, growth_factor),					// give the allocator to the array
-				term_frequencies(memory_pool, initial_size, growth_factor)					// give the allocator to the array
+				document_frequency(0),
+				pending_frequency(0)
 				{
 				/* Nothing */
 				}
@@ -116,33 +173,19 @@ namespace JASS
 				if (document_id == highest_document)
 					{
 					/*
-						If this is the second or subseqent occurrence then just add 1 to the term frequency (and make sure it doesn't overflow).
+						If this is the second or subseqent occurrence then just add to the term frequency (and make sure it doesn't overflow).
 					*/
-					index_postings_impact::impact_type &frequency = term_frequencies.back();
-
-
-					if (index_postings_impact::largest_impact - frequency > amount)			// that is, without overflow: if (frequency + amount < index_postings_impact::largest_impact)
-						frequency += amount;			// cppcheck produces a false positive "Variable 'frequency' is modified but its new value is never used." - it looks like it doesn't fully understand that frequency is a reference.
+					if (index_postings_impact::largest_impact - pending_frequency > amount)			// that is, without overflow: if (frequency + amount < index_postings_impact::largest_impact)
+						pending_frequency += amount;
 					else
-						frequency = index_postings_impact::largest_impact;
+						pending_frequency = index_postings_impact::largest_impact;
 					}
 				else
 					{
 					/*
-						First time we've seen this term in this document so add a new document ID and set the term frequency to 1.
+						First time we've seen this term in this document so add a new document ID with the given term frequency.
 					*/
-					uint8_t space[10];				// worst case for a 64-bit integer (70 bits / 7 bits per byte = 10 bytes)
-					uint8_t *ending = space;		// write into here;
-
-					/*
-						Compress into the temporary buffer then copy into the postings
-					*/
-					compress_integer_variable_byte::compress_into(ending, document_id - highest_document);
-
-					for (uint8_t *byte = space; byte < ending; byte++)
-						document_ids.push_back(*byte);
-					term_frequencies.push_back(amount);
-
+					append(document_id - highest_document, amount);
 					highest_document = document_id;
 					}
 				}
@@ -167,79 +210,82 @@ namespace JASS
 				*/
 				JASS_assert(highest_document == 0);
 
-				size_t postings_list_length = data.size();
-				for (size_t current = 0; current < postings_list_length; current++)
+				for (const auto &current : data)
 					{
-					uint8_t space[10];					// worst case for a 64-bit integer (70 bits / 7 bits per byte = 10 bytes)
-					uint8_t *ending = space;			// write into here;
-					
-					/*
-						Compress into the temporary buffer then copy into the postings
-					*/
-					highest_document += data[current].docid;
-					compress_integer_variable_byte::compress_into(ending, data[current].docid);
-					for (uint8_t *byte = space; byte < ending; byte++)
-						document_ids.push_back(*byte);
+					decltype(index_postings_impact::largest_impact) frequency = current.term_frequency;
 
-					/*
-						Set the term frequency
-					*/
-					decltype(index_postings_impact::largest_impact) frequency = data[current].term_frequency;
-					term_frequencies.push_back(JASS::maths::minimum(frequency, index_postings_impact::largest_impact));
+					highest_document += current.docid;
+					append(current.docid, static_cast<index_postings_impact::impact_type>(JASS::maths::minimum(frequency, index_postings_impact::largest_impact)));
 					}
 				}
 
+			/*
+				INDEX_POSTINGS::SIZE()
+				----------------------
+			*/
+			/*!
+				@brief Return the document frequency of this term (the number of postings in the list).
+				@return The number of postings in the list.
+			*/
+			compress_integer::integer size(void) const
+				{
+				return document_frequency;
+				}
+
 			/*
 				INDEX_POSTINGS::LINEARIZE()
 				---------------------------
 			*/
 			/*!
 				@brief Turn the internal format used to accumulate postings into a docid and term-frequencies array.
-				@param temporary [in] Buffer used as scratch space.
-				@param temporary_size [in] Length, in bytes, of temporary.
+				@details The chunks are walked once, sequentially, decoding and prefix-summing the d-gaps as they are read.
 				@param ids [out] Buffer to store the document ids.
 				@param frequencies [out] Buffer to store the term frequencies.
 				@param id_and_frequencies_length [in] The length of the id and frequencies buffers.
 
 				@return Returns the document frequency of this term, or 0 on failure.
 			*/
-			compress_integer::integer linearize(uint8_t *temporary, size_t temporary_size, compress_integer::integer *ids, index_postings_impact::impact_type *frequencies, size_t id_and_frequencies_length) const
+			compress_integer::integer linearize(compress_integer::integer *ids, index_postings_impact::impact_type *frequencies, size_t id_and_frequencies_length) const
 				{
-				/*
-					Linearize the term frequencies
-				*/
-				size_t document_frequency = term_frequencies.serialise(frequencies, id_and_frequencies_length);
-
-				if (document_frequency > id_and_frequencies_length)
+				if (document_frequency > id_and_frequencies_length || document_frequency == 0)
 					return 0;
 
-				/*
-					Linearize the document ids, which will still be variable byte encoded
-				*/
-				auto needs = document_ids.serialise(temporary, temporary_size);
-				if (needs > temporary_size)
-					return 0;
+				compress_integer::integer *current_id = ids;
+				index_postings_impact::impact_type *current_frequency = frequencies;
+				compress_integer::integer sum = 0;
+				bool want_gap = true;
 
-				/*
-					Decompress the document ids
-				*/
-				compress_integer_variable_byte::static_decode(ids, document_frequency, temporary, needs);
+				for (const chunk *current = head; current != nullptr; current = current->next)
+					{
+					const uint8_t *from = current->data();
+					const uint8_t *end = from + current->used;
+
+					while (from < end)
+						if (want_gap)
+							{
+							compress_integer::integer gap;
+							compress_integer_variable_byte::decompress_into(&gap, from);
+							sum += gap;
+							*current_id++ = sum;
+							want_gap = false;
+							}
+						else
+							{
+							compress_integer_variable_byte::decompress_into(current_frequency, from);
+							current_frequency++;
+							want_gap = true;
+							}
+					}
 
 				/*
-					Decode the deltas
+					The term frequency of the last document is not in the byte stream
 				*/
-				compress_integer::integer sum = 0;
-				auto end = ids + document_frequency;
-				for (auto current = ids; current < end; current++)
-					{
-					sum += *current;
-					*current = sum;
-					}
+				*current_frequency = pending_frequency;
 
 				/*
 					And return the document frequency
 				*/
-				return static_cast<compress_integer::integer>(document_frequency);
+				return document_frequency;
 				}
 
 			/*
@@ -253,7 +299,7 @@ namespace JASS
 			*/
 			void impact_order(size_t documents_in_collection, index_postings_impact &postings_list) const
 				{
-				auto document_frequency = linearize(postings_list.temporary, postings_list.temporary_size, postings_list.document_ids, postings_list.term_frequencies, postings_list.number_of_postings);
+				auto document_frequency = linearize(postings_list.document_ids, postings_list.term_frequencies, postings_list.number_of_postings);
 				impact_order(documents_in_collection, postings_list, document_frequency, postings_list.document_ids, postings_list.term_frequencies);
 				}
 
@@ -378,17 +424,13 @@ std::ostream &operator<<(std::ostream &stream, const index_postings &data);
 			*/
 			void text_render(std::ostream &stream) const
 				{
-				size_t document_frequency = term_frequencies.serialise(nullptr, 0);
-
 				/*
 					Serialise the postings
 				*/
 				auto id_list = std::make_unique<compress_integer::integer []>(document_frequency);
 				auto tf_list = std::make_unique<index_postings_impact::impact_type []>(document_frequency);
-				size_t temporary_size = document_frequency * 10;		 // worst case is that each integer is encoded in 10 bytes and so the linear buffer is 10 times the number of document frequencies
-				auto temporary = std::make_unique<uint8_t []>(temporary_size);
 
-				linearize(temporary.get(), temporary_size, id_list.get(), tf_list.get(), document_frequency);
+				linearize(id_list.get(), tf_list.get(), document_frequency);
 
 				/*
 					write out the postings
@@ -421,6 +463,44 @@ std::ostream &operator<<(std::ostream &stream, const index_postings &data);
 				postings.text_render(result);
 
 				JASS_assert(strcmp(result.str().c_str(), "<1,2><2,1><173252,1>") == 0);
+				JASS_assert(postings.size() == 3);
+
+				/*
+					Check a list long enough to span many chunks, with term frequencies that need 2 bytes and that saturate.
+				*/
+				index_postings long_list(pool);
+				for (compress_integer::integer document = 1; document <= 10000; document++)
+					long_list.push_back(document * 3, static_cast<index_postings_impact::impact_type>(document % 300 + 1));
+				long_list.push_back(30000, index_postings_impact::largest_impact);
+
+				std::vector<compress_integer::integer> ids(10000);
+				std::vector<index_postings_impact::impact_type> frequencies(10000);
+				JASS_assert(long_list.linearize(&ids[0], &frequencies[0], 9999) == 0);
+				JASS_assert(long_list.linearize(&ids[0], &frequencies[0], 10000) == 10000);
+				for (compress_integer::integer document = 1; document < 10000; document++)
+					{
+					JASS_assert(ids[document - 1] == document * 3);
+					JASS_assert(frequencies[document - 1] == document % 300 + 1);
+					}
+				JASS_assert(ids[9999] == 30000);
+				JASS_assert(frequencies[9999] == index_postings_impact::largest_impact);
+
+				/*
+					Check adding a pre-computed (D1-encoded) postings list
+				*/
+				std::vector<JASS::posting> d1_list(3);
+				d1_list[0].docid = 3;
+				d1_list[0].term_frequency = 2;
+				d1_list[1].docid = 4;
+				d1_list[1].term_frequency = 1;
+				d1_list[2].docid = 1;
+				d1_list[2].term_frequency = 5000;
+
+				index_postings precomputed(pool);
+				precomputed.push_back(d1_list);
+				result.str("");
+				precomputed.text_render(result);
+				JASS_assert(result.str() == "<3,2><7,1><8,1024>");
 
 				puts("index_postings::PASSED");
 				}
@@ -7,6 +7,8 @@
 #include <string.h>
 
 #include "assert.h"
+#include "unittest_data.h"
+#include "instream_memory.h"
 #include "instream_deflate.h"
 #include "compress_general_zlib.h"
 
@@ -27,6 +29,8 @@ namespace JASS
 
 		bytes_read = 0;
 		buffer = NULL;
+		source_eof = false;
+		at_eof = false;
 		}
 
 	/*
@@ -38,11 +42,20 @@ namespace JASS
 	size_t got;
 	int state;
 
+	if (at_eof)
+		{
+		document.contents = slice();
+		return;
+		}
+
 	if (buffer == NULL)
 		{
 		buffer = new uint8_t [buffer_length];
 		if (inflateInit2(&stream, 15 + 32) != Z_OK)		// 2^15 window with zlib/gzip header detection
 			{
+			delete [] buffer;
+			buffer = NULL;
+			at_eof = true;
 			document.contents = slice();
 			return;										// error, deflateInit2() failed!
 			}
@@ -53,13 +66,11 @@ namespace JASS
 
 	do
 		{
-		if (stream.avail_in <= 0)
+		if (stream.avail_in <= 0 && !source_eof)
 			{
-			if ((got = source->fetch(buffer, buffer_length)) < 0)
-				{
-				document.contents = slice();
-				return;										// error, deflateInit2() failed!
-				}
+			got = source->fetch(buffer, buffer_length);
+			if (got == 0)
+				source_eof = true;
 			stream.avail_in = (uInt)got;
 			stream.next_in = buffer;
 			}
@@ -68,9 +79,37 @@ namespace JASS
 
 		if (state == Z_STREAM_END)
 			{
+			/*
+				The end of a gzip member, but there might be another member immediately after it (a multi-member gzip file).
+			*/
+			if (stream.avail_in <= 0 && !source_eof)
+				{
+				got = source->fetch(buffer, buffer_length);
+				if (got == 0)
+					source_eof = true;
+				stream.avail_in = (uInt)got;
+				stream.next_in = buffer;
+				}
+
+			if (stream.avail_in > 0)
+				{
+				inflateReset(&stream);
+				if (stream.avail_out == 0)
+					{
+					bytes_read += document.contents.size();
+					return;			// filled the output buffer and so return bytes read
+					}
+				state = Z_OK;
+				continue;
+				}
+
 			got = document.contents.size() - stream.avail_out;		// number of bytes that were decompressed
-			document.contents.resize(got);
+			if (got == 0)
+				document.contents = slice();
+			else
+				document.contents.resize(got);
 			bytes_read += got;
+			at_eof = true;
 			return;										// at EOF
 			}
 
@@ -87,15 +126,62 @@ namespace JASS
 	}
 
 	/*
-		INSTREAM_FILE::UNITTEST()
-		-------------------------
+		INSTREAM_DEFLATE::UNITTEST()
+		----------------------------
 	*/
 	void instream_deflate::unittest(void)
 		{
+		/*
+			gzip the two halves of the test data seperately and concatenate them to make a multi-member gzip file
+		*/
+		auto gzip = [](const std::string &from)
+			{
+			z_stream deflater = {};
+			std::string into(from.size() + 1024, '\0');
+
+			deflateInit2(&deflater, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);		// +16 for a gzip header
+			deflater.next_in = (Bytef *)from.data();
+			deflater.avail_in = (uInt)from.size();
+			deflater.next_out = (Bytef *)&into[0];
+			deflater.avail_out = (uInt)into.size();
+			deflate(&deflater, Z_FINISH);
+			into.resize(deflater.total_out);
+			deflateEnd(&deflater);
+
+			return into;
+			};
+
+		const std::string &answer = unittest_data::ten_documents;
+		std::string compressed = gzip(answer.substr(0, answer.size() / 2)) + gzip(answer.substr(answer.size() / 2));
+
+		/*
+			Decompress it using reads that straddle the member boundary
+		*/
+		std::shared_ptr<instream> memory(new instream_memory(compressed.data(), compressed.size()));
+		instream_deflate reader(memory);
+		document into;
+		std::string result;
+
+		do
+			{
+			into.contents = slice(into.contents_allocator, 100);
+			reader.read(into);
+			result.append(reinterpret_cast<char *>(into.contents.address()), into.contents.size());
+			}
+		while (into.contents.size() == 100);
+
+		JASS_assert(result == answer);
+
+		/*
+			Reading again at eof gets nothing
+		*/
+		into.contents = slice(into.contents_allocator, 100);
+		reader.read(into);
+		JASS_assert(into.contents.size() == 0);
+
 		/*
 			Yay, we passed!
 		*/
 		puts("instream_deflate::PASSED");
 		}
 	}
-
@@ -23,6 +23,7 @@ namespace JASS
 	*/
 	/*!
 		@brief Subclass of instream for reading from .gz files (files compressed with deflate).
+		@details Multi-member gzip files (several gzip streams concatenated, as produced by pigz and by "cat a.gz b.gz") are decoded as one stream.
 	*/
 	class instream_deflate : public instream
 		{
@@ -30,6 +31,8 @@ namespace JASS
 			z_stream stream;														///< The Zlib stream processing data structure
 			uint64_t bytes_read;													///< How many bytes of data have been decoded from the stream
 			uint8_t *buffer;														///< Internal deflation buffer
+			bool source_eof;														///< The source has been read to the end.
+			bool at_eof;															///< The last member of the compressed stream has been decoded.
 			static const size_t buffer_length = (10 * 1024 * 1024);	///< size of the internal buffer
 
 		public:
@@ -39,7 +42,7 @@ namespace JASS
 			*/
 			/*!
 				@brief Constructor
-				@param filename [in] The name of the file to use as the input stream
+				@param source [in] The instream to read the compressed data from
 			*/
 			instream_deflate(std::shared_ptr<instream> &source);
 
@@ -52,7 +55,11 @@ namespace JASS
 			*/
 			virtual ~instream_deflate()
 				{
-				/* Nothing */
+				if (buffer != NULL)
+					{
+					inflateEnd(&stream);
+					delete [] buffer;
+					}
 				}
 
 			/*
@@ -6,9 +6,15 @@
 */
 #include <string.h>
 
-#include "assert.h"
+#include <algorithm>
+
+#include "file.h"
+#include "asserts.h"
+#include "instream_zstd.h"
 #include "instream_file.h"
+#include "unittest_data.h"
 #include "instream_deflate.h"
+#include "compress_general_zstd.h"
 #include "instream_directory_iterator.h"
 
 namespace JASS
@@ -17,67 +23,174 @@ namespace JASS
 		INSTREAM_DIRECTORY_ITERATOR::INSTREAM_DIRECTORY_ITERATOR()
 		----------------------------------------------------------
 	*/
-	instream_directory_iterator::instream_directory_iterator(const std::string &directory_name) :
-		source(directory_name),
-		reader(nullptr)
-		{
-		current = begin(source);
-		last = end(source);
-		}
-
-	/*
-		INSTREAM_DIRECTORY_ITERATOR::READ()
-		-----------------------------------
-	*/
-	void instream_directory_iterator::read(document &document)
+	instream_directory_iterator::instream_directory_iterator(const std::string &directory_name, size_t threads) :
+		next_to_start(0),
+		next_to_read(0),
+		window(threads == 0 ? 1 : threads),
+		stop(false),
+		current_position(0)
 		{
 		/*
-			Is this the first time this method is called?
+			Get the list of files and sort it so that the order in which we return the data does not depend on the file system
 		*/
-		if (reader == nullptr)
-			if (current != last)
-				{
-//puts(current->path().string().c_str());
-				reader = std::shared_ptr<instream>(new instream_file(current->path().string()));
-				if (current->path().string().rfind(".gz") != std::string::npos)
-					reader = std::shared_ptr<JASS::instream>(new instream_deflate(reader));
-				current++;
-				}
+		for (const auto &entry : std::filesystem::directory_iterator(directory_name))
+			if (entry.is_regular_file())
+				filenames.push_back(entry.path().string());
+		std::sort(filenames.begin(), filenames.end());
+		files.resize(filenames.size());
 
 		/*
-			Now we can get data from the reader and return it, after making sure we're not at EOF.
+			Start the decompression threads
 		*/
-		size_t amount_to_read = document.contents.size();
-		void *read_into = document.contents.address();
+		for (size_t thread = 0; thread < (std::min)(window, filenames.size()); thread++)
+			workers.emplace_back(&instream_directory_iterator::work, this);
+		}
 
+	/*
+		INSTREAM_DIRECTORY_ITERATOR::~INSTREAM_DIRECTORY_ITERATOR()
+		-----------------------------------------------------------
+	*/
+	instream_directory_iterator::~instream_directory_iterator()
+		{
 		do
 			{
-			size_t bytes_read = reader->fetch(read_into, amount_to_read);
-			amount_to_read -= bytes_read;
+			std::lock_guard<std::mutex> critical_section(mutex);
+			stop = true;
+			}
+		while (0);
+
+		consumed.notify_all();
+		for (auto &worker : workers)
+			worker.join();
+		}
+
+	/*
+		INSTREAM_DIRECTORY_ITERATOR::OPEN()
+		-----------------------------------
+	*/
+	std::shared_ptr<instream> instream_directory_iterator::open(const std::string &filename)
+		{
+		std::shared_ptr<instream> reader(new instream_file(filename));
 
-			if (amount_to_read == 0)
-				return;
+		if (filename.rfind(".gz") != std::string::npos)
+			reader = std::shared_ptr<instream>(new instream_deflate(reader));
+		else if (filename.rfind(".zst") != std::string::npos)
+			reader = std::shared_ptr<instream>(new instream_zstd(reader));
 
-			read_into = ((uint8_t *)read_into) + bytes_read;
+		return reader;
+		}
+
+	/*
+		INSTREAM_DIRECTORY_ITERATOR::WORK()
+		-----------------------------------
+	*/
+	void instream_directory_iterator::work(void)
+		{
+		while (true)
+			{
+			size_t which;
 
 			/*
-				We're at EOF so move on to the next disk file
+				Wait until the next file is within the window (or there are no files left)
 			*/
-			if (current != last)
+			do
 				{
-//puts(current->path().string().c_str());
-				reader = std::shared_ptr<instream>(new instream_file(current->path().string()));
-				if (current->path().string().rfind(".gz") != std::string::npos)
-					reader = std::shared_ptr<JASS::instream>(new instream_deflate(reader));
-				current++;
+				std::unique_lock<std::mutex> critical_section(mutex);
+				consumed.wait(critical_section, [this]{return stop || next_to_start >= files.size() || next_to_start < next_to_read + window;});
+				if (stop || next_to_start >= files.size())
+					return;
+				which = next_to_start++;
 				}
-			else
+			while (0);
+
+			/*
+				Decompress the file a chunk at a time, waiting if we get too far ahead of the caller
+			*/
+			auto reader = open(filenames[which]);
+			bool finished = false;
+			while (!finished)
+				{
+				std::vector<uint8_t> chunk(chunk_size);
+				chunk.resize(reader->fetch(chunk.data(), chunk_size));
+				finished = chunk.size() < chunk_size;
+
+				do
+					{
+					std::unique_lock<std::mutex> critical_section(mutex);
+					consumed.wait(critical_section, [this, which]{return stop || files[which].chunks.size() < max_chunks_per_file;});
+					if (stop)
+						return;
+					if (chunk.size() != 0)
+						files[which].chunks.push_back(std::move(chunk));
+					files[which].finished = finished;
+					}
+				while (0);
+
+				produced.notify_one();
+				}
+			}
+		}
+
+	/*
+		INSTREAM_DIRECTORY_ITERATOR::READ()
+		-----------------------------------
+	*/
+	void instream_directory_iterator::read(document &document)
+		{
+		size_t wanted = document.contents.size();
+		size_t got = 0;
+
+		while (got < wanted)
+			{
+			/*
+				If we've used the current chunk then get the next one (moving on to the next file if necessary)
+			*/
+			if (current_position >= current.size())
 				{
-				document.contents.resize(document.contents.size() - amount_to_read);
-				return;				// because we're read past the last file so there is no more data to read
+				bool took_chunk = false;
+
+				do
+					{
+					std::unique_lock<std::mutex> critical_section(mutex);
+					produced.wait(critical_section, [this]{return next_to_read >= files.size() || !files[next_to_read].chunks.empty() || files[next_to_read].finished;});
+					if (next_to_read >= files.size())
+						break;
+
+					if (!files[next_to_read].chunks.empty())
+						{
+						current = std::move(files[next_to_read].chunks.front());
+						files[next_to_read].chunks.pop_front();
+						current_position = 0;
+						took_chunk = true;
+						}
+					else
+						next_to_read++;				// this file is finished so move on to the next file
+					}
+				while (0);
+
+				/*
+					A thread might be waiting for space in its queue or for the window to move
+				*/
+				consumed.notify_all();
+
+				if (!took_chunk)
+					{
+					if (next_to_read >= files.size())
+						break;				// because we're read past the last file so there is no more data to read
+					continue;
+					}
 				}
+
+			size_t bytes = (std::min)(current.size() - current_position, wanted - got);
+			memcpy(&document.contents[got], current.data() + current_position, bytes);
+			current_position += bytes;
+			got += bytes;
 			}
-		while (amount_to_read != 0);
+
+		if (got == 0)
+			document.contents = slice();
+		else if (got < wanted)
+			document.contents.resize(got);
 		}
 
 	/*
@@ -86,15 +199,81 @@ namespace JASS
 	*/
 	void instream_directory_iterator::unittest(void)
 		{
-		instream_directory_iterator source(".");
+		/*
+			Read from the current directory (whatever it contains)
+		*/
+		do
+			{
+			instream_directory_iterator source(".");
+
+			document blob;
+			source.read(blob);
+			}
+		while (0);
+
+		/*
+			Build a directory of plain, .gz (multi-member), and .zst files.  Written in reverse order to check the files are read in filename order.
+		*/
+		const std::string &answer = unittest_data::ten_documents;
+		size_t quarter = answer.size() / 4;
+		std::string parts[] = {answer.substr(0, quarter), answer.substr(quarter, quarter), answer.substr(2 * quarter, quarter), answer.substr(3 * quarter)};
+
+		std::string directory = file::mkstemp("jass");
+		(void)remove(directory.c_str());
+		std::filesystem::create_directory(directory);
+
+		std::string zst(parts[2].size() + 1024, '\0');
+		compress_general_zstd zstd_codex;
+		zst.resize(zstd_codex.encode(&zst[0], zst.size(), parts[2].data(), parts[2].size()));
+
+		auto gzip = [](const std::string &from)
+			{
+			z_stream deflater = {};
+			std::string into(from.size() + 1024, '\0');
+
+			deflateInit2(&deflater, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);		// +16 for a gzip header
+			deflater.next_in = (Bytef *)from.data();
+			deflater.avail_in = (uInt)from.size();
+			deflater.next_out = (Bytef *)&into[0];
+			deflater.avail_out = (uInt)into.size();
+			deflate(&deflater, Z_FINISH);
+			into.resize(deflater.total_out);
+			deflateEnd(&deflater);
+
+			return into;
+			};
+
+		std::string gz = gzip(parts[1].substr(0, parts[1].size() / 2)) + gzip(parts[1].substr(parts[1].size() / 2));
+
+		file::write_entire_file(directory + "/d.txt", parts[3]);
+		file::write_entire_file(directory + "/c.zst", zst);
+		file::write_entire_file(directory + "/b.gz", gz);
+		file::write_entire_file(directory + "/a.txt", parts[0]);
+
+		/*
+			The result must be the same regardless of the number of threads
+		*/
+		for (size_t threads : {1, 2, 3, 8})
+			{
+			instream_directory_iterator source(directory, threads);
+			document into;
+			std::string result;
+			do
+				{
+				into.contents = slice(into.contents_allocator, 100);
+				source.read(into);
+				result.append(reinterpret_cast<char *>(into.contents.address()), into.contents.size());
+				}
+			while (into.contents.size() == 100);
+
+			JASS_assert(result == answer);
+			}
+
+		std::filesystem::remove_all(directory);
 
-		document blob;
-		source.read(blob);
 		/*
 			Yay, we passed!
 		*/
 		puts("instream_directory_iterator::PASSED");
 		}
 	}
-
-
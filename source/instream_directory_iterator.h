@@ -12,7 +12,13 @@
 */
 #pragma once
 
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include <filesystem>
+#include <condition_variable>
 
 #include "instream.h"
 
@@ -24,16 +30,67 @@ namespace JASS
 	*/
 	/*!
 		@brief Subclass of instream for reading data from multiple files in a directory (as if they were all concatinated).
+		@details The files are read in filename order.  Files ending in .gz are decompressed with instream_deflate and files ending
+		in .zst with instream_zstd.  Several files are decompressed at once (each on its own thread) into a bounded queue of chunks
+		per file while the caller reads from the earliest unfinished file, so the output is the same regardless of the number of
+		threads, and decompression is no longer the bottleneck of indexing.
 	*/
 	class instream_directory_iterator : public instream
 		{
 		protected:
-			std::filesystem::directory_iterator source;		///< Use the C++17 directory iterator
-			std::filesystem::directory_iterator current;		///< Where we are in the current iteration
-			std::filesystem::directory_iterator last;			///< The point where the iterator finishes iterating
+			static constexpr size_t chunk_size = 1024 * 1024;				///< Decompressed data is passed to the caller in chunks of this size
+			static constexpr size_t max_chunks_per_file = 16;				///< The number of chunks a file can get ahead of the caller before its thread waits
 
-			std::shared_ptr<instream> reader;					///< A chain of instram objects responsible for sourcing the data
-			size_t bytes_read;										///< The number of bytes that have been read from the file.
+		protected:
+			/*
+				CLASS INSTREAM_DIRECTORY_ITERATOR::FILE_STATE
+				---------------------------------------------
+			*/
+			/*!
+				@brief The decompressed (but not yet read) data from one of the files in the directory.
+			*/
+			class file_state
+				{
+				public:
+					std::deque<std::vector<uint8_t>> chunks;		///< Data ready to be given to the caller.
+					bool finished = false;								///< All the data for this file has been placed in chunks.
+				};
+
+		protected:
+			std::vector<std::string> filenames;					///< The files in the directory (sorted)
+			std::vector<file_state> files;						///< The decompression state of each file
+			size_t next_to_start;									///< The next file to hand to a thread
+			size_t next_to_read;										///< The file the caller is reading from
+			size_t window;												///< Threads only start on files less than next_to_read + window
+			bool stop;													///< Tell the threads to stop (this object is being destroyed).
+			std::mutex mutex;											///< Protects files, next_to_start, next_to_read, and stop.
+			std::condition_variable produced;					///< Signalled when a thread adds a chunk or finishes a file.
+			std::condition_variable consumed;					///< Signalled when the caller takes a chunk or moves to the next file (or stop is set).
+			std::vector<std::thread> workers;					///< The decompression threads
+
+			std::vector<uint8_t> current;							///< The chunk the caller is reading from
+			size_t current_position;								///< How far through current the caller is.
+
+		protected:
+			/*
+				INSTREAM_DIRECTORY_ITERATOR::OPEN()
+				-----------------------------------
+			*/
+			/*!
+				@brief Build the instream pipeline to read the given file (decompressing if necessary).
+				@param filename [in] The name of the file to read.
+				@return The pipeline.
+			*/
+			static std::shared_ptr<instream> open(const std::string &filename);
+
+			/*
+				INSTREAM_DIRECTORY_ITERATOR::WORK()
+				-----------------------------------
+			*/
+			/*!
+				@brief The body of each decompression thread, decompress files until there are none left (or told to stop).
+			*/
+			void work(void);
 
 		public:
 			/*
@@ -43,20 +100,18 @@ namespace JASS
 			/*!
 				@brief Constructor
 				@param directory_name [in] The name of the directory to search within
+				@param threads [in] The number of files to decompress at once (default = the number of CPU cores)
 			*/
-			instream_directory_iterator(const std::string &directory_name);
+			instream_directory_iterator(const std::string &directory_name, size_t threads = std::thread::hardware_concurrency());
 
 			/*
 				INSTREAM_DIRECTORY_ITERATOR::~INSTREAM_DIRECTORY_ITERATOR()
 				-----------------------------------------------------------
 			*/
 			/*!
-				@brief Destructor.
+				@brief Destructor.  Stops and waits for the decompression threads.
 			*/
-			virtual ~instream_directory_iterator()
-				{
-				/* Nothing */
-				}
+			virtual ~instream_directory_iterator();
 
 			/*
 				INSTREAM_DIRECTORY_ITERATOR::READ()
@@ -12,6 +12,7 @@
 #include <algorithm>
 
 #include "assert.h"
+#include "simd_search.h"
 #include "unittest_data.h"
 #include "instream_memory.h"
 #include "instream_document_trec.h"
@@ -88,7 +89,7 @@ namespace JASS
 			Find the start tag
 		*/
 		uint8_t *document_start;
-		if ((document_start = std::search(unread_data, buffer_end, document_start_tag.c_str(), document_start_tag.c_str() + document_start_tag.size())) == buffer_end)
+		if ((document_start = simd_search::find(unread_data, buffer_end, document_start_tag)) == buffer_end)
 			{
 			/*
 				We might be at the end of a buffer and half-way through a tag so we copy the remainder of the file to the
@@ -101,7 +102,7 @@ namespace JASS
 			fetch(buffer_end, buffer + buffer_size - buffer_end);
 			unread_data = buffer;
 		
-			if ((document_start = std::search(unread_data, buffer_end, document_start_tag.c_str(), document_start_tag.c_str() + document_start_tag.size())) == buffer_end)
+			if ((document_start = simd_search::find(unread_data, buffer_end, document_start_tag)) == buffer_end)
 				{
 				/*
 					Most probably end of file.
@@ -116,7 +117,7 @@ namespace JASS
 			Find the end tag
 		*/
 		uint8_t *document_end;
-		if ((document_end = std::search(document_start, buffer_end, document_end_tag.c_str(), document_end_tag.c_str() + document_end_tag.size())) == buffer_end)
+		if ((document_end = simd_search::find(document_start, buffer_end, document_end_tag)) == buffer_end)
 			{
 			/*
 				This happens when we move find the start tag in the buffer, but the end tag is not in memory.  We play the 
@@ -126,7 +127,7 @@ namespace JASS
 			buffer_end -= document_start - buffer;
 			fetch(buffer_end, buffer_size - (buffer_end - buffer));
 			document_start = buffer;
-			if ((document_end = std::search(document_start, buffer_end, document_end_tag.c_str(), document_end_tag.c_str() + document_end_tag.size())) == buffer_end)
+			if ((document_end = simd_search::find(document_start, buffer_end, document_end_tag)) == buffer_end)
 				{
 				/*
 					We are either at end of file of have a document that is too large to index (so pretend EOF)
@@ -142,11 +143,11 @@ namespace JASS
 			Extract the document's primary key.
 		*/
 		uint8_t *document_id_end = document_end;
-		uint8_t *document_id_start = std::search(document_start, document_end, primary_key_start_tag.c_str(), primary_key_start_tag.c_str() + primary_key_start_tag.size());
+		uint8_t *document_id_start = simd_search::find(document_start, document_end, primary_key_start_tag);
 		if (document_id_start != document_end)
 			{
 			document_id_start += primary_key_start_tag.size();
-			document_id_end = std::search(document_id_start, document_end, primary_key_end_tag.c_str(), primary_key_end_tag.c_str() + primary_key_end_tag.size());
+			document_id_end = simd_search::find(document_id_start, document_end, primary_key_end_tag);
 
 			/*
 				Trim whitespace from the start and end of the primary key.
@@ -1,92 +1,123 @@
-/*
-	INSTREAM_DOCUMENT_WARC.H
-	------------------------
-	Copyright (c) 2019 Andrew Trotman
-	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
-*/
-/*!
-	@file
-	@brief Child class of instream for creating documents from TREC WARC files.
-	@author Andrew Trotman
-	@copyright 2019 Andrew Trotman
-*/
-
-#pragma once
-
-#include "instream.h"
-
-namespace JASS
-	{
-	/*
-		CLASS INSTREAM_DOCUMENT_WARC
-		----------------------------
-	*/
-	/*!
-		@brief Extract documents from a WARC archive
-	*/
-	class instream_document_warc : public instream
-		{
-		private:
-			static constexpr size_t WARC_BUFFER_SIZE = 8 * 1024;		///< The internal buffer used to read lines one at a time
-			
-		private:
-			std::string buffer;													///< An internal buffer used to store lines
-			
-		private:
-			/*
-				INSTREAM_DOCUMENT_WARC::FIND_STRING()
-				-------------------------------------
-			*/
-			/*!
-				@brief read lines from the WARC file until one starting with string is found.
-				@param string [in] the string to look for (at the start of a line)
-				@return a pointer to the remainder of the string
-			*/
-			const char *find_string(const std::string &string);
-
-		public:
-			/*
-				INSTREAM_DOCUMENT_WARC::INSTREAM_DOCUMENT_WARC()
-				------------------------------------------------
-			*/
-			/*!
-				@brief Constructor
-			*/
-			instream_document_warc(std::shared_ptr<instream> &source) :
-				instream(source)
-				{
-				buffer.resize(WARC_BUFFER_SIZE);
-				}
-
-			/*
-				INSTREAM_DOCUMENT_WARC::~INSTREAM_DOCUMENT_WARC()
-				-------------------------------------------------
-			*/
-			/*!
-				@brief Destructor
-			*/
-			virtual ~instream_document_warc()
-				{
-				/* Nothing */
-				}
-
-			/*
-				INSTREAM_DOCUMENT_WARC::READ()
-				------------------------------
-			*/
-			/*!
-				@brief Read the next document from the source instream into document.
-				@param buffer [out] The next document in the source instream.
-			*/
-			virtual void read(document &buffer);
-
-			/*
-				INSTREAM_DOCUMENT_WARC::UNITTEST()
-				----------------------------------
-			*/
-			/*!
-				@brief Unit test this class
-			*/
-			static void unittest(void);
-		};
-	}
+/*
+	INSTREAM_DOCUMENT_WARC.H
+	------------------------
+	Copyright (c) 2019 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Child class of instream for creating documents from TREC WARC files.
+	@author Andrew Trotman
+	@copyright 2019 Andrew Trotman
+*/
+
+#pragma once
+
+#include <memory>
+
+#include "instream.h"
+
+namespace JASS
+	{
+	/*
+		CLASS INSTREAM_DOCUMENT_WARC
+		----------------------------
+	*/
+	/*!
+		@brief Extract documents from a WARC archive
+	*/
+	class instream_document_warc : public instream
+		{
+		private:
+			static constexpr size_t WARC_BUFFER_SIZE = 1024 * 1024;		///< The default size of the internal buffer the WARC file is read into
+
+		private:
+			size_t buffer_size;													///< The size of buffer
+			std::unique_ptr<uint8_t []> buffer;								///< An internal buffer holding the part of the WARC file being parsed
+			uint8_t *buffer_start;												///< The first unparsed byte in buffer (the '\n' at the end of the last line parsed)
+			uint8_t *buffer_end;													///< The end of the valid data in buffer
+			const uint8_t *line_end;											///< The end of the line found by find_string()
+
+		private:
+			/*
+				INSTREAM_DOCUMENT_WARC::REFILL()
+				--------------------------------
+			*/
+			/*!
+				@brief Move the data from keep_from to the end of the buffer to the start of the buffer then fill the rest of the buffer from the source.
+				@param keep_from [in] The start of the data to keep.
+				@return The number of bytes read from the source (0 at EOF).
+			*/
+			size_t refill(const uint8_t *keep_from);
+
+			/*
+				INSTREAM_DOCUMENT_WARC::FIND_STRING()
+				-------------------------------------
+			*/
+			/*!
+				@brief Search the WARC file for a line starting with string followed by a ':'.
+				@details The search uses simd_search::find() over the internal buffer (shared with instream_document_trec) rather than reading a line at a time.
+				@param string [in] the string to look for (at the start of a line)
+				@return a pointer to the remainder of the line (which ends at line_end), or nullptr at EOF
+			*/
+			const char *find_string(const std::string &string);
+
+		protected:
+			/*
+				INSTREAM_DOCUMENT_WARC::INSTREAM_DOCUMENT_WARC()
+				------------------------------------------------
+			*/
+			/*!
+				@brief Protected constructor used to set the size of the internal buffer in the unittest.
+				@param source [in] The instream responsible for providing data to this class.
+				@param buffer_size [in] The size of the internal buffer filled from source.
+			*/
+			instream_document_warc(std::shared_ptr<instream> &source, size_t buffer_size);
+
+		public:
+			/*
+				INSTREAM_DOCUMENT_WARC::INSTREAM_DOCUMENT_WARC()
+				------------------------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param source [in] The instream responsible for providing data to this class.
+			*/
+			instream_document_warc(std::shared_ptr<instream> &source) :
+				instream_document_warc(source, WARC_BUFFER_SIZE)
+				{
+				/* Nothing */
+				}
+
+			/*
+				INSTREAM_DOCUMENT_WARC::~INSTREAM_DOCUMENT_WARC()
+				-------------------------------------------------
+			*/
+			/*!
+				@brief Destructor
+			*/
+			virtual ~instream_document_warc()
+				{
+				/* Nothing */
+				}
+
+			/*
+				INSTREAM_DOCUMENT_WARC::READ()
+				------------------------------
+			*/
+			/*!
+				@brief Read the next document from the source instream into document.
+				@param buffer [out] The next document in the source instream.
+			*/
+			virtual void read(document &buffer);
+
+			/*
+				INSTREAM_DOCUMENT_WARC::UNITTEST()
+				----------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
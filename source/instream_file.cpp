@@ -62,10 +62,13 @@ namespace JASS
 		document.contents.resize(file_length - bytes_read);
 
 	/*
-		Do the read and note how many bytes we're read.
+		Do the read and note how many bytes we're read.  When reading from a FILE * (such as stdin) the length isn't known
+		so the read can come up short, in which case the document is shortened to what was actually read.
 	*/
-	if (disk_file.read(&document.contents[0], document.contents.size()) > 0)
-		bytes_read += document.contents.size();
+	size_t got = disk_file.read(&document.contents[0], document.contents.size());
+	if (got < document.contents.size())
+		document.contents.resize(got);
+	bytes_read += got;
 	}
 	
 	/*
@@ -0,0 +1,226 @@
+/*
+	INSTREAM_FILE_DIRECT.CPP
+	------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <errno.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+	#include <io.h>
+	#include <fcntl.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "file.h"
+#include "asserts.h"
+#include "instream_file_direct.h"
+
+namespace JASS
+	{
+	/*
+		INSTREAM_FILE_DIRECT::INSTREAM_FILE_DIRECT()
+		--------------------------------------------
+	*/
+	instream_file_direct::instream_file_direct(const std::string &filename, size_t block_size) :
+		instream(),
+		handle(-1),
+		block_size((block_size + alignment - 1) / alignment * alignment),
+		buffer_used(0),
+		buffer_position(0),
+		at_eof(false)
+		{
+		if (this->block_size == 0)
+			this->block_size = alignment;
+
+		memory = std::make_unique<uint8_t []>(this->block_size + alignment);
+		buffer = reinterpret_cast<uint8_t *>((reinterpret_cast<uintptr_t>(memory.get()) + alignment - 1) / alignment * alignment);
+
+		#ifdef _MSC_VER
+			handle = ::_open(filename.c_str(), _O_RDONLY | _O_BINARY | _O_SEQUENTIAL);
+		#else
+			#ifdef O_DIRECT
+				/*
+					Not all file systems support O_DIRECT (tmpfs, for example, fails with EINVAL) so fall back to the page cache if necessary
+				*/
+				if ((handle = ::open(filename.c_str(), O_RDONLY | O_DIRECT)) < 0)
+			#endif
+					handle = ::open(filename.c_str(), O_RDONLY);
+		#endif
+
+		if (handle < 0)
+			at_eof = true;
+		}
+
+	/*
+		INSTREAM_FILE_DIRECT::~INSTREAM_FILE_DIRECT()
+		---------------------------------------------
+	*/
+	instream_file_direct::~instream_file_direct()
+		{
+		if (handle >= 0)
+			#ifdef _MSC_VER
+				::_close(handle);
+			#else
+				::close(handle);
+			#endif
+		}
+
+	/*
+		INSTREAM_FILE_DIRECT::FILL()
+		----------------------------
+	*/
+	void instream_file_direct::fill(void)
+		{
+		buffer_used = 0;
+		buffer_position = 0;
+
+		/*
+			A read() can return fewer bytes than asked for without being at eof, so keep going until the buffer is full or we hit eof.
+			With O_DIRECT only the last read of the file can be short, so the file position stays aligned.
+		*/
+		while (buffer_used < block_size)
+			{
+			#ifdef _MSC_VER
+				auto got = ::_read(handle, buffer + buffer_used, static_cast<unsigned int>(block_size - buffer_used));
+			#else
+				auto got = ::read(handle, buffer + buffer_used, block_size - buffer_used);
+				#ifdef O_DIRECT
+					if (got < 0 && errno == EINVAL)
+						{
+						/*
+							The file system accepted O_DIRECT at open() but refused it at read() so turn it off and try again.
+						*/
+						fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) & ~O_DIRECT);
+						got = ::read(handle, buffer + buffer_used, block_size - buffer_used);
+						}
+				#endif
+			#endif
+
+			if (got <= 0)
+				{
+				at_eof = true;
+				break;
+				}
+			buffer_used += got;
+			}
+		}
+
+	/*
+		INSTREAM_FILE_DIRECT::READ()
+		----------------------------
+	*/
+	void instream_file_direct::read(document &document)
+		{
+		size_t wanted = document.contents.size();
+		size_t got = 0;
+
+		while (got < wanted)
+			{
+			if (buffer_position >= buffer_used)
+				{
+				if (at_eof)
+					break;
+				fill();
+				if (buffer_used == 0)
+					break;
+				}
+
+			size_t bytes = (std::min)(buffer_used - buffer_position, wanted - got);
+			memcpy(&document.contents[got], buffer + buffer_position, bytes);
+			buffer_position += bytes;
+			got += bytes;
+			}
+
+		if (got == 0)
+			document.contents = slice();
+		else if (got < wanted)
+			document.contents.resize(got);
+		}
+
+	/*
+		INSTREAM_FILE_DIRECT::UNITTEST()
+		--------------------------------
+	*/
+	void instream_file_direct::unittest(void)
+		{
+		/*
+			Write to a disk file using the file class
+		*/
+		const char *example_file = "123456789012345678901234567890";			// sample to be written and read back
+		auto filename = file::mkstemp("jass");
+		file::write_entire_file(filename, example_file);
+
+		/*
+			create an instream_file_direct and test it.
+			NOTE: The scope is created so that the object is deleted before removal of the temporary file.
+		*/
+		do
+			{
+			instream_file_direct reader(filename);
+			document document;
+			document.contents = slice(document.contents_allocator, 16);
+
+			/*
+				read twice from it making sure we got what we should have
+			*/
+			reader.read(document);
+			JASS_assert(document.contents.size() == 16);
+			for (size_t index = 0; index < document.contents.size(); index++)
+				JASS_assert(document.contents[index] == example_file[index]);
+
+			reader.read(document);
+			JASS_assert(document.contents.size() == 14);
+			for (size_t index = 0; index < document.contents.size(); index++)
+				JASS_assert(document.contents[index] == example_file[index + 16]);
+
+			reader.read(document);
+			JASS_assert(document.contents.size() == 0);
+			}
+		while (0);
+
+		/*
+			Now a file larger than the block size, read in pieces that straddle the blocks
+		*/
+		std::string large;
+		for (size_t character = 0; character < 3 * alignment + 123; character++)
+			large.push_back('a' + character % 26);
+		file::write_entire_file(filename, large);
+
+		do
+			{
+			instream_file_direct reader(filename, alignment);
+			document document;
+			std::string result;
+			do
+				{
+				document.contents = slice(document.contents_allocator, 1000);
+				reader.read(document);
+				result.append(reinterpret_cast<char *>(document.contents.address()), document.contents.size());
+				}
+			while (document.contents.size() == 1000);
+
+			JASS_assert(result == large);
+			}
+		while (0);
+
+		/*
+			Delete the temporary file.
+		*/
+		(void)remove(filename.c_str());			// delete the file.  Cast to void to remove Coverity warning if remove() fails.
+
+		/*
+			A missing file is an empty file
+		*/
+		instream_file_direct missing(filename);
+		document document;
+		document.contents = slice(document.contents_allocator, 16);
+		missing.read(document);
+		JASS_assert(document.contents.size() == 0);
+
+		puts("instream_file_direct::PASSED");
+		}
+	}
@@ -0,0 +1,98 @@
+/*
+	INSTREAM_FILE_DIRECT.H
+	----------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Subclass of instream for reading data from a disk file in large aligned blocks, bypassing the page cache where possible.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "instream.h"
+
+namespace JASS
+	{
+	/*
+		CLASS INSTREAM_FILE_DIRECT
+		--------------------------
+	*/
+	/*!
+		@brief Subclass of the instream base class used for reading data from a disk file in large aligned blocks.
+		@details Indexing reads each input file once, from start to end, so there is no value in the kernel caching it.  This class opens the file
+		with O_DIRECT (where available) and reads it in large blocks into an aligned buffer, copying out to the caller on each read().  If the
+		file system does not support O_DIRECT (for example, tmpfs) then the file is read through the page cache as usual.  Typically used as the source
+		of an instream_prefetch so that the disk reads happen on a background thread.
+	*/
+	class instream_file_direct : public instream
+		{
+		protected:
+			static constexpr size_t alignment = 4096;									///< O_DIRECT requires the buffer, read size, and file position to be aligned to (at least) this.
+			static constexpr size_t default_block_size = 8 * 1024 * 1024;			///< Read from disk (by default) in blocks of this size.
+
+		protected:
+			int handle;											///< The file handle (or -1 if the file could not be opened).
+			size_t block_size;								///< The number of bytes to read from disk at a time (a multiple of alignment).
+			std::unique_ptr<uint8_t []> memory;			///< The memory holding the buffer (over-allocated so that buffer can be aligned).
+			uint8_t *buffer;									///< The aligned buffer the file is read into.
+			size_t buffer_used;								///< The number of valid bytes in buffer.
+			size_t buffer_position;							///< The number of bytes of buffer already given to the caller.
+			bool at_eof;										///< The underlying file has been read to the end.
+
+		protected:
+			/*
+				INSTREAM_FILE_DIRECT::FILL()
+				----------------------------
+			*/
+			/*!
+				@brief Read the next block from disk into buffer.
+			*/
+			void fill(void);
+
+		public:
+			/*
+				INSTREAM_FILE_DIRECT::INSTREAM_FILE_DIRECT()
+				--------------------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param filename [in] The name of the file to use as the input stream
+				@param block_size [in] The number of bytes to read from disk at a time (rounded up to a multiple of 4096, default = 8MB)
+			*/
+			instream_file_direct(const std::string &filename, size_t block_size = default_block_size);
+
+			/*
+				INSTREAM_FILE_DIRECT::~INSTREAM_FILE_DIRECT()
+				---------------------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~instream_file_direct();
+
+			/*
+				INSTREAM_FILE_DIRECT::READ()
+				----------------------------
+			*/
+			/*!
+				@brief Read buffer.contents.size() bytes of data into buffer.contents, resizing on eof.
+				@param buffer [out] buffer.contents.size() bytes of data are read from the file into buffer which is resized to the number of bytes read on eof.
+			*/
+			virtual void read(document &buffer);
+
+			/*
+				INSTREAM_FILE_DIRECT::UNITTEST()
+				--------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
@@ -96,6 +96,17 @@ namespace JASS
 				JASS_assert(document.contents.size() == 30);
 				for (size_t index = 0; index < document.contents.size(); index++)
 					JASS_assert(document.contents[index] == example[index]);
+
+				/*
+					The length of a FILE * isn't known so reads past the end must come up short (just the '\0' is left) then be empty.
+				*/
+				reader.read(document);
+				JASS_assert(document.contents.size() == 1);
+				JASS_assert(document.contents[0] == '\0');
+
+				document.contents = slice(document.contents_allocator, 30);
+				reader.read(document);
+				JASS_assert(document.contents.size() == 0);
 			
 				/*
 					Yay, we passed
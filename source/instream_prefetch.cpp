@@ -0,0 +1,254 @@
+/*
+	INSTREAM_PREFETCH.CPP
+	---------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+
+#include <string>
+
+#include "asserts.h"
+#include "unittest_data.h"
+#include "instream_memory.h"
+#include "instream_prefetch.h"
+#include "instream_document_trec.h"
+
+namespace JASS
+	{
+	/*
+		INSTREAM_PREFETCH::INSTREAM_PREFETCH()
+		--------------------------------------
+	*/
+	instream_prefetch::instream_prefetch(std::shared_ptr<instream> &source, size_t block_size, size_t blocks) :
+		instream(source),
+		block_size(block_size),
+		ring(blocks < 2 ? 2 : blocks),
+		blocks_filled(0),
+		blocks_consumed(0),
+		consumed_from_block(0),
+		at_eof(false),
+		stop(false)
+		{
+		for (auto &buffer : ring)
+			{
+			buffer.data = std::make_unique<uint8_t []>(block_size);
+			buffer.used = 0;
+			}
+
+		producer = std::thread(&instream_prefetch::produce, this);
+		}
+
+	/*
+		INSTREAM_PREFETCH::~INSTREAM_PREFETCH()
+		---------------------------------------
+	*/
+	instream_prefetch::~instream_prefetch()
+		{
+		do
+			{
+			std::lock_guard<std::mutex> critical_section(mutex);
+			stop = true;
+			}
+		while (0);
+
+		emptied.notify_one();
+		producer.join();
+		}
+
+	/*
+		INSTREAM_PREFETCH::PRODUCE()
+		----------------------------
+	*/
+	void instream_prefetch::produce(void)
+		{
+		while (true)
+			{
+			block *into;
+
+			/*
+				Wait for an empty buffer
+			*/
+			do
+				{
+				std::unique_lock<std::mutex> critical_section(mutex);
+				emptied.wait(critical_section, [this]{return stop || blocks_filled - blocks_consumed < ring.size();});
+				if (stop)
+					return;
+				into = &ring[blocks_filled % ring.size()];
+				}
+			while (0);
+
+			/*
+				Fill it without holding the lock (the consumer cannot see this buffer until blocks_filled is incremented)
+			*/
+			into->used = source->fetch(into->data.get(), block_size);
+
+			/*
+				Hand it to the consumer
+			*/
+			do
+				{
+				std::lock_guard<std::mutex> critical_section(mutex);
+				blocks_filled++;
+				if (into->used < block_size)
+					at_eof = true;
+				}
+			while (0);
+
+			filled.notify_one();
+
+			if (into->used < block_size)
+				return;
+			}
+		}
+
+	/*
+		INSTREAM_PREFETCH::READ()
+		-------------------------
+	*/
+	void instream_prefetch::read(document &buffer)
+		{
+		size_t wanted = buffer.contents.size();
+		size_t got = 0;
+
+		while (got < wanted)
+			{
+			block *from = nullptr;
+
+			/*
+				Wait for a full buffer (or eof)
+			*/
+			do
+				{
+				std::unique_lock<std::mutex> critical_section(mutex);
+				filled.wait(critical_section, [this]{return at_eof || blocks_filled != blocks_consumed;});
+				if (blocks_filled != blocks_consumed)
+					from = &ring[blocks_consumed % ring.size()];
+				}
+			while (0);
+
+			/*
+				At eof and all buffers have been consumed
+			*/
+			if (from == nullptr)
+				break;
+
+			/*
+				Copy as much as we can (or need) from this buffer
+			*/
+			size_t bytes = (std::min)(from->used - consumed_from_block, wanted - got);
+			memcpy(&buffer.contents[got], from->data.get() + consumed_from_block, bytes);
+			got += bytes;
+			consumed_from_block += bytes;
+
+			/*
+				If we've emptied the buffer then hand it back to the producer
+			*/
+			if (consumed_from_block == from->used)
+				{
+				do
+					{
+					std::lock_guard<std::mutex> critical_section(mutex);
+					blocks_consumed++;
+					consumed_from_block = 0;
+					}
+				while (0);
+
+				emptied.notify_one();
+				}
+			}
+
+		if (got == 0)
+			buffer.contents = slice();
+		else if (got < wanted)
+			buffer.contents.resize(got);
+		}
+
+	/*
+		INSTREAM_PREFETCH::UNITTEST()
+		-----------------------------
+	*/
+	void instream_prefetch::unittest(void)
+		{
+		/*
+			Read through a ring of tiny buffers using reads that are not the same size as the buffers
+		*/
+		std::string answer;
+		for (size_t character = 0; character < 1000; character++)
+			answer.push_back('a' + character % 26);
+
+		do
+			{
+			std::shared_ptr<instream> memory(new instream_memory(answer.c_str(), answer.size()));
+			instream_prefetch reader(memory, 7, 3);
+			document into;
+			std::string result;
+
+			do
+				{
+				into.contents = slice(into.contents_allocator, 11);
+				reader.read(into);
+				result.append(reinterpret_cast<char *>(into.contents.address()), into.contents.size());
+				}
+			while (into.contents.size() == 11);
+
+			JASS_assert(result == answer);
+
+			/*
+				Reading again at eof gets nothing
+			*/
+			into.contents = slice(into.contents_allocator, 11);
+			reader.read(into);
+			JASS_assert(into.contents.size() == 0);
+			}
+		while (0);
+
+		/*
+			Make sure a document pipeline gets the same documents with and without the prefetcher
+		*/
+		std::shared_ptr<instream> memory(new instream_memory(unittest_data::ten_documents.c_str(), unittest_data::ten_documents.size()));
+		std::shared_ptr<instream> prefetcher(new instream_prefetch(memory, 13, 2));
+		instream_document_trec slicer(prefetcher);
+
+		std::shared_ptr<instream> direct_memory(new instream_memory(unittest_data::ten_documents.c_str(), unittest_data::ten_documents.size()));
+		instream_document_trec direct_slicer(direct_memory);
+
+		document got;
+		document expected;
+		size_t documents = 0;
+		do
+			{
+			got.rewind();
+			expected.rewind();
+			slicer.read(got);
+			direct_slicer.read(expected);
+			JASS_assert(got.contents.size() == expected.contents.size());
+			JASS_assert(got.primary_key.size() == expected.primary_key.size());
+			if (got.isempty())
+				break;
+			JASS_assert(memcmp(got.contents.address(), expected.contents.address(), got.contents.size()) == 0);
+			JASS_assert(memcmp(got.primary_key.address(), expected.primary_key.address(), got.primary_key.size()) == 0);
+			documents++;
+			}
+		while (true);
+
+		JASS_assert(documents == 10);
+
+		/*
+			Destroying the object before the source is exhausted must stop the background thread
+		*/
+		do
+			{
+			std::shared_ptr<instream> memory(new instream_memory(answer.c_str(), answer.size()));
+			instream_prefetch reader(memory, 5, 2);
+			document into;
+			into.contents = slice(into.contents_allocator, 3);
+			reader.read(into);
+			JASS_assert(into.contents.size() == 3);
+			}
+		while (0);
+
+		puts("instream_prefetch::PASSED");
+		}
+	}
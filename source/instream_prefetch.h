@@ -0,0 +1,121 @@
+/*
+	INSTREAM_PREFETCH.H
+	-------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Subclass of instream that reads its source on a background thread into a ring of buffers.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <condition_variable>
+
+#include "instream.h"
+
+namespace JASS
+	{
+	/*
+		CLASS INSTREAM_PREFETCH
+		-----------------------
+	*/
+	/*!
+		@brief Subclass of instream that reads its source on a background thread into a ring of buffers.
+		@details Place an object of this class in a pipeline between a slow stage (disk I/O, instream_deflate, etc.) and the stage
+		that consumes it (instream_document_trec, etc.).  A background thread repeatedly fills the next empty buffer in the ring from the source
+		while the consumer copies out of the filled buffers, so the consumer only waits if it gets ahead of the source.  As with
+		other instreams, read() only returns fewer bytes than asked for at end of file.
+	*/
+	class instream_prefetch : public instream
+		{
+		protected:
+			static constexpr size_t default_block_size = 8 * 1024 * 1024;			///< Each buffer in the ring is (by default) this size
+			static constexpr size_t default_blocks = 4;									///< The ring has (by default) this many buffers
+
+		protected:
+			/*
+				CLASS INSTREAM_PREFETCH::BLOCK
+				------------------------------
+			*/
+			/*!
+				@brief A buffer in the ring.
+			*/
+			class block
+				{
+				public:
+					std::unique_ptr<uint8_t []> data;		///< The data read from the source.
+					size_t used;									///< The number of bytes of data that are valid.
+				};
+
+		protected:
+			size_t block_size;							///< The size of each buffer in the ring (in bytes)
+			std::vector<block> ring;					///< The ring of buffers
+			size_t blocks_filled;						///< The number of buffers the producer has filled (ring[blocks_filled % ring.size()] is next to be filled).
+			size_t blocks_consumed;						///< The number of buffers the consumer has emptied (ring[blocks_consumed % ring.size()] is next to be read).
+			size_t consumed_from_block;				///< The number of bytes the consumer has taken from the current buffer.
+			bool at_eof;									///< The producer has seen the end of the source.
+			bool stop;										///< Tell the producer to stop (this object is being destroyed).
+			std::mutex mutex;								///< Protects blocks_filled, blocks_consumed, at_eof, and stop.
+			std::condition_variable filled;			///< Signalled when the producer fills a buffer.
+			std::condition_variable emptied;			///< Signalled when the consumer empties a buffer (or stop is set).
+			std::thread producer;						///< The background thread that reads from source.
+
+		protected:
+			/*
+				INSTREAM_PREFETCH::PRODUCE()
+				----------------------------
+			*/
+			/*!
+				@brief The body of the background thread, fill buffers from the source until eof or until told to stop.
+			*/
+			void produce(void);
+
+		public:
+			/*
+				INSTREAM_PREFETCH::INSTREAM_PREFETCH()
+				--------------------------------------
+			*/
+			/*!
+				@brief Constructor.  Starts the background thread.
+				@param source [in] The instream to read from (on the background thread).
+				@param block_size [in] The size of each buffer in the ring (default = 8MB).
+				@param blocks [in] The number of buffers in the ring (default = 4, must be at least 2).
+			*/
+			instream_prefetch(std::shared_ptr<instream> &source, size_t block_size = default_block_size, size_t blocks = default_blocks);
+
+			/*
+				INSTREAM_PREFETCH::~INSTREAM_PREFETCH()
+				---------------------------------------
+			*/
+			/*!
+				@brief Destructor.  Stops and waits for the background thread.
+			*/
+			virtual ~instream_prefetch();
+
+			/*
+				INSTREAM_PREFETCH::READ()
+				-------------------------
+			*/
+			/*!
+				@brief Read buffer.contents.size() bytes of data into buffer.contents, resizing on eof.
+				@param buffer [out] buffer.contents.size() bytes of data are read from the ring into buffer which is resized to the number of bytes read on eof.
+			*/
+			virtual void read(document &buffer);
+
+			/*
+				INSTREAM_PREFETCH::UNITTEST()
+				-----------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
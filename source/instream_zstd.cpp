@@ -0,0 +1,134 @@
+/*
+	INSTREAM_ZSTD.CPP
+	-----------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <stdio.h>
+
+#include <string>
+
+#include "asserts.h"
+#include "unittest_data.h"
+#include "instream_zstd.h"
+#include "instream_memory.h"
+#include "compress_general_zstd.h"
+
+namespace JASS
+	{
+	/*
+		INSTREAM_ZSTD::INSTREAM_ZSTD()
+		------------------------------
+	*/
+	instream_zstd::instream_zstd(std::shared_ptr<instream> &source) :
+		instream(source),
+		stream(ZSTD_createDStream()),
+		input{nullptr, 0, 0},
+		buffer(std::make_unique<uint8_t []>(buffer_length)),
+		source_eof(false)
+		{
+		ZSTD_initDStream(stream);
+		input.src = buffer.get();
+		}
+
+	/*
+		INSTREAM_ZSTD::~INSTREAM_ZSTD()
+		-------------------------------
+	*/
+	instream_zstd::~instream_zstd()
+		{
+		ZSTD_freeDStream(stream);
+		}
+
+	/*
+		INSTREAM_ZSTD::READ()
+		---------------------
+	*/
+	void instream_zstd::read(document &document)
+		{
+		ZSTD_outBuffer output = {document.contents.address(), document.contents.size(), 0};
+
+		while (output.pos < output.size)
+			{
+			/*
+				Refill the input buffer if we've used it all
+			*/
+			if (input.pos >= input.size)
+				{
+				if (source_eof)
+					break;
+				input.size = source->fetch(buffer.get(), buffer_length);
+				input.pos = 0;
+				if (input.size == 0)
+					{
+					source_eof = true;
+					break;
+					}
+				}
+
+			/*
+				Decompress.  At the end of a frame this returns 0 and the next call starts on the next frame (if there is one).
+			*/
+			size_t state = ZSTD_decompressStream(stream, &output, &input);
+			if (ZSTD_isError(state))
+				{
+				printf("JASS::instream_zstd::read failure trying to decompress (zstd reports:%s)\n", ZSTD_getErrorName(state));
+				source_eof = true;
+				input.pos = input.size;
+				break;
+				}
+			}
+
+		if (output.pos == 0)
+			document.contents = slice();
+		else if (output.pos < output.size)
+			document.contents.resize(output.pos);
+		}
+
+	/*
+		INSTREAM_ZSTD::UNITTEST()
+		-------------------------
+	*/
+	void instream_zstd::unittest(void)
+		{
+		/*
+			Compress the two halves of the test data seperately and concatenate them to make a multi-frame file
+		*/
+		const std::string &answer = unittest_data::ten_documents;
+		compress_general_zstd codex;
+		std::string compressed;
+		for (const auto &half : {answer.substr(0, answer.size() / 2), answer.substr(answer.size() / 2)})
+			{
+			std::string frame(half.size() + 1024, '\0');
+			frame.resize(codex.encode(&frame[0], frame.size(), half.data(), half.size()));
+			compressed += frame;
+			}
+
+		/*
+			Decompress it using reads that straddle the frame boundary
+		*/
+		std::shared_ptr<instream> memory(new instream_memory(compressed.data(), compressed.size()));
+		instream_zstd reader(memory);
+		document into;
+		std::string result;
+
+		do
+			{
+			into.contents = slice(into.contents_allocator, 100);
+			reader.read(into);
+			result.append(reinterpret_cast<char *>(into.contents.address()), into.contents.size());
+			}
+		while (into.contents.size() == 100);
+
+		JASS_assert(result == answer);
+
+		/*
+			Reading again at eof gets nothing
+		*/
+		into.contents = slice(into.contents_allocator, 100);
+		reader.read(into);
+		JASS_assert(into.contents.size() == 0);
+
+		puts("instream_zstd::PASSED");
+		}
+	}
@@ -0,0 +1,81 @@
+/*
+	INSTREAM_ZSTD.H
+	---------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Subclass of instream for reading from .zst files (files compressed with zstd).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <memory>
+
+#include "zstd.h"
+#include "instream.h"
+
+namespace JASS
+	{
+	/*
+		CLASS INSTREAM_ZSTD
+		-------------------
+	*/
+	/*!
+		@brief Subclass of instream for reading from .zst files (files compressed with zstd).
+		@details Files made of several concatenated zstd frames (as produced by "zstd -T0" and by "cat a.zst b.zst") are decoded as one stream.
+		See compress_general_zstd for the matching compressor.
+	*/
+	class instream_zstd : public instream
+		{
+		private:
+			static const size_t buffer_length = (10 * 1024 * 1024);	///< size of the internal buffer
+
+		private:
+			ZSTD_DStream *stream;												///< The zstd stream processing data structure
+			ZSTD_inBuffer input;													///< The part of buffer that has not yet been decoded
+			std::unique_ptr<uint8_t []> buffer;								///< Internal buffer of compressed data read from the source
+			bool source_eof;														///< The source has been read to the end.
+
+		public:
+			/*
+				INSTREAM_ZSTD::INSTREAM_ZSTD()
+				------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param source [in] The instream to read the compressed data from
+			*/
+			instream_zstd(std::shared_ptr<instream> &source);
+
+			/*
+				INSTREAM_ZSTD::~INSTREAM_ZSTD()
+				-------------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~instream_zstd();
+
+			/*
+				INSTREAM_ZSTD::READ()
+				---------------------
+			*/
+			/*!
+				@brief Read buffer.contents.size() bytes of data into buffer.contents, resizing on eof.
+				@param buffer [out] buffer.contents.size() bytes of data are read from source into buffer which is resized to the number of bytes read on eof.
+			*/
+			virtual void read(document &buffer);
+
+			/*
+				INSTREAM_ZSTD::UNITTEST()
+				-------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
@@ -21,11 +21,15 @@
 	QUERY_BUCKETS uses the bucket apprach to the top-k, the alternative is the query_heap
 	QUERY_MAXBLOCK uses the max-block approach to the top-k, the alternative is the query_heap
 	QUERY_MAXBLOCK_HEAP uses the max-block approach to the top-k (in a heap), the alternative is the query_heap
+	QUERY_HEAP_OVERFLOW uses the heap with 8-bit accumulators that overflow into a 16-bit side table (so rsvs are 16-bit and exact)
+	QUERY_HISTOGRAM uses a histogram of the rsvs to find the top-k by counting, the alternative is the query_heap
 */
 //#define QUERY_HEAP
 //#define QUERY_BUCKETS
 //#define QUERY_MAXBLOCK
 //#define QUERY_MAXBLOCK_HEAP
+//#define QUERY_HEAP_OVERFLOW
+//#define QUERY_HISTOGRAM
 
 /*
 	Which accmulator allocator strategy to use
@@ -130,11 +134,17 @@ namespace JASS
 //			typedef uint16_t ACCUMULATOR_TYPE;									///< the type of an accumulator (probably a uint16_t)
 			typedef uint8_t ACCUMULATOR_TYPE;									///< the type of an accumulator (probably a uint16_t)
 			typedef uint32_t DOCID_TYPE;										///< the type of a document id (from a compressor)
+			typedef uint16_t RSV_TYPE;											///< the type of an rsv (at least as wide as an accumulator, wider if accumulators can overflow, see query_heap_overflow)
 
 		public:
 			static constexpr size_t MAX_DOCUMENTS = 155000000;					///< the maximum number of documents an index can hold
 			static constexpr size_t MAX_TOP_K = 1000;							///< the maximum top-k value
-			static constexpr size_t MAX_RSV = (std::numeric_limits<ACCUMULATOR_TYPE>::max)();
+#ifdef QUERY_HEAP_OVERFLOW
+			static constexpr size_t MAX_RSV = (std::numeric_limits<RSV_TYPE>::max)();				///< the largest rsv the top-k manager can hold
+#else
+			static constexpr size_t MAX_RSV = (std::numeric_limits<ACCUMULATOR_TYPE>::max)();	///< the largest rsv the top-k manager can hold
+#endif
+			static_assert(sizeof(RSV_TYPE) >= sizeof(ACCUMULATOR_TYPE), "An rsv must be at least as wide as an accumulator");
 
 		public:
 			/*
@@ -149,7 +159,7 @@ namespace JASS
 				public:
 					size_t document_id;							///< The document identifier
 					const std::string &primary_key;			///< The external identifier of the document (the primary key)
-					ACCUMULATOR_TYPE rsv;						///< The rsv (Retrieval Status Value) relevance score
+					RSV_TYPE rsv;									///< The rsv (Retrieval Status Value) relevance score
 
 				public:
 					/*
@@ -162,7 +172,7 @@ namespace JASS
 						@param key [in] The external identifier of the document (the primary key).
 						@param rsv [in] The rsv (Retrieval Status Value) relevance score.
 					*/
-					docid_rsv_pair(size_t document_id, const std::string &key, ACCUMULATOR_TYPE rsv) :
+					docid_rsv_pair(size_t document_id, const std::string &key, RSV_TYPE rsv) :
 						document_id(document_id),
 						primary_key(key),
 						rsv(rsv)
@@ -174,7 +184,7 @@ namespace JASS
 		protected:
 			__m512i impacts512;															///< The impact score to be added on a call to add_rsv()
 			__m256i impacts256;															///< The impact score to be added on a call to add_rsv()
-			ACCUMULATOR_TYPE impact;													///< The impact score to be added on a call to add_rsv()
+			RSV_TYPE impact;																///< The impact score to be added on a call to add_rsv()
 			DOCID_TYPE d1_cumulative_sum;												///<< The current cumulative sum from d1 decoding
 
 			allocator_pool memory;														///< All memory allocation happens in this "arena"
@@ -281,7 +291,7 @@ namespace JASS
 				@param top_k_lower_bound [in] No rsv smaller than this can enter the top-k results list
 				@param largest_possible_rsv [in] No rsv can be larger than this (but need no one need be this large)
 			*/
-			virtual void rewind(ACCUMULATOR_TYPE smallest_possible_rsv = 0, ACCUMULATOR_TYPE top_k_lower_bound = 0, ACCUMULATOR_TYPE largest_possible_rsv = 0)
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 0, RSV_TYPE largest_possible_rsv = 0)
 				{
 				delete parsed_query;
 				parsed_query = new query_term_list;
@@ -289,6 +299,21 @@ namespace JASS
 				impact = 0;
 				}
 
+			/*
+				QUERY::EXPECT_DOCUMENTS()
+				-------------------------
+			*/
+			/*!
+				@brief Tell this object the most documents the next query can touch (call before rewind()).
+				@details Classes that can keep the accumulators in a smaller structure when few documents are touched (see
+				query_heap_clean) use this to choose, the others ignore it.  It applies to the next rewind() only.
+				@param documents [in] An upper bound on the number of different documents add_rsv() will be called with.
+			*/
+			virtual void expect_documents(size_t documents)
+				{
+				/* Nothing */
+				}
+
 			/*
 				QUERY::SET_IMPACT()
 				-------------------
@@ -297,7 +322,7 @@ namespace JASS
 				@brief Set the impact score to use in a push_back().
 				@param score [in] The impact score to be added to accumulators.
 			*/
-			forceinline void set_impact(ACCUMULATOR_TYPE score)
+			forceinline void set_impact(RSV_TYPE score)
 				{
 				impact = score;
 #ifdef SIMD_JASS
@@ -332,7 +357,7 @@ namespace JASS
 				@param compressed [in] The compressed sequence.
 				@param compressed_size [in] The length of the compressed sequence.
 			*/
-			forceinline void decode_and_process(ACCUMULATOR_TYPE impact, size_t integers, const void *compressed, size_t compressed_size)
+			forceinline void decode_and_process(RSV_TYPE impact, size_t integers, const void *compressed, size_t compressed_size)
 				{
 				set_impact(impact);
 				init_add_rsv();
@@ -315,6 +315,33 @@ namespace JASS
 				return reverse_iterator(*this, -1);
 				}
 
+			/*
+				QUERY_BUCKET::SIZE()
+				--------------------
+			*/
+			/*!
+				@brief Return the number of documents known to be in the top-k
+				@details The top-k is not known until sort() so this is always 0, which means early termination on the Oracle lower bound never happens.
+				@return 0
+			*/
+			query::DOCID_TYPE size(void)
+				{
+				return 0;
+				}
+
+			/*
+				QUERY_BUCKET::TOP_UP()
+				----------------------
+			*/
+			/*!
+				@brief Top-up the top-k after early termination on the Oracle lower bound
+				@details The Oracle lower bound is not used by this class so there is nothing to do.
+			*/
+			void top_up(void)
+				{
+				/* Nothing */
+				}
+
 			/*
 				QUERY_BUCKET::REWIND()
 				----------------------
@@ -323,7 +350,7 @@ namespace JASS
 				@brief Clear this object after use and ready for re-use
 				@param largest_possible_rsv [in] the largest possible rsv value (or larger that that)
 			*/
-			virtual void rewind(ACCUMULATOR_TYPE smallest_possible_rsv = 0, ACCUMULATOR_TYPE top_k_lower_bound = 0,ACCUMULATOR_TYPE largest_possible_rsv = 0)
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 0, RSV_TYPE largest_possible_rsv = 0)
 				{
 				smallest_used_bucket = smallest_possible_rsv;
 				largest_used_bucket = largest_possible_rsv;
@@ -387,7 +414,10 @@ namespace JASS
 					std::sort(sorted_accumulators, sorted_accumulators + accumulators_used);
 	#elif defined(AVX512_SORT)
 // NOT CHECKED
-					Sort512_uint64_t::Sort(sorted_accumulators, accumulators_used);
+					if (simd::get_simd_level() >= hardware_support::avx512)
+						Sort512_uint64_t::Sort(sorted_accumulators, accumulators_used);
+					else
+						std::sort(sorted_accumulators, sorted_accumulators + accumulators_used);
 	#endif
 #else
 					/*
@@ -676,7 +706,7 @@ namespace JASS
 				/*
 					D1-decode inplace with SIMD instructions then process one at a time
 				*/
-				simd::cumulative_sum_256(buffer, integers);
+				simd::cumulative_sum(buffer, integers);
 
 				/*
 					Process the d1-decoded postings list.
@@ -12,6 +12,10 @@
 */
 #pragma once
 
+#include <memory>
+#include <random>
+#include <sstream>
+
 #include "beap.h"
 #include "heap.h"
 #include "simd.h"
@@ -296,7 +300,7 @@ namespace JASS
 			/*!
 				@brief Clear this object after use and ready for re-use
 			*/
-			virtual void rewind(ACCUMULATOR_TYPE smallest_possible_rsv = 0, ACCUMULATOR_TYPE top_k_lower_bound = 0, ACCUMULATOR_TYPE largest_possible_rsv = 0)
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 0, RSV_TYPE largest_possible_rsv = 0)
 				{
 				sorted = false;
 #ifdef ACCUMULATOR_64s
@@ -339,7 +343,10 @@ namespace JASS
 					std::sort(sorted_accumulators + needed_for_top_k, sorted_accumulators + top_k);
 	#elif defined(AVX512_SORT)
 					// CHECKED
-					Sort512_uint64_t::Sort(sorted_accumulators + needed_for_top_k, top_k - needed_for_top_k);
+					if (simd::get_simd_level() >= hardware_support::avx512)
+						Sort512_uint64_t::Sort(sorted_accumulators + needed_for_top_k, top_k - needed_for_top_k);
+					else
+						std::sort(sorted_accumulators + needed_for_top_k, sorted_accumulators + top_k);
 	#endif
 #else
 	#ifdef JASS_TOPK_SORT
@@ -697,6 +704,130 @@ namespace JASS
 #endif
 				}
 #endif
+			/*
+				QUERY_HEAP::HEAP_MINIMUM()
+				--------------------------
+			*/
+			/*!
+				@brief Return the rsv at the bottom of the heap (0 until the heap is full).
+				@details A document whose rsv is less than this cannot enter the top-k, one whose rsv is equal to it might (on the tie break).
+				@return The smallest rsv in the heap.
+			*/
+			forceinline uint32_t heap_minimum(void) const
+				{
+#ifdef ACCUMULATOR_64s
+				return static_cast<uint32_t>(sorted_accumulators[0] >> 32);
+#else
+				return *accumulator_pointers[0];
+#endif
+				}
+
+			/*
+				QUERY_HEAP::ADD_RSV_256()
+				-------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents, 8 at a time, using AVX2 instructions.
+				@details AVX2 has no conflict detection so a block is only done in SIMD if its document ids are strictly increasing (so unique), as
+				they are in a postings list.  Blocks with a repeat, or with a document that might enter the top-k, are done one document at a time.
+				@param document_ids [in] The documents to increment.
+				@param end [in] The end of the list of documents.
+				@param score [in] The amount of weight to add to each.
+				@return A pointer to the first document not processed (fewer than 8 from end).
+			*/
+			const DOCID_TYPE *add_rsv_256(const DOCID_TYPE *document_ids, const DOCID_TYPE *end, ACCUMULATOR_TYPE score)
+				{
+				const __m256i scores = _mm256_set1_epi32(score);
+				const __m256i previous_lane = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+
+				for (; end - document_ids >= 8; document_ids += 8)
+					{
+					__m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(document_ids));
+					uint32_t increasing = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ids, _mm256_permutevar8x32_epi32(ids, previous_lane)))) | 0x01;
+
+					__m256i values = _mm256_add_epi32(accumulators[ids], scores);			// clean any dirty rows and gather() the rsv values
+					uint32_t below_heap = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(heap_minimum()), values)));
+
+					if ((increasing & below_heap) == 0xFF)
+						accumulators.scatter(ids, values);
+					else
+						for (size_t which = 0; which < 8; which++)
+							add_rsv(document_ids[which], score);
+					}
+
+				return document_ids;
+				}
+
+			/*
+				QUERY_HEAP::ADD_RSV_512()
+				-------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents, 16 at a time, using AVX-512 instructions.
+				@details Blocks with a repeated document id (found with the conflict detection instruction), or with a document that might enter the
+				top-k, are done one document at a time.
+				@param document_ids [in] The documents to increment.
+				@param end [in] The end of the list of documents.
+				@param score [in] The amount of weight to add to each.
+				@return A pointer to the first document not processed (fewer than 16 from end).
+			*/
+			JASS_TARGET_AVX512 const DOCID_TYPE *add_rsv_512(const DOCID_TYPE *document_ids, const DOCID_TYPE *end, ACCUMULATOR_TYPE score)
+				{
+				const __m512i scores = _mm512_set1_epi32(score);
+				const __m512i previous_lane = _mm512_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+
+				for (; end - document_ids >= 16; document_ids += 16)
+					{
+					/*
+						Postings lists are strictly increasing so check that first as the conflict detection instruction is slow.
+					*/
+					__m512i ids = _mm512_loadu_si512(document_ids);
+					__mmask16 repeats = 0;
+					if ((_mm512_cmpgt_epu32_mask(ids, _mm512_permutexvar_epi32(previous_lane, ids)) | 0x01) != 0xFFFF)
+						{
+						__m512i conflict = _mm512_conflict_epi32(ids);
+						repeats = _mm512_test_epi32_mask(conflict, conflict);
+						}
+
+					__m512i values = _mm512_add_epi32(accumulators[ids], scores);			// clean any dirty rows and gather() the rsv values
+					__mmask16 in_heap = _mm512_cmpge_epi32_mask(values, _mm512_set1_epi32(heap_minimum()));
+
+					if ((repeats | in_heap) == 0)
+						accumulators.scatter(ids, values);
+					else
+						for (size_t which = 0; which < 16; which++)
+							add_rsv(document_ids[which], score);
+					}
+
+				return document_ids;
+				}
+
+			/*
+				QUERY_HEAP::ADD_RSV()
+				---------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents
+				@details The documents are done a block at a time (using the best instruction set, see simd::get_simd_level()), cleaning the
+				dirty accumulators, gathering, adding, and comparing to the bottom of the heap all at once.  Blocks where a document might
+				enter the top-k are done one document at a time, as is the tail of the list.
+				@param document_ids [in] The documents to increment.
+				@param integers [in] The number of documents in document_ids.
+				@param score [in] The amount of weight to add to each.
+			*/
+			forceinline void add_rsv(const DOCID_TYPE *document_ids, size_t integers, ACCUMULATOR_TYPE score)
+				{
+				const DOCID_TYPE *end = document_ids + integers;
+
+				if (simd::get_simd_level() >= hardware_support::avx512)
+					document_ids = add_rsv_512(document_ids, end, score);
+				else if (simd::get_simd_level() >= hardware_support::avx2)
+					document_ids = add_rsv_256(document_ids, end, score);
+
+				while (document_ids < end)
+					add_rsv(*document_ids++, score);
+				}
+
 			/*
 				QUERY_HEAP::DECODE_WITH_WRITER()
 				--------------------------------
@@ -724,7 +855,7 @@ namespace JASS
 				/*
 					D1-decode inplace with SIMD instructions then process one at a time
 				*/
-				simd::cumulative_sum_256(buffer, integers);
+				simd::cumulative_sum(buffer, integers);
 
 				/*
 					Process the d1-decoded postings list.
@@ -772,6 +903,60 @@ namespace JASS
 					}
 				}
 
+			/*
+				QUERY_HEAP::UNITTEST_BATCH_ADD_RSV()
+				------------------------------------
+			*/
+			/*!
+				@brief Check that the batch add_rsv() gives the same results as adding one document at a time, at each SIMD level
+			*/
+			static void unittest_batch_add_rsv(void)
+				{
+				std::vector<std::string> keys(1024);
+				std::mt19937 random(1);
+				auto previous_level = simd::get_simd_level();
+
+				for (auto level : {hardware_support::scalar, hardware_support::avx2, hardware_support::avx512})
+					{
+					simd::set_simd_level(level);
+					auto one_at_a_time = std::make_unique<query_heap>();
+					auto batched = std::make_unique<query_heap>();
+					one_at_a_time->init(keys, 1024, 10);
+					batched->init(keys, 1024, 10);
+
+					for (size_t list = 0; list < 20; list++)
+						{
+						/*
+							A postings list (strictly increasing), but every third list is shuffled and has repeats to check the conflict detection.
+						*/
+						std::vector<DOCID_TYPE> postings;
+						for (DOCID_TYPE document_id = 1; document_id < 1024; document_id++)
+							if (random() % 8 == 0)
+								postings.push_back(document_id);
+						if (list % 3 == 2)
+							{
+							postings.insert(postings.end(), postings.begin(), postings.begin() + postings.size() / 2);
+							std::shuffle(postings.begin(), postings.end(), random);
+							}
+
+						ACCUMULATOR_TYPE score = 1 + random() % 5;
+						for (const auto document_id : postings)
+							one_at_a_time->add_rsv(document_id, score);
+						batched->add_rsv(postings.data(), postings.size(), score);
+						}
+
+					std::ostringstream expected;
+					std::ostringstream got;
+					for (const auto rsv : *one_at_a_time)
+						expected << "<" << (uint64_t)rsv.document_id << "," << (uint64_t)rsv.rsv << ">";
+					for (const auto rsv : *batched)
+						got << "<" << (uint64_t)rsv.document_id << "," << (uint64_t)rsv.rsv << ">";
+					JASS_assert(expected.str() == got.str());
+					}
+
+				simd::set_simd_level(previous_level);
+				}
+
 			/*
 				QUERY_HEAP::UNITTEST()
 				----------------------
@@ -815,6 +1000,8 @@ namespace JASS
 						JASS_assert(term.token() == "three");
 					}
 
+				unittest_batch_add_rsv();
+
 				puts("query_heap::PASSED");
 				}
 		};
@@ -12,12 +12,17 @@
 */
 #pragma once
 
+#include <limits>
+#include <memory>
+#include <random>
+
 #include "beap.h"
 #include "heap.h"
 #include "simd.h"
 #include "query.h"
 #include "pointer_box.h"
 #include "accumulator_2d.h"
+#include "accumulator_sparse.h"
 #include "exception_done.h"
 #include "sort512_uint64_t.h"
 #include "accumulator_counter.h"
@@ -31,6 +36,9 @@ namespace JASS
 	*/
 	/*!
 		@brief Everything necessary to process a query (using a heap) is encapsulated in an object of this type
+		@details If expect_documents() says the next query touches few documents then the accumulators are kept in an
+		accumulator_sparse hash table rather than the accumulator_2d (whose costs are proportional to the collection).  In that case
+		rsv ties are broken on position in the table rather than on document id.
 	*/
 	class query_heap_clean : public query
 		{
@@ -106,8 +114,9 @@ namespace JASS
 					*/
 					docid_rsv_pair operator*()
 						{
-						size_t id = parent.accumulators.get_index(parent.accumulator_pointers[where].pointer());
-						return docid_rsv_pair(id, (*parent.primary_keys)[id], parent.accumulators.get_value(id));
+						ACCUMULATOR_TYPE *pointer = parent.accumulator_pointers[where].pointer();
+						size_t id = parent.sparse ? parent.sparse_accumulators.get_index(pointer) : parent.accumulators.get_index(pointer);
+						return docid_rsv_pair(id, (*parent.primary_keys)[id], *pointer);
 						}
 					};
 
@@ -137,8 +146,14 @@ namespace JASS
 						}
 				};
 
+		private:
+			static constexpr size_t sparse_fraction = 64;							///< A query that touches fewer than one in this many documents uses sparse_accumulators
+
 		private:
 			accumulator_2d<ACCUMULATOR_TYPE, MAX_DOCUMENTS> accumulators;	///< The accumulators, one per document in the collection
+			accumulator_sparse<ACCUMULATOR_TYPE> sparse_accumulators;		///< The accumulators for queries that touch few documents
+			bool sparse;																	///< This query is using sparse_accumulators rather than accumulators
+			size_t expected_documents;													///< The value passed to expect_documents() for the next query
 			size_t needed_for_top_k;													///< The number of results we still need in order to fill the top-k
 			ACCUMULATOR_TYPE zero;														///< Constant zero used for pointer dereferenced comparisons
 			accumulator_pointer accumulator_pointers[MAX_TOP_K];				///< Array of pointers to the top k accumulators
@@ -156,6 +171,8 @@ namespace JASS
 			*/
 			query_heap_clean() :
 				query(),
+				sparse(false),
+				expected_documents((std::numeric_limits<size_t>::max)()),
 				zero(0),
 				top_results(accumulator_pointers, top_k)
 				{
@@ -188,6 +205,7 @@ namespace JASS
 				{
 				query::init(primary_keys, documents, top_k);
 				accumulators.init(documents, width);
+				sparse_accumulators.init(documents / sparse_fraction);
 				top_results.set_top_k(top_k);
 				}
 
@@ -261,17 +279,36 @@ namespace JASS
 			/*!
 				@brief Clear this object after use and ready for re-use
 			*/
-			virtual void rewind(ACCUMULATOR_TYPE smallest_possible_rsv = 0, ACCUMULATOR_TYPE top_k_lower_bound = 1, ACCUMULATOR_TYPE largest_possible_rsv = 0)
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 1, RSV_TYPE largest_possible_rsv = 0)
 				{
 				sorted = false;
 				zero = 0;
 				accumulator_pointers[0] = &zero;
-				accumulators.rewind();
+				sparse = expected_documents <= sparse_accumulators.maximum_documents;
+				if (sparse)
+					sparse_accumulators.rewind(expected_documents);
+				else
+					accumulators.rewind();
+				expected_documents = (std::numeric_limits<size_t>::max)();
 				needed_for_top_k = this->top_k;
 				this->top_k_lower_bound = top_k_lower_bound;
 				query::rewind(largest_possible_rsv);
 				}
 
+			/*
+				QUERY_HEAP_CLEAN::EXPECT_DOCUMENTS()
+				------------------------------------
+			*/
+			/*!
+				@brief Tell this object the most documents the next query can touch (call before rewind()).
+				@details If this is fewer than one in sparse_fraction of the collection then the next query uses sparse_accumulators.
+				@param documents [in] An upper bound on the number of different documents add_rsv() will be called with.
+			*/
+			virtual void expect_documents(size_t documents)
+				{
+				expected_documents = documents;
+				}
+
 			/*
 				QUERY_HEAP_CLEAN::SORT()
 				------------------------
@@ -299,7 +336,7 @@ namespace JASS
 			*/
 			forceinline void add_rsv(DOCID_TYPE document_id, ACCUMULATOR_TYPE score)
 				{
-				accumulator_pointer which = &accumulators[document_id];			/* This will create the accumulator if it doesn't already exist. */
+				accumulator_pointer which = sparse ? &sparse_accumulators[document_id] : &accumulators[document_id];			/* This will create the accumulator if it doesn't already exist. */
 				*which.pointer() += score;
 				/*
 					accumulator is less than the heap entry value
@@ -368,6 +405,115 @@ namespace JASS
 				add_rsv(document_id, impact);
 				}
 
+			/*
+				QUERY_HEAP_CLEAN::ADD_RSV_256()
+				-------------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents, 8 at a time, using AVX2 instructions.
+				@details AVX2 has no conflict detection so a block is only done in SIMD if its document ids are strictly increasing (so unique), as
+				they are in a postings list.  Blocks with a repeat, or with a document that reaches top_k_lower_bound, are done one document at a time.
+				@param document_ids [in] The documents to increment.
+				@param end [in] The end of the list of documents.
+				@param score [in] The amount of weight to add to each.
+				@return A pointer to the first document not processed (fewer than 8 from end).
+			*/
+			const DOCID_TYPE *add_rsv_256(const DOCID_TYPE *document_ids, const DOCID_TYPE *end, ACCUMULATOR_TYPE score)
+				{
+				const __m256i scores = _mm256_set1_epi32(score);
+				const __m256i previous_lane = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+
+				for (; end - document_ids >= 8; document_ids += 8)
+					{
+					__m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(document_ids));
+					uint32_t increasing = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ids, _mm256_permutevar8x32_epi32(ids, previous_lane)))) | 0x01;
+
+					__m256i values = _mm256_add_epi32(accumulators[ids], scores);			// clean any dirty rows and gather() the rsv values
+					uint32_t below_bound = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(top_k_lower_bound), values)));
+
+					if ((increasing & below_bound) == 0xFF)
+						accumulators.scatter(ids, values);
+					else
+						for (size_t which = 0; which < 8; which++)
+							add_rsv(document_ids[which], score);
+					}
+
+				return document_ids;
+				}
+
+			/*
+				QUERY_HEAP_CLEAN::ADD_RSV_512()
+				-------------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents, 16 at a time, using AVX-512 instructions.
+				@details Blocks with a repeated document id (found with the conflict detection instruction), or with a document that reaches
+				top_k_lower_bound, are done one document at a time.
+				@param document_ids [in] The documents to increment.
+				@param end [in] The end of the list of documents.
+				@param score [in] The amount of weight to add to each.
+				@return A pointer to the first document not processed (fewer than 16 from end).
+			*/
+			JASS_TARGET_AVX512 const DOCID_TYPE *add_rsv_512(const DOCID_TYPE *document_ids, const DOCID_TYPE *end, ACCUMULATOR_TYPE score)
+				{
+				const __m512i scores = _mm512_set1_epi32(score);
+				const __m512i previous_lane = _mm512_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14);
+
+				for (; end - document_ids >= 16; document_ids += 16)
+					{
+					/*
+						Postings lists are strictly increasing so check that first as the conflict detection instruction is slow.
+					*/
+					__m512i ids = _mm512_loadu_si512(document_ids);
+					__mmask16 repeats = 0;
+					if ((_mm512_cmpgt_epu32_mask(ids, _mm512_permutexvar_epi32(previous_lane, ids)) | 0x01) != 0xFFFF)
+						{
+						__m512i conflict = _mm512_conflict_epi32(ids);
+						repeats = _mm512_test_epi32_mask(conflict, conflict);
+						}
+
+					__m512i values = _mm512_add_epi32(accumulators[ids], scores);			// clean any dirty rows and gather() the rsv values
+					__mmask16 reaches_bound = _mm512_cmpge_epi32_mask(values, _mm512_set1_epi32(top_k_lower_bound));
+
+					if ((repeats | reaches_bound) == 0)
+						accumulators.scatter(ids, values);
+					else
+						for (size_t which = 0; which < 16; which++)
+							add_rsv(document_ids[which], score);
+					}
+
+				return document_ids;
+				}
+
+			/*
+				QUERY_HEAP_CLEAN::ADD_RSV()
+				---------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of each document in a list of documents
+				@details The documents are done a block at a time (using the best instruction set, see simd::get_simd_level()), cleaning the
+				dirty accumulators, gathering, adding, and comparing to top_k_lower_bound all at once.  Blocks where a document reaches
+				top_k_lower_bound are done one document at a time, as is the tail of the list.
+				@param document_ids [in] The documents to increment.
+				@param integers [in] The number of documents in document_ids.
+				@param score [in] The amount of weight to add to each.
+			*/
+			forceinline void add_rsv(const DOCID_TYPE *document_ids, size_t integers, ACCUMULATOR_TYPE score)
+				{
+				const DOCID_TYPE *end = document_ids + integers;
+
+				if (!sparse)		// the vector code works on the accumulator_2d
+					{
+					if (simd::get_simd_level() >= hardware_support::avx512)
+						document_ids = add_rsv_512(document_ids, end, score);
+					else if (simd::get_simd_level() >= hardware_support::avx2)
+						document_ids = add_rsv_256(document_ids, end, score);
+					}
+
+				while (document_ids < end)
+					add_rsv(*document_ids++, score);
+				}
+
 			/*
 				QUERY_HEAP_CLEAN::DECODE_WITH_WRITER()
 				--------------------------------------
@@ -386,27 +532,19 @@ namespace JASS
 				/*
 					D1-decode inplace with SIMD instructions then process one at a time
 				*/
-				simd::cumulative_sum_256(buffer, integers);
+				simd::cumulative_sum(buffer, integers);
 
 				/*
-					Process the d1-decoded postings list.  We ask the compiler to unroll the loop as it
-					appears to be as fast as manually unrolling it.
+					Process the d1-decoded postings list a vector at a time.
 				*/
-				const DOCID_TYPE *end = buffer + integers;
-#if defined(__clang__)
-				#pragma unroll 8
-#elif defined(__GNUC__) || defined(__GNUG__)
-				#pragma GCC unroll 8
-#endif
-				for (DOCID_TYPE *current = buffer; current < end; current++)
-					try
-						{
-						add_rsv(*current, impact);
-						}
-					catch (Done&)
-						{
-						break;
-						}
+				try
+					{
+					add_rsv(buffer, integers, impact);
+					}
+				catch (Done&)
+					{
+					/* Nothing */
+					}
 				}
 
 			/*
@@ -435,6 +573,45 @@ namespace JASS
 					}
 				}
 
+			/*
+				QUERY_HEAP_CLEAN::TOP_UP_WITH()
+				-------------------------------
+			*/
+			/*!
+				@brief Add an accumulator to the top-k during top_up() if it should be there and isn't already.
+				@param which [in] The accumulator.
+				@param heap_entry_point [in/out] The lowest rsv that can enter the heap (updated as the heap changes).
+			*/
+			forceinline void top_up_with(ACCUMULATOR_TYPE *which, ACCUMULATOR_TYPE &heap_entry_point)
+				{
+				/*
+					Any score greater than or equal to top_k_lower_bound is already in the heap
+				*/
+				if (*which >= heap_entry_point && *which < top_k_lower_bound)
+					{
+					/*
+						Insert into the heap
+					*/
+					if (needed_for_top_k > 0)
+						{
+						/*
+							The heap isn't full yet - so put this accumulator into the heap
+						*/
+						accumulator_pointers[--needed_for_top_k] = which;
+						if (needed_for_top_k == 0)
+							{
+							top_results.make_heap();							// We've filled the heap so build it
+							heap_entry_point = *accumulator_pointers[0];		// set the new bottom of heap value
+							}
+						}
+					else
+						{
+						top_results.push_back(which);							// we're not in the heap so add this accumulator to the heap
+						heap_entry_point = *accumulator_pointers[0];			// set the new bottom of heap value
+						}
+					}
+				}
+
 			/*
 				QUERY_HEAP_CLEAN::TOP_UP()
 				--------------------------
@@ -453,9 +630,14 @@ namespace JASS
 				*/
 				ACCUMULATOR_TYPE heap_entry_point = *accumulator_pointers[0] == 0 ? 1 : *accumulator_pointers[0];
 
-				/*
-					Any score greater than or equal to top_k_lower_bound is already in the heap
-				*/
+				if (sparse)
+					{
+					for (size_t slot = 0; slot < sparse_accumulators.slots; slot++)
+						if (sparse_accumulators.is_used(slot))
+							top_up_with(&sparse_accumulators.accumulator[slot], heap_entry_point);
+					return;
+					}
+
 				for (size_t page = 0; page < accumulators.number_of_dirty_flags; page++)
 					{
 					/*
@@ -467,32 +649,7 @@ namespace JASS
 						size_t from = page << accumulators.shift;
 						size_t to = (page + 1) << accumulators.shift;
 						for (; from < to; from++)
-							{
-							auto which = &accumulators.accumulator[from];
-							if (*which >= heap_entry_point && *which < top_k_lower_bound)
-								{
-								/*
-									Insert into the heap
-								*/
-								if (needed_for_top_k > 0)
-									{
-									/*
-										The heap isn't full yet - so put this accumulator into the heap
-									*/
-									accumulator_pointers[--needed_for_top_k] = which;
-									if (needed_for_top_k == 0)
-										{
-										top_results.make_heap();							// We've filled the heap so build it
-										heap_entry_point = *accumulator_pointers[0];		// set the new bottom of heap value
-										}
-									}
-								else
-									{
-									top_results.push_back(which);							// we're not in the heap so add this accumulator to the heap
-									heap_entry_point = *accumulator_pointers[0];			// set the new bottom of heap value
-									}
-								}
-							}
+							top_up_with(&accumulators.accumulator[from], heap_entry_point);
 						}
 					}
 				}
@@ -539,8 +696,58 @@ namespace JASS
 					else if (times == 3)
 						JASS_assert(term.token() == "three");
 					}
+				delete query_object;
+
+				/*
+					Check the sparse accumulators give the same results as the 2D accumulators (other than the order of ties), with and without top_up()
+				*/
+				std::vector<std::string> many_keys(100'000);
+				auto dense = std::make_unique<query_heap_clean>();
+				auto sparse = std::make_unique<query_heap_clean>();
+				dense->init(many_keys, 100'000, 10);
+				sparse->init(many_keys, 100'000, 10);
+
+				std::mt19937 random(7);
+				std::vector<DOCID_TYPE> documents(400);
+				std::vector<uint32_t> exact(100'000);
+				for (bool oracle : {false, true})
+					{
+					dense->rewind(0, oracle ? 250 : 1, 255);
+					sparse->expect_documents(documents.size());
+					sparse->rewind(0, oracle ? 250 : 1, 255);
+					JASS_assert(sparse->sparse && !dense->sparse);
+
+					for (auto &document_id : documents)
+						document_id = random() % 100'000;
+					std::fill(exact.begin(), exact.end(), 0);
+					for (size_t posting = 0; posting < 1000; posting++)
+						{
+						DOCID_TYPE document_id = documents[random() % documents.size()];
+						ACCUMULATOR_TYPE score = random() % 5 + 1;
+						dense->add_rsv(document_id, score);
+						sparse->add_rsv(document_id, score);
+						exact[document_id] += score;
+						}
+					if (oracle)
+						{
+						dense->top_up();
+						sparse->top_up();
+						}
+
+					std::vector<RSV_TYPE> dense_rsvs;
+					std::vector<RSV_TYPE> sparse_rsvs;
+					for (const auto rsv : *dense)
+						dense_rsvs.push_back(rsv.rsv);
+					for (const auto rsv : *sparse)
+						{
+						JASS_assert(rsv.rsv == exact[rsv.document_id]);
+						sparse_rsvs.push_back(rsv.rsv);
+						}
+					JASS_assert(dense_rsvs.size() == 10);
+					JASS_assert(dense_rsvs == sparse_rsvs);
+					}
 
-				puts("query_heap::PASSED");
+				puts("query_heap_clean::PASSED");
 				}
 		};
 	}
@@ -0,0 +1,662 @@
+/*
+	QUERY_HEAP_OVERFLOW.H
+	---------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Process a query using a heap for the top-k and 8-bit accumulators that overflow into a 16-bit side table.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <algorithm>
+
+#include "heap.h"
+#include "simd.h"
+#include "query.h"
+#include "accumulator_2d.h"
+#include "exception_done.h"
+
+namespace JASS
+	{
+	/*
+		CLASS QUERY_HEAP_OVERFLOW
+		-------------------------
+	*/
+	/*!
+		@brief Everything necessary to process a query (using a heap) with accumulators that overflow is encapsulated in an object of this type
+		@details The accumulators are 8-bit (ACCUMULATOR_TYPE) so that as many as possible fit in cache, but the rsvs are 16-bit (RSV_TYPE).
+		When a document's rsv reaches the largest value an accumulator can hold, the accumulator is set to that value (the promotion
+		marker) and from then on the rsv is held in a 16-bit side table.  The side table is a second set of 2D accumulators so only
+		the rows containing promoted documents are ever cleaned or touched.  Long queries are, therefore, scored exactly rather
+		than having their impact scores rescaled to fit in 8 bits.  The top-k is a heap of 64-bit keys (rsv << 32 | document id)
+		which breaks ties on document id in the same way query_heap_clean breaks ties on pointers.
+	*/
+	class query_heap_overflow : public query
+		{
+		private:
+			static constexpr ACCUMULATOR_TYPE PROMOTED = (std::numeric_limits<ACCUMULATOR_TYPE>::max)();		///< An accumulator with this value has its rsv in the side table
+
+			/*
+				CLASS QUERY_HEAP_OVERFLOW::ITERATOR
+				-----------------------------------
+			*/
+			/*!
+				@brief Iterate over the top-k
+			*/
+			class iterator
+				{
+				public:
+					query_heap_overflow &parent;	///< The query object that this is iterating over
+					int64_t where;						///< Where in the results list we are
+
+				public:
+					/*
+						QUERY_HEAP_OVERFLOW::ITERATOR::ITERATOR()
+						-----------------------------------------
+					*/
+					/*!
+						@brief Constructor
+						@param parent [in] The object we are iterating over
+						@param where [in] Where in the results list this iterator starts
+					*/
+					iterator(query_heap_overflow &parent, size_t where) :
+						parent(parent),
+						where(where)
+						{
+						/* Nothing */
+						}
+
+					/*
+						QUERY_HEAP_OVERFLOW::ITERATOR::OPERATOR!=()
+						-------------------------------------------
+					*/
+					/*!
+						@brief Compare two iterator objects for non-equality.
+						@param with [in] The iterator object to compare to.
+						@return true if they differ, else false.
+					*/
+					bool operator!=(const iterator &with) const
+						{
+						return with.where != where;
+						}
+
+					/*
+						QUERY_HEAP_OVERFLOW::ITERATOR::OPERATOR++()
+						-------------------------------------------
+					*/
+					/*!
+						@brief Increment this iterator.
+					*/
+					virtual iterator &operator++(void)
+						{
+						where++;
+						return *this;
+						}
+
+					/*
+						QUERY_HEAP_OVERFLOW::ITERATOR::OPERATOR*()
+						------------------------------------------
+					*/
+					/*!
+						@brief Return a reference to the <document_id,rsv> pair at the current location.
+						@return The current object.
+					*/
+					docid_rsv_pair operator*()
+						{
+						DOCID_TYPE id = parent.top_k_keys[where] & 0xFFFF'FFFF;
+						RSV_TYPE rsv = parent.top_k_keys[where] >> 32;
+						return docid_rsv_pair(id, (*parent.primary_keys)[id], rsv);
+						}
+					};
+
+			/*
+				CLASS QUERY_HEAP_OVERFLOW::REVERSE_ITERATOR
+				-------------------------------------------
+			*/
+			/*!
+				@brief Reverse iterate over the top-k
+			*/
+			class reverse_iterator : public iterator
+				{
+				public:
+					using iterator::iterator;
+
+					/*
+						QUERY_HEAP_OVERFLOW::REVERSE_ITERATOR::OPERATOR++()
+						---------------------------------------------------
+					*/
+					/*!
+						@brief Increment this iterator.
+					*/
+					virtual iterator &operator++(void)
+						{
+						iterator::where--;
+						return *this;
+						}
+				};
+
+		private:
+			accumulator_2d<ACCUMULATOR_TYPE, MAX_DOCUMENTS> accumulators;	///< The 8-bit accumulators, one per document in the collection
+			accumulator_2d<RSV_TYPE, MAX_DOCUMENTS> overflow;					///< The 16-bit rsvs of the documents whose accumulators have been promoted
+			size_t needed_for_top_k;													///< The number of results we still need in order to fill the top-k
+			uint64_t top_k_keys[MAX_TOP_K];											///< Array of <rsv, document id> keys of the top k documents
+			heap<uint64_t> top_results;												///< Heap containing the top-k results
+			bool sorted;																	///< has heap and top_k_keys been sorted (false after rewind() true after sort())
+			RSV_TYPE top_k_lower_bound;												///< lowest possible score to enter the top k
+			uint32_t fast_path_bound;													///< the smaller of top_k_lower_bound and PROMOTED, below which add_rsv() is only an 8-bit add
+
+		private:
+			/*
+				QUERY_HEAP_OVERFLOW::KEY()
+				--------------------------
+			*/
+			/*!
+				@brief Return the top-k key for a document.
+				@param rsv [in] The rsv of the document.
+				@param document_id [in] The document.
+				@return The key, ordered by rsv then by document id.
+			*/
+			static forceinline uint64_t key(uint32_t rsv, DOCID_TYPE document_id)
+				{
+				return (static_cast<uint64_t>(rsv) << 32) | document_id;
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::HEAP_MINIMUM()
+				-----------------------------------
+			*/
+			/*!
+				@brief Return the rsv at the bottom of the heap.
+				@return The smallest rsv in the heap (0 if the heap is not yet full).
+			*/
+			forceinline RSV_TYPE heap_minimum(void) const
+				{
+				return top_k_keys[0] >> 32;
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::SET_TOP_K_LOWER_BOUND()
+				--------------------------------------------
+			*/
+			/*!
+				@brief Set the lowest score that can enter the top-k.
+				@param bound [in] The new lower bound.
+			*/
+			forceinline void set_top_k_lower_bound(RSV_TYPE bound)
+				{
+				top_k_lower_bound = bound;
+				fast_path_bound = bound < PROMOTED ? bound : PROMOTED;
+				}
+
+		public:
+			/*
+				QUERY_HEAP_OVERFLOW::QUERY_HEAP_OVERFLOW()
+				------------------------------------------
+			*/
+			/*!
+				@brief Constructor
+			*/
+			query_heap_overflow() :
+				query(),
+				top_results(top_k_keys, top_k)
+				{
+				rewind();
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::~QUERY_HEAP_OVERFLOW()
+				-------------------------------------------
+			*/
+			/*!
+				@brief Destructor
+			*/
+			virtual ~query_heap_overflow()
+				{
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::INIT()
+				---------------------------
+			*/
+			/*!
+				@brief Initialise the object. MUST be called before first use.
+				@param primary_keys [in] Vector of the document primary keys used to convert from internal document ids to external primary keys.
+				@param documents [in] The number of documents in the collection.
+				@param top_k [in]	The top-k documents to return from the query once executed.
+				@param width [in] The width of the 2-d accumulators (if they are being used).
+			*/
+			virtual void init(const std::vector<std::string> &primary_keys, DOCID_TYPE documents = 1024, size_t top_k = 10, size_t width = 7)
+				{
+				query::init(primary_keys, documents, top_k);
+				accumulators.init(documents, width);
+				overflow.init(documents, width);
+				top_results.set_top_k(top_k);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::BEGIN()
+				----------------------------
+			*/
+			/*!
+				@brief Return an iterator pointing to start of the top-k
+				@return Iterator pointing to start of the top-k
+			*/
+			auto begin(void)
+				{
+				sort();
+				return iterator(*this, needed_for_top_k);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::END()
+				--------------------------
+			*/
+			/*!
+				@brief Return an iterator pointing to end of the top-k
+				@return Iterator pointing to the end of the top-k
+			*/
+			auto end(void)
+				{
+				return iterator(*this, top_k);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::RBEGIN()
+				-----------------------------
+			*/
+			/*!
+				@brief Return a reverse iterator pointing to start of the top-k
+				@return Iterator pointing to start of the top-k
+			*/
+			auto rbegin(void)
+				{
+				sort();
+				return reverse_iterator(*this, top_k - 1);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::REND()
+				---------------------------
+			*/
+			/*!
+				@brief Return a reverse iterator pointing to end of the top-k
+				@return Iterator pointing to the end of the top-k
+			*/
+			auto rend(void)
+				{
+				return reverse_iterator(*this, needed_for_top_k - 1);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::SIZE()
+				---------------------------
+			*/
+			query::DOCID_TYPE size(void)
+				{
+				return top_k - needed_for_top_k;
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::REWIND()
+				-----------------------------
+			*/
+			/*!
+				@brief Clear this object after use and ready for re-use
+			*/
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 1, RSV_TYPE largest_possible_rsv = 0)
+				{
+				sorted = false;
+				top_k_keys[0] = 0;
+				accumulators.rewind();
+				overflow.rewind();
+				needed_for_top_k = this->top_k;
+				set_top_k_lower_bound(top_k_lower_bound);
+				query::rewind(largest_possible_rsv);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::SORT()
+				---------------------------
+			*/
+			/*!
+				@brief sort this resuls list before iteration over it.
+			*/
+			void sort(void)
+				{
+				if (!sorted)
+					{
+					top_k_qsort::sort(top_k_keys + needed_for_top_k, top_k - needed_for_top_k, top_k);
+					sorted = true;
+					}
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::GET_RSV()
+				------------------------------
+			*/
+			/*!
+				@brief Return the rsv of a document.
+				@param document_id [in] The document.
+				@return The rsv of document_id (0 if it has not been seen in this query).
+			*/
+			RSV_TYPE get_rsv(DOCID_TYPE document_id)
+				{
+				ACCUMULATOR_TYPE value = accumulators.get_value(document_id);
+				return value == PROMOTED ? overflow.get_value(document_id) : value;
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::ADD_RSV_OVERFLOW()
+				---------------------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv of a document that has (or is about to) overflow its accumulator.
+				@param document_id [in] which document to increment
+				@param accumulator [in] The document's accumulator.
+				@param score [in] the amount of weight to add
+				@return The new rsv of the document.
+			*/
+			forceinline uint32_t add_rsv_overflow(DOCID_TYPE document_id, ACCUMULATOR_TYPE &accumulator, RSV_TYPE score)
+				{
+				RSV_TYPE &rsv = overflow[document_id];			/* This will create the side table entry if it doesn't already exist. */
+
+				if (accumulator != PROMOTED)
+					{
+					rsv = accumulator;
+					accumulator = PROMOTED;
+					}
+				rsv += score;
+
+				return rsv;
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::ADD_RSV()
+				------------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv for document document_id
+				@param document_id [in] which document to increment
+				@param score [in] the amount of weight to add
+			*/
+			forceinline void add_rsv(DOCID_TYPE document_id, RSV_TYPE score)
+				{
+				ACCUMULATOR_TYPE &accumulator = accumulators[document_id];			/* This will create the accumulator if it doesn't already exist. */
+				uint32_t new_rsv = accumulator + score;
+
+				/*
+					The usual case is an 8-bit add of a document that does not make the top-k, so a single comparison both checks that
+					the accumulator didn't overflow and that the document doesn't enter the top-k.
+				*/
+				if (new_rsv < fast_path_bound)
+					{
+					accumulator = static_cast<ACCUMULATOR_TYPE>(new_rsv);
+					return;
+					}
+
+				if (new_rsv < PROMOTED)
+					accumulator = static_cast<ACCUMULATOR_TYPE>(new_rsv);
+				else
+					new_rsv = add_rsv_overflow(document_id, accumulator, score);
+
+				/*
+					accumulator is less than the heap entry value
+				*/
+				if (new_rsv < top_k_lower_bound)
+					return;
+
+				uint32_t old_rsv = new_rsv - score;
+				uint64_t new_key = key(new_rsv, document_id);
+				uint64_t old_key = key(old_rsv, document_id);
+
+				/*
+					the heap isn't full yet
+				*/
+				if (needed_for_top_k > 0)
+					{
+					if (old_rsv < top_k_lower_bound)
+						{
+						/*
+							we weren't already in the heap
+						*/
+						top_k_keys[--needed_for_top_k] = new_key;
+						if (needed_for_top_k == 0)
+							{
+							top_results.make_heap();
+							if (top_k_lower_bound != 1)
+								throw Done(); /* We must be using the Oracle, and we must have filled the top-k and so we can stop processing this query. */
+							set_top_k_lower_bound(heap_minimum()); /* set the new bottom of heap value */
+							}
+						}
+					else
+						{
+						/*
+							we were already there so replace our key, a linear search as keys (unlike pointers) change when the rsv does.
+						*/
+						for (uint64_t *check = top_k_keys + needed_for_top_k; check < top_k_keys + top_k; check++)
+							if (*check == old_key)
+								{
+								*check = new_key;
+								break;
+								}
+						}
+					return;
+					}
+
+				/*
+					equal to the heap entry value, but loses the tie-break
+				*/
+				if (new_key < top_k_keys[0])
+					return;
+
+				/*
+					if the old key was below the bottom of the heap we weren't in it, otherwise we were and need to be promoted
+				*/
+				if (old_key < top_k_keys[0])
+					top_results.push_back(new_key);
+				else
+					top_results.promote(new_key, top_results.find(old_key));
+				set_top_k_lower_bound(heap_minimum()); /* set the new bottom of heap value */
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::ADD_RSV_D1()
+				---------------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv for document docuument_id
+				@param document_id [in] which document to increment
+			*/
+			forceinline void add_rsv_d1(DOCID_TYPE document_id)
+				{
+				document_id += d1_cumulative_sum;
+				d1_cumulative_sum = document_id;
+				add_rsv(document_id, impact);
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::DECODE_WITH_WRITER()
+				-----------------------------------------
+			*/
+			/*!
+				@brief Given the integer decoder, the number of integes to decode, and the compressed sequence, decompress (but do not process).
+				@param integers [in] The number of integers that are compressed.
+				@param compressed [in] The compressed sequence.
+				@param compressed_size [in] The length of the compressed sequence.
+			*/
+			virtual void decode_with_writer(size_t integers, const void *compressed, size_t compressed_size)
+				{
+				DOCID_TYPE *buffer = reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data());
+				decode(buffer, integers, compressed, compressed_size);
+
+				/*
+					D1-decode inplace with SIMD instructions then process one at a time
+				*/
+				simd::cumulative_sum(buffer, integers);
+
+				/*
+					Process the d1-decoded postings list.
+				*/
+				try
+					{
+					DOCID_TYPE *end = buffer + integers;
+					for (DOCID_TYPE *current = buffer; current < end; current++)
+						add_rsv(*current, impact);
+					}
+				catch (Done&)
+					{
+					/* Nothing */
+					}
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::DECODE_WITH_WRITER()
+				-----------------------------------------
+			*/
+			/*!
+				@brief Given the integer decoder, the number of integes to decode, and the compressed sequence, decompress (but do not process).
+				@details Typically used to export an index, not used to process queries.
+				@param integers [in] The number of integers that are compressed.
+				@param compressed [in] The compressed sequence.
+				@param compressed_size [in] The length of the compressed sequence.
+			*/
+			template <typename WRITER>
+			void decode_with_writer(WRITER &writer, size_t integers, const void *compressed, size_t compressed_size)
+				{
+				DOCID_TYPE *buffer = reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data());
+				decode(buffer, integers, compressed, compressed_size);
+
+				DOCID_TYPE id = 0;
+				DOCID_TYPE *end = buffer + integers;
+				for (auto *current = buffer; current < end; current++)
+					{
+					id += *current;
+					writer.add_rsv(id, impact);
+					}
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::TOP_UP()
+				-----------------------------
+			*/
+			/*!
+				@brief Walk through the remnatns of the search and top-up the top-k
+				@details If the Oracle prediction is to large then the top-k will not be full, but the accuulators will be correct.  This
+				method will walk through the accumulators and add to the top-k
+			*/
+			void top_up(void)
+				{
+				/*
+					Any score greater than or equal to 1 is good enough to go into a heap that isn't full.
+				*/
+				RSV_TYPE heap_entry_point = heap_minimum() == 0 ? 1 : heap_minimum();
+
+				/*
+					Any score greater than or equal to top_k_lower_bound is already in the heap
+				*/
+				for (size_t page = 0; page < accumulators.number_of_dirty_flags; page++)
+					if (!accumulators.dirty_flag[page])
+						{
+						size_t from = page << accumulators.shift;
+						size_t to = (page + 1) << accumulators.shift;
+						for (; from < to; from++)
+							{
+							RSV_TYPE rsv = accumulators.accumulator[from] == PROMOTED ? overflow.accumulator[from] : accumulators.accumulator[from];
+							if (rsv >= heap_entry_point && rsv < top_k_lower_bound)
+								{
+								uint64_t new_key = key(rsv, static_cast<DOCID_TYPE>(from));
+								if (needed_for_top_k > 0)
+									{
+									top_k_keys[--needed_for_top_k] = new_key;
+									if (needed_for_top_k == 0)
+										{
+										top_results.make_heap();						// We've filled the heap so build it
+										heap_entry_point = heap_minimum();			// set the new bottom of heap value
+										}
+									}
+								else if (new_key > top_k_keys[0])
+									{
+									top_results.push_back(new_key);					// we're not in the heap so add this document to the heap
+									heap_entry_point = heap_minimum();				// set the new bottom of heap value
+									}
+								}
+							}
+						}
+				}
+
+			/*
+				QUERY_HEAP_OVERFLOW::UNITTEST()
+				-------------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				std::vector<std::string> keys = {"one", "two", "three", "four"};
+				auto query_object = std::make_unique<query_heap_overflow>();
+				query_object->init(keys, 1024, 2);
+				std::ostringstream string;
+
+				/*
+					Check the rsv stuff, including documents that overflow 8 bits
+				*/
+				query_object->add_rsv(2, 10);
+				query_object->add_rsv(3, 200);
+				query_object->add_rsv(2, 2);
+				query_object->add_rsv(1, 250);
+				query_object->add_rsv(1, 14);
+				query_object->add_rsv(3, 100);
+
+				for (const auto rsv : *query_object)
+					string << "<" << rsv.document_id << "," << rsv.rsv << ">";
+				JASS_assert(string.str() == "<1,264><3,300>");
+				JASS_assert(query_object->get_rsv(2) == 12);
+
+				/*
+					Check against the exact rsvs, with ties and many documents in the side table, over several queries (so the side table is re-used)
+				*/
+				std::mt19937 random(42);
+				std::vector<uint32_t> exact(1024);
+				query_object->init(keys, 1024, 20);
+				for (size_t query = 0; query < 3; query++)
+					{
+					query_object->rewind();
+					std::fill(exact.begin(), exact.end(), 0);
+					for (size_t posting = 0; posting < 10000; posting++)
+						{
+						DOCID_TYPE id = random() % 300;
+						RSV_TYPE score = random() % 40 + 1;
+						query_object->add_rsv(id, score);
+						exact[id] += score;
+						}
+
+					std::vector<uint64_t> expected;
+					for (DOCID_TYPE id = 0; id < 1024; id++)
+						{
+						JASS_assert(query_object->get_rsv(id) == exact[id]);
+						expected.push_back(key(exact[id], id));
+						}
+					std::sort(expected.begin(), expected.end());
+
+					std::ostringstream got;
+					std::ostringstream want;
+					for (const auto rsv : *query_object)
+						got << "<" << rsv.document_id << "," << rsv.rsv << ">";
+					for (auto which = expected.end() - 20; which != expected.end(); which++)
+						want << "<" << (*which & 0xFFFF'FFFF) << "," << (*which >> 32) << ">";
+					JASS_assert(got.str() == want.str());
+					}
+
+				puts("query_heap_overflow::PASSED");
+				}
+		};
+	}
@@ -0,0 +1,586 @@
+/*
+	QUERY_HISTOGRAM.H
+	-----------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Process a query using a histogram of rsv values to find the top-k by counting.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <algorithm>
+
+#include "simd.h"
+#include "query.h"
+#include "accumulator_2d.h"
+
+namespace JASS
+	{
+	/*
+		CLASS QUERY_HISTOGRAM
+		---------------------
+	*/
+	/*!
+		@brief Everything necessary to process a query (using a histogram of rsvs) is encapsulated in an object of this type
+		@details As there are few possible rsv values (256 with 8-bit accumulators) the top-k can be found by counting rather than with a heap.
+		add_rsv() keeps top_k_lower_bound, the smallest rsv such that fewer than top_k documents score higher, and a histogram of the number of
+		documents at each rsv at or above it.  When a document reaches top_k_lower_bound for the first time it is added to a list of candidates.
+		As with the heap, a document below top_k_lower_bound costs one comparison.  Above it the cost is O(1) (the bound only ever increases so
+		moving it is amortised over the query), rather than the heap's O(log k) and O(k) find().  sort() is a counting sort of the candidates
+		into the top-k, O(k + range), where the only comparisons are used to break ties on document id (in the same way the heap does).
+	*/
+	class query_histogram : public query
+		{
+		private:
+			static constexpr size_t number_of_rsvs = (size_t)(std::numeric_limits<ACCUMULATOR_TYPE>::max)() + 1;		///< The number of possible rsv values
+
+			/*
+				CLASS QUERY_HISTOGRAM::ITERATOR
+				-------------------------------
+			*/
+			/*!
+				@brief Iterate over the top-k
+			*/
+			class iterator
+				{
+				public:
+					query_histogram &parent;	///< The query object that this is iterating over
+					int64_t where;					///< Where in the results list we are
+
+				public:
+					/*
+						QUERY_HISTOGRAM::ITERATOR::ITERATOR()
+						-------------------------------------
+					*/
+					/*!
+						@brief Constructor
+						@param parent [in] The object we are iterating over
+						@param where [in] Where in the results list this iterator starts
+					*/
+					iterator(query_histogram &parent, int64_t where) :
+						parent(parent),
+						where(where)
+						{
+						/* Nothing */
+						}
+
+					/*
+						QUERY_HISTOGRAM::ITERATOR::OPERATOR!=()
+						---------------------------------------
+					*/
+					/*!
+						@brief Compare two iterator objects for non-equality.
+						@param with [in] The iterator object to compare to.
+						@return true if they differ, else false.
+					*/
+					bool operator!=(const iterator &with) const
+						{
+						return with.where != where;
+						}
+
+					/*
+						QUERY_HISTOGRAM::ITERATOR::OPERATOR++()
+						---------------------------------------
+					*/
+					/*!
+						@brief Increment this iterator.
+					*/
+					virtual iterator &operator++(void)
+						{
+						where++;
+						return *this;
+						}
+
+					/*
+						QUERY_HISTOGRAM::ITERATOR::OPERATOR*()
+						--------------------------------------
+					*/
+					/*!
+						@brief Return a reference to the <document_id,rsv> pair at the current location.
+						@return The current object.
+					*/
+					docid_rsv_pair operator*()
+						{
+						DOCID_TYPE id = parent.top_k_keys[where] & 0xFFFF'FFFF;
+						RSV_TYPE rsv = parent.top_k_keys[where] >> 32;
+						return docid_rsv_pair(id, (*parent.primary_keys)[id], rsv);
+						}
+					};
+
+			/*
+				CLASS QUERY_HISTOGRAM::REVERSE_ITERATOR
+				---------------------------------------
+			*/
+			/*!
+				@brief Reverse iterate over the top-k
+			*/
+			class reverse_iterator : public iterator
+				{
+				public:
+					using iterator::iterator;
+
+					/*
+						QUERY_HISTOGRAM::REVERSE_ITERATOR::OPERATOR++()
+						-----------------------------------------------
+					*/
+					/*!
+						@brief Increment this iterator.
+					*/
+					virtual iterator &operator++(void)
+						{
+						iterator::where--;
+						return *this;
+						}
+				};
+
+		private:
+			accumulator_2d<ACCUMULATOR_TYPE, MAX_DOCUMENTS> accumulators;	///< The accumulators, one per document in the collection
+			accumulator_2d<uint8_t, MAX_DOCUMENTS> listed;						///< Non-zero if the document is already in candidates
+			std::vector<DOCID_TYPE> candidates;										///< The documents that have reached top_k_lower_bound (some might since have fallen below it)
+			size_t candidates_used;														///< The number of candidates
+			uint32_t histogram[number_of_rsvs];										///< The number of documents with each rsv (only valid at or above top_k_lower_bound)
+			size_t at_or_above;															///< The number of documents with an rsv at or above top_k_lower_bound
+			ACCUMULATOR_TYPE top_k_lower_bound;										///< Fewer than top_k documents have an rsv larger than this
+			uint64_t top_k_keys[MAX_TOP_K];											///< The sorted top-k as <rsv, document id> keys (lowest first)
+			size_t results_used;															///< The number of documents in top_k_keys
+			bool sorted;																	///< has top_k_keys been computed (false after rewind() true after sort())
+
+		private:
+			/*
+				QUERY_HISTOGRAM::ADD_CANDIDATE()
+				--------------------------------
+			*/
+			/*!
+				@brief A document has reached top_k_lower_bound so count it and make sure it is in the list of candidates.
+				@param document_id [in] The document.
+				@param rsv [in] The document's rsv.
+			*/
+			forceinline void add_candidate(DOCID_TYPE document_id, ACCUMULATOR_TYPE rsv)
+				{
+				at_or_above++;
+				histogram[rsv]++;
+
+				uint8_t &seen = listed[document_id];
+				if (!seen)
+					{
+					seen = 1;
+					candidates[candidates_used++] = document_id;
+					}
+				}
+
+			/*
+				QUERY_HISTOGRAM::RAISE_LOWER_BOUND()
+				------------------------------------
+			*/
+			/*!
+				@brief Move top_k_lower_bound up while at least top_k documents score higher than it.
+			*/
+			forceinline void raise_lower_bound(void)
+				{
+				while (at_or_above - histogram[top_k_lower_bound] >= top_k)
+					at_or_above -= histogram[top_k_lower_bound++];
+				}
+
+		public:
+			/*
+				QUERY_HISTOGRAM::QUERY_HISTOGRAM()
+				----------------------------------
+			*/
+			/*!
+				@brief Constructor
+			*/
+			query_histogram() :
+				query()
+				{
+				rewind();
+				}
+
+			/*
+				QUERY_HISTOGRAM::~QUERY_HISTOGRAM()
+				-----------------------------------
+			*/
+			/*!
+				@brief Destructor
+			*/
+			virtual ~query_histogram()
+				{
+				}
+
+			/*
+				QUERY_HISTOGRAM::INIT()
+				-----------------------
+			*/
+			/*!
+				@brief Initialise the object. MUST be called before first use.
+				@param primary_keys [in] Vector of the document primary keys used to convert from internal document ids to external primary keys.
+				@param documents [in] The number of documents in the collection.
+				@param top_k [in]	The top-k documents to return from the query once executed.
+				@param width [in] The width of the 2-d accumulators (if they are being used).
+			*/
+			virtual void init(const std::vector<std::string> &primary_keys, DOCID_TYPE documents = 1024, size_t top_k = 10, size_t width = 7)
+				{
+				query::init(primary_keys, documents, top_k);
+				accumulators.init(documents, width);
+				listed.init(documents, width);
+				candidates.resize(documents);
+				rewind();
+				}
+
+			/*
+				QUERY_HISTOGRAM::BEGIN()
+				------------------------
+			*/
+			/*!
+				@brief Return an iterator pointing to start of the top-k
+				@return Iterator pointing to start of the top-k
+			*/
+			auto begin(void)
+				{
+				sort();
+				return iterator(*this, 0);
+				}
+
+			/*
+				QUERY_HISTOGRAM::END()
+				----------------------
+			*/
+			/*!
+				@brief Return an iterator pointing to end of the top-k
+				@return Iterator pointing to the end of the top-k
+			*/
+			auto end(void)
+				{
+				return iterator(*this, results_used);
+				}
+
+			/*
+				QUERY_HISTOGRAM::RBEGIN()
+				-------------------------
+			*/
+			/*!
+				@brief Return a reverse iterator pointing to start of the top-k
+				@return Iterator pointing to start of the top-k
+			*/
+			auto rbegin(void)
+				{
+				sort();
+				return reverse_iterator(*this, results_used - 1);
+				}
+
+			/*
+				QUERY_HISTOGRAM::REND()
+				-----------------------
+			*/
+			/*!
+				@brief Return a reverse iterator pointing to end of the top-k
+				@return Iterator pointing to the end of the top-k
+			*/
+			auto rend(void)
+				{
+				return reverse_iterator(*this, -1);
+				}
+
+			/*
+				QUERY_HISTOGRAM::SIZE()
+				-----------------------
+			*/
+			query::DOCID_TYPE size(void)
+				{
+				return at_or_above < top_k ? at_or_above : top_k;
+				}
+
+			/*
+				QUERY_HISTOGRAM::REWIND()
+				-------------------------
+			*/
+			/*!
+				@brief Clear this object after use and ready for re-use
+			*/
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 1, RSV_TYPE largest_possible_rsv = 0)
+				{
+				sorted = false;
+				results_used = 0;
+				accumulators.rewind();
+				listed.rewind();
+				candidates_used = 0;
+				std::fill(histogram, histogram + number_of_rsvs, 0);
+				at_or_above = 0;
+				this->top_k_lower_bound = top_k_lower_bound == 0 ? 1 : top_k_lower_bound;
+				query::rewind(largest_possible_rsv);
+				}
+
+			/*
+				QUERY_HISTOGRAM::SORT()
+				-----------------------
+			*/
+			/*!
+				@brief Counting sort the candidates into the top-k before iteration over it.
+			*/
+			void sort(void)
+				{
+				if (sorted)
+					return;
+				sorted = true;
+
+				/*
+					All the documents above top_k_lower_bound are in the top-k, and as many as will fit of those equal to it (lowest first).
+				*/
+				size_t above = at_or_above - histogram[top_k_lower_bound];
+				size_t from_bound = maths::minimum((size_t)histogram[top_k_lower_bound], top_k - above);
+				results_used = above + from_bound;
+
+				size_t position[number_of_rsvs];
+				size_t at = from_bound;
+				for (size_t rsv = top_k_lower_bound + 1; rsv < number_of_rsvs; rsv++)
+					{
+					position[rsv] = at;
+					at += histogram[rsv];
+					}
+
+				/*
+					Place the documents above the bound and compact the ties at the bound into the start of candidates.
+				*/
+				size_t ties = 0;
+				for (size_t which = 0; which < candidates_used; which++)
+					{
+					DOCID_TYPE id = candidates[which];
+					ACCUMULATOR_TYPE rsv = accumulators.get_value(id);
+					if (rsv > top_k_lower_bound)
+						top_k_keys[position[rsv]++] = (static_cast<uint64_t>(rsv) << 32) | id;
+					else if (rsv == top_k_lower_bound)
+						candidates[ties++] = id;
+					}
+
+				/*
+					Ties at the bound are broken on document id (the highest wins) as they are with the heap.
+				*/
+				if (ties > from_bound)
+					std::nth_element(candidates.begin(), candidates.begin() + (ties - from_bound), candidates.begin() + ties);
+				for (size_t which = 0; which < from_bound; which++)
+					top_k_keys[which] = (static_cast<uint64_t>(top_k_lower_bound) << 32) | candidates[ties - from_bound + which];
+
+				/*
+					Each run of equal rsvs is in candidate order, so put it in document order.
+				*/
+				std::sort(top_k_keys, top_k_keys + from_bound);
+				for (size_t rsv = top_k_lower_bound + 1; rsv < number_of_rsvs; rsv++)
+					if (histogram[rsv] > 1)
+						std::sort(top_k_keys + position[rsv] - histogram[rsv], top_k_keys + position[rsv]);
+
+				candidates_used = 0;		// the candidates have been destroyed
+				}
+
+			/*
+				QUERY_HISTOGRAM::ADD_RSV()
+				--------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv for document document_id
+				@param document_id [in] which document to increment
+				@param score [in] the amount of weight to add
+			*/
+			forceinline void add_rsv(DOCID_TYPE document_id, ACCUMULATOR_TYPE score)
+				{
+				ACCUMULATOR_TYPE &accumulator = accumulators[document_id];			/* This will create the accumulator if it doesn't already exist. */
+				ACCUMULATOR_TYPE old_rsv = accumulator;
+				accumulator += score;
+
+				/*
+					accumulator is less than the top-k lower bound
+				*/
+				if (accumulator < top_k_lower_bound)
+					return;
+
+				/*
+					Move the document in the histogram (or add it if it has just reached the bound) and then move the bound.
+				*/
+				if (old_rsv >= top_k_lower_bound)
+					{
+					histogram[old_rsv]--;
+					histogram[accumulator]++;
+					}
+				else
+					add_candidate(document_id, accumulator);
+
+				raise_lower_bound();
+				}
+
+			/*
+				QUERY_HISTOGRAM::ADD_RSV_D1()
+				-----------------------------
+			*/
+			/*!
+				@brief Add weight to the rsv for document docuument_id
+				@param document_id [in] which document to increment
+			*/
+			forceinline void add_rsv_d1(DOCID_TYPE document_id)
+				{
+				document_id += d1_cumulative_sum;
+				d1_cumulative_sum = document_id;
+				add_rsv(document_id, impact);
+				}
+
+			/*
+				QUERY_HISTOGRAM::DECODE_WITH_WRITER()
+				-------------------------------------
+			*/
+			/*!
+				@brief Given the integer decoder, the number of integes to decode, and the compressed sequence, decompress (but do not process).
+				@param integers [in] The number of integers that are compressed.
+				@param compressed [in] The compressed sequence.
+				@param compressed_size [in] The length of the compressed sequence.
+			*/
+			virtual void decode_with_writer(size_t integers, const void *compressed, size_t compressed_size)
+				{
+				DOCID_TYPE *buffer = reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data());
+				decode(buffer, integers, compressed, compressed_size);
+
+				/*
+					D1-decode inplace with SIMD instructions then process one at a time
+				*/
+				simd::cumulative_sum(buffer, integers);
+
+				/*
+					Process the d1-decoded postings list.
+				*/
+				DOCID_TYPE *end = buffer + integers;
+				for (DOCID_TYPE *current = buffer; current < end; current++)
+					add_rsv(*current, impact);
+				}
+
+			/*
+				QUERY_HISTOGRAM::DECODE_WITH_WRITER()
+				-------------------------------------
+			*/
+			/*!
+				@brief Given the integer decoder, the number of integes to decode, and the compressed sequence, decompress (but do not process).
+				@details Typically used to export an index, not used to process queries.
+				@param integers [in] The number of integers that are compressed.
+				@param compressed [in] The compressed sequence.
+				@param compressed_size [in] The length of the compressed sequence.
+			*/
+			template <typename WRITER>
+			void decode_with_writer(WRITER &writer, size_t integers, const void *compressed, size_t compressed_size)
+				{
+				DOCID_TYPE *buffer = reinterpret_cast<DOCID_TYPE *>(decompress_buffer.data());
+				decode(buffer, integers, compressed, compressed_size);
+
+				DOCID_TYPE id = 0;
+				DOCID_TYPE *end = buffer + integers;
+				for (auto *current = buffer; current < end; current++)
+					{
+					id += *current;
+					writer.add_rsv(id, impact);
+					}
+				}
+
+			/*
+				QUERY_HISTOGRAM::TOP_UP()
+				-------------------------
+			*/
+			/*!
+				@brief Walk through the remnants of the search and top-up the top-k
+				@details If the Oracle prediction is to large then the top-k will not be full, but the accumulators will be correct.  This
+				method lowers top_k_lower_bound to 1 and adds the documents below the old bound to the histogram and the candidates.
+			*/
+			void top_up(void)
+				{
+				ACCUMULATOR_TYPE old_bound = top_k_lower_bound;
+				std::fill(histogram, histogram + old_bound, 0);
+				top_k_lower_bound = 1;
+
+				for (size_t page = 0; page < accumulators.number_of_dirty_flags; page++)
+					if (!accumulators.dirty_flag[page])
+						{
+						size_t from = page << accumulators.shift;
+						size_t to = (page + 1) << accumulators.shift;
+						for (; from < to; from++)
+							{
+							ACCUMULATOR_TYPE rsv = accumulators.accumulator[from];
+							if (rsv >= 1 && rsv < old_bound)
+								add_candidate(static_cast<DOCID_TYPE>(from), rsv);
+							}
+						}
+
+				raise_lower_bound();
+				}
+
+			/*
+				QUERY_HISTOGRAM::UNITTEST()
+				---------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				std::vector<std::string> keys = {"one", "two", "three", "four"};
+				auto query_object = std::make_unique<query_histogram>();
+				query_object->init(keys, 1024, 2);
+				std::ostringstream string;
+
+				/*
+					Check the rsv stuff
+				*/
+				query_object->add_rsv(2, 10);
+				query_object->add_rsv(3, 20);
+				query_object->add_rsv(2, 2);
+				query_object->add_rsv(1, 1);
+				query_object->add_rsv(1, 14);
+
+				for (const auto rsv : *query_object)
+					string << "<" << rsv.document_id << "," << rsv.rsv << ">";
+				JASS_assert(string.str() == "<1,15><3,20>");
+
+				/*
+					Check against a brute force top-k (highest rsv then highest document id) with lots of ties, for several k and over several
+					queries (so the object is re-used).  The oracle lower bound and top_up() are checked too.
+				*/
+				std::mt19937 random(42);
+				std::vector<uint32_t> exact(1024);
+				for (size_t top_k : {1, 7, 20, 200})
+					{
+					query_object->init(keys, 1024, top_k);
+					for (size_t query = 0; query < 4; query++)
+						{
+						bool oracle = query == 3;
+						query_object->rewind(0, oracle ? 200 : 1, 255);
+						std::fill(exact.begin(), exact.end(), 0);
+						for (size_t posting = 0; posting < 2000; posting++)
+							{
+							DOCID_TYPE id = random() % 500;
+							ACCUMULATOR_TYPE score = random() % 3 + 1;
+							query_object->add_rsv(id, score);
+							exact[id] += score;
+							}
+						if (oracle && query_object->size() < top_k)
+							query_object->top_up();
+
+						std::vector<uint64_t> expected;
+						for (DOCID_TYPE id = 0; id < 1024; id++)
+							if (exact[id] != 0)
+								expected.push_back((static_cast<uint64_t>(exact[id]) << 32) | id);
+						std::sort(expected.begin(), expected.end());
+
+						std::ostringstream got;
+						std::ostringstream want;
+						for (const auto rsv : *query_object)
+							got << "<" << rsv.document_id << "," << rsv.rsv << ">";
+						for (auto which = expected.end() - std::min(top_k, expected.size()); which != expected.end(); which++)
+							want << "<" << (*which & 0xFFFF'FFFF) << "," << (*which >> 32) << ">";
+						JASS_assert(got.str() == want.str());
+						}
+					}
+
+				puts("query_histogram::PASSED");
+				}
+		};
+	}
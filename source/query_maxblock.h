@@ -310,6 +310,33 @@ namespace JASS
 				return reverse_iterator(*this, maths::maximum((int64_t)-1, (int64_t)(non_zero_accumulators - top_k - 1)));
 				}
 
+			/*
+				QUERY_MAXBLOCK::SIZE()
+				----------------------
+			*/
+			/*!
+				@brief Return the number of documents known to be in the top-k
+				@details The top-k is not known until sort() so this is always 0, which means early termination on the Oracle lower bound never happens.
+				@return 0
+			*/
+			query::DOCID_TYPE size(void)
+				{
+				return 0;
+				}
+
+			/*
+				QUERY_MAXBLOCK::TOP_UP()
+				------------------------
+			*/
+			/*!
+				@brief Top-up the top-k after early termination on the Oracle lower bound
+				@details The Oracle lower bound is not used by this class so there is nothing to do.
+			*/
+			void top_up(void)
+				{
+				/* Nothing */
+				}
+
 			/*
 				QUERY_MAXBLOCK::REWIND()
 				------------------------
@@ -317,7 +344,7 @@ namespace JASS
 			/*!
 				@brief Clear this object after use and ready for re-use
 			*/
-			virtual void rewind(ACCUMULATOR_TYPE smallest_possible_rsv = 0, ACCUMULATOR_TYPE top_k_lower_bound = 0, ACCUMULATOR_TYPE largest_possible_rsv = 0)
+			virtual void rewind(RSV_TYPE smallest_possible_rsv = 0, RSV_TYPE top_k_lower_bound = 0, RSV_TYPE largest_possible_rsv = 0)
 				{
 				sorted = false;
 				accumulators.rewind();
@@ -403,7 +430,10 @@ namespace JASS
 					non_zero_accumulators = maths::minimum(non_zero_accumulators, top_k);
 	#elif defined(AVX512_SORT)
 // NOT CHECKED
-					Sort512_uint64_t::Sort(sorted_accumulators, non_zero_accumulators);
+					if (simd::get_simd_level() >= hardware_support::avx512)
+						Sort512_uint64_t::Sort(sorted_accumulators, non_zero_accumulators);
+					else
+						std::sort(sorted_accumulators, sorted_accumulators + non_zero_accumulators);
 					non_zero_accumulators = maths::minimum(non_zero_accumulators, top_k);
 	#endif
 #else
@@ -481,7 +511,7 @@ namespace JASS
 				/*
 					D1-decode inplace with SIMD instructions then process one at a time
 				*/
-				simd::cumulative_sum_256(buffer, integers);
+				simd::cumulative_sum(buffer, integers);
 
 				/*
 					Process the d1-decoded postings list.
@@ -0,0 +1,438 @@
+/*
+	REORDER_BP.CPP
+	--------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <math.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <algorithm>
+
+#include "asserts.h"
+#include "reorder_bp.h"
+#include "unittest_data.h"
+#include "allocator_pool.h"
+#include "index_manager_sequential.h"
+
+namespace JASS
+	{
+	/*
+		REORDER_BP::REMAP::OPERATOR()()
+		-------------------------------
+	*/
+	void reorder_bp::remap::operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies)
+		{
+		/*
+			Pack each posting into one integer with the new document id in the high bits so that a sort puts them into the new order
+		*/
+		sorter.resize(document_frequency);
+		for (size_t which = 0; which < document_frequency; which++)
+			sorter[which] = (static_cast<uint64_t>((*new_id)[document_ids[which]]) << 32) | term_frequencies[which];
+
+		std::sort(sorter.begin(), sorter.end());
+
+		for (size_t which = 0; which < document_frequency; which++)
+			{
+			document_ids[which] = static_cast<compress_integer::integer>(sorter[which] >> 32);
+			term_frequencies[which] = static_cast<index_postings_impact::impact_type>(sorter[which]);
+			}
+
+		(*destination)(term, postings, document_frequency, document_ids, term_frequencies);
+		}
+
+	/*
+		REORDER_BP::REMAP::OPERATOR()()
+		-------------------------------
+	*/
+	void reorder_bp::remap::operator()(size_t document_id, const slice &key)
+		{
+		if (document_id >= primary_key.size())
+			primary_key.resize(document_id + 1);
+		primary_key[document_id] = key;
+		}
+
+	/*
+		REORDER_BP::REMAP::FINISH()
+		---------------------------
+	*/
+	void reorder_bp::remap::finish(void)
+		{
+		/*
+			Document 0 is the place holder, it is not reordered
+		*/
+		std::vector<size_t> old_id(primary_key.size());
+		for (size_t document = 1; document < primary_key.size(); document++)
+			old_id[(*new_id)[document]] = document;
+
+		if (primary_key.size() != 0)
+			(*destination)(0, primary_key[0]);
+		for (size_t document = 1; document < primary_key.size(); document++)
+			(*destination)(document, primary_key[old_id[document]]);
+
+		destination->finish();
+		}
+
+	/*
+		REORDER_BP::REORDER_BP()
+		------------------------
+	*/
+	reorder_bp::reorder_bp(size_t documents, size_t threads, size_t minimum_document_frequency) :
+		index_manager::delegate(documents),
+		threads(threads == 0 ? 1 : threads),
+		minimum_document_frequency(minimum_document_frequency),
+		term_start(1, 0),
+		log2_table(1 << 16)
+		{
+		for (size_t value = 1; value < log2_table.size(); value++)
+			log2_table[value] = static_cast<float>(::log2(static_cast<double>(value)));
+		}
+
+	/*
+		REORDER_BP::OPERATOR()()
+		------------------------
+	*/
+	void reorder_bp::operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies)
+		{
+		if (document_frequency < minimum_document_frequency)
+			return;
+
+		term_postings.insert(term_postings.end(), document_ids, document_ids + document_frequency);
+		term_start.push_back(term_postings.size());
+		}
+
+	/*
+		REORDER_BP::LOG2()
+		------------------
+	*/
+	float reorder_bp::log2(size_t value) const
+		{
+		return value < log2_table.size() ? log2_table[value] : static_cast<float>(::log2(static_cast<double>(value)));
+		}
+
+	/*
+		REORDER_BP::COMPUTE_GAINS()
+		---------------------------
+	*/
+	void reorder_bp::compute_gains(workspace &space, size_t begin, size_t middle, size_t end, size_t from, size_t to) const
+		{
+		/*
+			The cost of a term is the number of bits needed to store its d-gaps in each half, estimated as log2(n / (degree + 1)) per posting
+		*/
+		float log_left = log2(middle - begin);
+		float log_right = log2(end - middle);
+		auto term_cost = [this, log_left, log_right](uint32_t left, uint32_t right)
+			{
+			return left * (log_left - log2(left + 1)) + right * (log_right - log2(right + 1));
+			};
+
+		for (size_t position = from; position < to; position++)
+			{
+			uint32_t document = order[position];
+			float gain = 0;
+
+			if (position < middle)
+				for (size_t which = document_start[document]; which < document_start[document + 1]; which++)
+					{
+					uint32_t left = space.left_degree[document_terms[which]];
+					uint32_t right = space.right_degree[document_terms[which]];
+					gain += term_cost(left, right) - term_cost(left - 1, right + 1);
+					}
+			else
+				for (size_t which = document_start[document]; which < document_start[document + 1]; which++)
+					{
+					uint32_t left = space.left_degree[document_terms[which]];
+					uint32_t right = space.right_degree[document_terms[which]];
+					gain += term_cost(left, right) - term_cost(left + 1, right - 1);
+					}
+
+			space.gain[position - begin] = std::pair<float, uint32_t>(gain, document);
+			}
+		}
+
+	/*
+		REORDER_BP::BISECT()
+		--------------------
+	*/
+	void reorder_bp::bisect(workspace &space, size_t begin, size_t end, size_t thread_budget)
+		{
+		size_t documents = end - begin;
+		if (documents < minimum_partition_size)
+			return;
+
+		size_t middle = begin + documents / 2;
+		size_t left_documents = middle - begin;
+
+		/*
+			Count the number of documents in each half containing each term
+		*/
+		for (size_t position = begin; position < end; position++)
+			{
+			auto &degree = position < middle ? space.left_degree : space.right_degree;
+			for (size_t which = document_start[order[position]]; which < document_start[order[position] + 1]; which++)
+				degree[document_terms[which]]++;
+			}
+
+		/*
+			Swap the documents between the halves, those that gain the most first, until nothing is gained
+		*/
+		space.gain.resize(documents);
+		for (size_t iteration = 0; iteration < maximum_iterations; iteration++)
+			{
+			if (thread_budget > 1 && documents >= parallel_gain_threshold)
+				{
+				std::vector<std::thread> workers;
+				size_t chunk = (documents + thread_budget - 1) / thread_budget;
+				for (size_t from = begin; from < end; from += chunk)
+					workers.push_back(std::thread(&reorder_bp::compute_gains, this, std::ref(space), begin, middle, end, from, (std::min)(from + chunk, end)));
+				for (auto &worker : workers)
+					worker.join();
+				}
+			else
+				compute_gains(space, begin, middle, end, begin, end);
+
+			auto by_gain = [](const std::pair<float, uint32_t> &first, const std::pair<float, uint32_t> &second)
+				{
+				return first.first > second.first || (first.first == second.first && first.second < second.second);
+				};
+			std::sort(space.gain.begin(), space.gain.begin() + left_documents, by_gain);
+			std::sort(space.gain.begin() + left_documents, space.gain.begin() + documents, by_gain);
+
+			size_t swaps;
+			size_t most_swaps = (std::min)(left_documents, documents - left_documents);
+			for (swaps = 0; swaps < most_swaps; swaps++)
+				{
+				auto &left = space.gain[swaps];
+				auto &right = space.gain[left_documents + swaps];
+				if (left.first + right.first <= 0)
+					break;
+
+				for (size_t which = document_start[left.second]; which < document_start[left.second + 1]; which++)
+					{
+					space.left_degree[document_terms[which]]--;
+					space.right_degree[document_terms[which]]++;
+					}
+				for (size_t which = document_start[right.second]; which < document_start[right.second + 1]; which++)
+					{
+					space.right_degree[document_terms[which]]--;
+					space.left_degree[document_terms[which]]++;
+					}
+				std::swap(left.second, right.second);
+				}
+
+			for (size_t position = 0; position < documents; position++)
+				order[begin + position] = space.gain[position].second;
+
+			if (swaps == 0)
+				break;
+			}
+
+		/*
+			Put the degrees back to zero ready for the next partition
+		*/
+		for (size_t position = begin; position < end; position++)
+			for (size_t which = document_start[order[position]]; which < document_start[order[position] + 1]; which++)
+				space.left_degree[document_terms[which]] = space.right_degree[document_terms[which]] = 0;
+
+		/*
+			Bisect each half, in parallel (each thread needs its own workspace) while there are threads to spare
+		*/
+		if (thread_budget > 1)
+			{
+			size_t left_budget = thread_budget / 2;
+			std::thread left([this, begin, middle, left_budget]()
+				{
+				workspace child(space_terms());
+				bisect(child, begin, middle, left_budget);
+				});
+			bisect(space, middle, end, thread_budget - left_budget);
+			left.join();
+			}
+		else
+			{
+			bisect(space, begin, middle, 1);
+			bisect(space, middle, end, 1);
+			}
+		}
+
+	/*
+		REORDER_BP::FINISH()
+		--------------------
+	*/
+	void reorder_bp::finish(void)
+		{
+		/*
+			Invert the (kept) postings into a forward index
+		*/
+		size_t terms = space_terms();
+		document_start.assign(documents + 2, 0);
+		for (const auto document : term_postings)
+			document_start[document + 1]++;
+		for (size_t document = 1; document < document_start.size(); document++)
+			document_start[document] += document_start[document - 1];
+
+		document_terms.resize(term_postings.size());
+		std::vector<size_t> insertion_point(document_start.begin(), document_start.end() - 1);
+		for (size_t term = 0; term < terms; term++)
+			for (size_t which = term_start[term]; which < term_start[term + 1]; which++)
+				document_terms[insertion_point[term_postings[which]]++] = static_cast<uint32_t>(term);
+
+		std::vector<uint32_t>().swap(term_postings);
+
+		/*
+			Bisect, starting from the original order
+		*/
+		order.resize(documents);
+		for (size_t document = 0; document < documents; document++)
+			order[document] = static_cast<uint32_t>(document + 1);
+
+		workspace space(terms);
+		bisect(space, 0, documents, threads);
+
+		/*
+			Document ids count from 1
+		*/
+		new_id = std::make_shared<std::vector<compress_integer::integer>>(documents + 1);
+		for (size_t position = 0; position < documents; position++)
+			(*new_id)[order[position]] = static_cast<compress_integer::integer>(position + 1);
+		}
+
+	/*
+		REORDER_BP::COST()
+		------------------
+	*/
+	double reorder_bp::cost(const std::vector<compress_integer::integer> &new_ids) const
+		{
+		std::vector<size_t> old_id(documents + 1);
+		for (size_t document = 1; document <= documents; document++)
+			old_id[new_ids[document]] = document;
+
+		double bits = 0;
+		std::vector<size_t> previous(space_terms(), 0);
+		for (size_t document = 1; document <= documents; document++)
+			for (size_t which = document_start[old_id[document]]; which < document_start[old_id[document] + 1]; which++)
+				{
+				bits += ::log2(static_cast<double>(document - previous[document_terms[which]] + 1));
+				previous[document_terms[which]] = document;
+				}
+
+		return bits;
+		}
+
+	/*
+		REORDER_BP::UNITTEST()
+		----------------------
+	*/
+	void reorder_bp::unittest(void)
+		{
+		/*
+			A collection of 8 topics (each with its own vocabulary) with the documents of each topic spread evenly through the collection
+		*/
+		const size_t topics = 8;
+		const size_t documents_in_collection = 512;
+		std::mt19937 random(40);
+		std::vector<std::vector<compress_integer::integer>> postings_lists(topics * 20);
+		for (size_t document = 1; document <= documents_in_collection; document++)
+			{
+			size_t topic = document % topics;
+			for (size_t term = 0; term < 20; term++)
+				if (random() % 2 == 0)
+					postings_lists[topic * 20 + term].push_back(static_cast<compress_integer::integer>(document));
+			}
+
+		allocator_pool memory;
+		index_postings postings(memory);
+		reorder_bp reorder(documents_in_collection, 4);
+		for (auto &list : postings_lists)
+			{
+			std::vector<index_postings_impact::impact_type> frequencies(list.size(), 1);
+			reorder(slice("term"), postings, static_cast<compress_integer::integer>(list.size()), list.data(), frequencies.data());
+			}
+		reorder.finish();
+
+		/*
+			The new ids must be a permutation of the old ids, and the d-gaps must be smaller
+		*/
+		auto new_ids = reorder.get_new_ids();
+		std::vector<compress_integer::integer> seen(new_ids->begin() + 1, new_ids->end());
+		std::sort(seen.begin(), seen.end());
+		for (size_t document = 0; document < documents_in_collection; document++)
+			JASS_assert(seen[document] == document + 1);
+
+		std::vector<compress_integer::integer> identity(documents_in_collection + 1);
+		for (size_t document = 0; document <= documents_in_collection; document++)
+			identity[document] = static_cast<compress_integer::integer>(document);
+		JASS_assert(reorder.cost(*new_ids) < reorder.cost(identity) / 2);
+
+		/*
+			Write the standard 10-document collection (in reverse order) through a remap, the index must be the same except for the document ids
+		*/
+		class capture : public index_manager::delegate
+			{
+			public:
+				std::map<std::string, std::vector<std::pair<compress_integer::integer, index_postings_impact::impact_type>>> index;
+				std::vector<std::string> primary_key;
+				bool finished = false;
+
+			public:
+				capture(size_t documents) : index_manager::delegate(documents) {}
+				virtual void operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies)
+					{
+					auto &list = index[std::string(reinterpret_cast<char *>(term.address()), term.size())];
+					for (size_t which = 0; which < document_frequency; which++)
+						list.push_back(std::pair<compress_integer::integer, index_postings_impact::impact_type>(document_ids[which], term_frequencies[which]));
+					}
+				virtual void operator()(size_t document_id, const slice &key)
+					{
+					JASS_assert(document_id == primary_key.size());
+					primary_key.push_back(std::string(reinterpret_cast<char *>(key.address()), key.size()));
+					}
+				virtual void finish(void)
+					{
+					finished = true;
+					}
+			};
+
+		index_manager_sequential index;
+		index_manager_sequential::unittest_build_index(index, unittest_data::ten_documents);
+
+		auto reverse = std::make_shared<std::vector<compress_integer::integer>>(index.get_highest_document_id() + 1);
+		for (size_t document = 1; document <= index.get_highest_document_id(); document++)
+			(*reverse)[document] = static_cast<compress_integer::integer>(index.get_highest_document_id() + 1 - document);
+
+		capture original(index.get_highest_document_id());
+		index.iterate(original);
+
+		auto reordered_capture = new capture(index.get_highest_document_id());
+		remap reordered(reverse, std::unique_ptr<index_manager::delegate>(reordered_capture));
+		index.iterate(reordered);
+		reordered.finish();
+
+		JASS_assert(reordered_capture->finished);
+		JASS_assert(reordered_capture->primary_key.size() == original.primary_key.size());
+		JASS_assert(reordered_capture->primary_key[0] == "-");
+		JASS_assert(reordered_capture->index.size() == original.index.size());
+		for (const auto &[term, list] : original.index)
+			{
+			const auto &other = reordered_capture->index[term];
+			JASS_assert(other.size() == list.size());
+
+			std::vector<std::pair<std::string, index_postings_impact::impact_type>> expected;
+			std::vector<std::pair<std::string, index_postings_impact::impact_type>> got;
+			for (size_t which = 0; which < list.size(); which++)
+				{
+				if (which != 0)
+					JASS_assert(other[which - 1].first < other[which].first);
+				expected.push_back(std::pair<std::string, index_postings_impact::impact_type>(original.primary_key[list[which].first], list[which].second));
+				got.push_back(std::pair<std::string, index_postings_impact::impact_type>(reordered_capture->primary_key[other[which].first], other[which].second));
+				}
+			std::sort(expected.begin(), expected.end());
+			std::sort(got.begin(), got.end());
+			JASS_assert(expected == got);
+			}
+
+		puts("reorder_bp::PASSED");
+		}
+	}
@@ -0,0 +1,330 @@
+/*
+	REORDER_BP.H
+	------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Document identifier reordering by recursive graph bisection (BP).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+
+#include "index_manager.h"
+
+namespace JASS
+	{
+	/*
+		CLASS REORDER_BP
+		----------------
+	*/
+	/*!
+		@brief Document identifier reordering by recursive graph bisection (BP).
+		@details Assign new document ids so that documents sharing terms get close ids, which makes the d-gaps (and so the index) smaller
+		and the accumulators touched by a query more clustered.  This is the algorithm of:
+		L. Dhulipala, I. Kabiljo, B. Karrer, G. Ottaviano, S. Pupyrev, A. Shalita (2016), Compressing graphs and indexes with recursive graph
+		bisection, KDD 2016, pp. 1535-1544,
+		using the parameters of: J. Mackenzie, A. Mallia, M. Petri, J.S. Culpepper, T. Suel (2019), Compressing inverted indexes with recursive
+		graph bisection: A reproducibility study, ECIR 2019, pp. 339-352.
+
+		The documents are split in half and, for up to maximum_iterations rounds, each document's gain in moving to the other half is
+		computed (using the log-gap cost model), then the documents on each side are sorted by gain and swapped in pairs while the sum of the
+		pair's gains is positive.  Each half is then bisected in the same way until the partitions are smaller than minimum_partition_size.
+		The gains are computed in parallel and the two halves of a partition are bisected in parallel until the thread budget is used up.
+
+		This object is an index_manager::delegate, so it is given the postings by index_manager::iterate() (terms with a document frequency
+		below minimum_document_frequency cannot help and are dropped).  The work is done in finish(), after which get_new_ids() returns the
+		new id of each document.  An index is written in the new order by wrapping each serialiser in a reorder_bp::remap, which rewrites
+		(and re-sorts) each postings list and permutes the primary keys before passing them on.
+	*/
+	class reorder_bp : public index_manager::delegate
+		{
+		public:
+			static constexpr size_t minimum_partition_size = 32;			///< Partitions smaller than this are not bisected.
+			static constexpr size_t maximum_iterations = 20;				///< The maximum number of swap rounds at each bisection.
+			static constexpr size_t parallel_gain_threshold = 4096;		///< Partitions smaller than this compute their gains in one thread.
+
+		public:
+			/*
+				CLASS REORDER_BP::REMAP
+				-----------------------
+			*/
+			/*!
+				@brief Rewrite each postings list and the primary keys in the new document order and pass them on to another delegate.
+				@details The postings are rewritten in place (the document ids and term frequencies buffers belong to the index_manager and are
+				rebuilt for each iteration).  The primary keys are held until finish() as the new order of them is not known until all are seen.
+			*/
+			class remap : public index_manager::delegate
+				{
+				private:
+					std::shared_ptr<const std::vector<compress_integer::integer>> new_id;		///< The new id of each document (indexed by the old id).
+					std::unique_ptr<index_manager::delegate> destination;								///< The delegate that is given the reordered index.
+					std::vector<uint64_t> sorter;																///< Each posting packed into an integer, new document id in the high bits.
+					std::vector<slice> primary_key;															///< The primary keys in the old document order.
+
+				public:
+					/*
+						REORDER_BP::REMAP::REMAP()
+						--------------------------
+					*/
+					/*!
+						@brief Constructor.
+						@param new_id [in] The new id of each document, indexed by the old id (see reorder_bp::get_new_ids()).
+						@param destination [in] The delegate that is given the reordered index (this object takes ownership).
+					*/
+					remap(std::shared_ptr<const std::vector<compress_integer::integer>> new_id, std::unique_ptr<index_manager::delegate> destination) :
+						index_manager::delegate(destination->documents),
+						new_id(new_id),
+						destination(std::move(destination))
+						{
+						/* Nothing */
+						}
+
+					/*
+						REORDER_BP::REMAP::~REMAP()
+						---------------------------
+					*/
+					/*!
+						@brief Destructor.
+					*/
+					virtual ~remap()
+						{
+						/* Nothing */
+						}
+
+					/*
+						REORDER_BP::REMAP::OPERATOR()()
+						-------------------------------
+					*/
+					/*!
+						@brief Rewrite the postings list with the new document ids, sort it, and pass it on.
+						@param term [in] The term name.
+						@param postings [in] The postings lists.
+						@param document_frequency [in] The document frequency of the term
+						@param document_ids [in, out] An array (of length document_frequency) of document ids, rewritten in place.
+						@param term_frequencies [in, out] An array (of length document_frequency) of term frequencies, rewritten in place.
+					*/
+					virtual void operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies);
+
+					/*
+						REORDER_BP::REMAP::OPERATOR()()
+						-------------------------------
+					*/
+					/*!
+						@brief Remember the primary key of a document (they are passed on in finish()).
+						@param document_id [in] The internal document identfier.
+						@param primary_key [in] This document's primary key (external document identifier).
+					*/
+					virtual void operator()(size_t document_id, const slice &primary_key);
+
+					/*
+						REORDER_BP::REMAP::FINISH()
+						---------------------------
+					*/
+					/*!
+						@brief Pass the primary keys on in the new document order, then finish the destination.
+					*/
+					virtual void finish(void);
+				};
+
+		private:
+			/*
+				CLASS REORDER_BP::WORKSPACE
+				---------------------------
+			*/
+			/*!
+				@brief The scratch space used by one thread while bisecting.
+			*/
+			class workspace
+				{
+				public:
+					std::vector<uint32_t> left_degree;							///< The number of documents in the left partition containing each term.
+					std::vector<uint32_t> right_degree;							///< The number of documents in the right partition containing each term.
+					std::vector<std::pair<float, uint32_t>> gain;			///< The move gain of each document in the partition (and the document).
+
+				public:
+					/*
+						REORDER_BP::WORKSPACE::WORKSPACE()
+						----------------------------------
+					*/
+					/*!
+						@brief Constructor.
+						@param terms [in] The number of terms in the forward index.
+					*/
+					explicit workspace(size_t terms) :
+						left_degree(terms),
+						right_degree(terms)
+						{
+						/* Nothing */
+						}
+				};
+
+		private:
+			size_t threads;										///< The number of threads to use.
+			size_t minimum_document_frequency;				///< Terms with a document frequency less than this are ignored.
+			std::vector<uint32_t> term_postings;			///< The document ids of each (kept) term, one term after the other.
+			std::vector<size_t> term_start;					///< Where in term_postings each term starts (with one extra at the end).
+			std::vector<size_t> document_start;				///< Where in document_terms each document starts (with one extra at the end).
+			std::vector<uint32_t> document_terms;			///< The forward index, the terms in each document, one document after the other.
+			std::vector<uint32_t> order;						///< The documents in their new order.
+			std::vector<float> log2_table;					///< log2(x) for small x.
+			std::shared_ptr<std::vector<compress_integer::integer>> new_id;		///< The new id of each document, indexed by the old id.
+
+		private:
+			/*
+				REORDER_BP::SPACE_TERMS()
+				-------------------------
+			*/
+			/*!
+				@brief Return the number of terms in the graph.
+				@return The number of terms.
+			*/
+			size_t space_terms(void) const
+				{
+				return term_start.size() - 1;
+				}
+
+			/*
+				REORDER_BP::LOG2()
+				------------------
+			*/
+			/*!
+				@brief Return log2(value), from the table if possible.
+				@param value [in] The value (greater than 0).
+				@return log2(value).
+			*/
+			float log2(size_t value) const;
+
+			/*
+				REORDER_BP::COMPUTE_GAINS()
+				---------------------------
+			*/
+			/*!
+				@brief Compute the move gain of the documents in order[from, to) of the partition order[begin, end) split at middle.
+				@param space [in, out] The workspace holding the term degrees, the gains are written into space.gain.
+				@param begin [in] The start of the partition.
+				@param middle [in] The start of the right half of the partition.
+				@param end [in] The end of the partition.
+				@param from [in] The first document to compute.
+				@param to [in] The end of the documents to compute.
+			*/
+			void compute_gains(workspace &space, size_t begin, size_t middle, size_t end, size_t from, size_t to) const;
+
+			/*
+				REORDER_BP::BISECT()
+				--------------------
+			*/
+			/*!
+				@brief Recursively bisect the documents in order[begin, end).
+				@param space [in] The workspace for this thread.
+				@param begin [in] The start of the partition.
+				@param end [in] The end of the partition.
+				@param thread_budget [in] The number of threads this partition may use.
+			*/
+			void bisect(workspace &space, size_t begin, size_t end, size_t thread_budget);
+
+		public:
+			/*
+				REORDER_BP::REORDER_BP()
+				------------------------
+			*/
+			/*!
+				@brief Constructor.
+				@param documents [in] The number of documents in the collection (documents are numbered from 1).
+				@param threads [in] The number of threads to use.
+				@param minimum_document_frequency [in] Terms with a document frequency less than this are ignored.
+			*/
+			explicit reorder_bp(size_t documents, size_t threads = std::thread::hardware_concurrency(), size_t minimum_document_frequency = 2);
+
+			/*
+				REORDER_BP::~REORDER_BP()
+				-------------------------
+			*/
+			/*!
+				@brief Destructor.
+			*/
+			virtual ~reorder_bp()
+				{
+				/* Nothing */
+				}
+
+			/*
+				REORDER_BP::OPERATOR()()
+				------------------------
+			*/
+			/*!
+				@brief Add a postings list to the graph.
+				@param term [in] The term name.
+				@param postings [in] The postings lists.
+				@param document_frequency [in] The document frequency of the term
+				@param document_ids [in] An array (of length document_frequency) of document ids.
+				@param term_frequencies [in] An array (of length document_frequency) of term frequencies (corresponding to document_ids).
+			*/
+			virtual void operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies);
+
+			/*
+				REORDER_BP::OPERATOR()()
+				------------------------
+			*/
+			/*!
+				@brief The primary keys are not needed to compute the order.
+				@param document_id [in] The internal document identfier.
+				@param primary_key [in] This document's primary key (external document identifier).
+			*/
+			virtual void operator()(size_t document_id, const slice &primary_key)
+				{
+				/* Nothing */
+				}
+
+			/*
+				REORDER_BP::FINISH()
+				--------------------
+			*/
+			/*!
+				@brief Build the forward index and compute the new order.
+			*/
+			virtual void finish(void);
+
+			/*
+				REORDER_BP::GET_NEW_IDS()
+				-------------------------
+			*/
+			/*!
+				@brief Return the new id of each document (indexed by the old id, entry 0 is 0).  Only valid after finish().
+				@return The new document ids.
+			*/
+			std::shared_ptr<const std::vector<compress_integer::integer>> get_new_ids(void) const
+				{
+				return new_id;
+				}
+
+			/*
+				REORDER_BP::COST()
+				------------------
+			*/
+			/*!
+				@brief Return the log-gap cost of an ordering, the sum over all (kept) postings of log2(d-gap + 1).  Only valid after finish().
+				@param new_ids [in] The new id of each document (indexed by the old id).
+				@return The cost of the ordering, in bits.
+			*/
+			double cost(const std::vector<compress_integer::integer> &new_ids) const;
+
+			/*
+				REORDER_BP::UNITTEST()
+				----------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void);
+		};
+	}
@@ -5,23 +5,73 @@
 	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
 */
 #include <ostream>
+#include <sstream>
 
 #include "slice.h"
 #include "version.h"
 #include "checksum.h"
+#include "hash_pearson.h"
 #include "serialise_ci.h"
 #include "index_postings.h"
 #include "index_manager_sequential.h"
 
 namespace JASS
 	{
+	/*
+		SERIALISE_CI::POSTINGS_FILENAME()
+		---------------------------------
+	*/
+	std::string serialise_ci::postings_filename(size_t shard, size_t shards)
+		{
+		return shards == 1 ? "JASS_postings.cpp" : "JASS_postings_" + std::to_string(shard) + ".cpp";
+		}
+
+	/*
+		SERIALISE_CI::METHOD_NAME()
+		---------------------------
+	*/
+	std::string serialise_ci::method_name(const slice &term)
+		{
+		static const char hex[] = "0123456789abcdef";
+		std::string name = "T_";
+
+		for (const uint8_t *byte = reinterpret_cast<const uint8_t *>(term.address()); byte < reinterpret_cast<const uint8_t *>(term.address()) + term.size(); byte++)
+			if ((*byte >= 'a' && *byte <= 'z') || (*byte >= 'A' && *byte <= 'Z') || (*byte >= '0' && *byte <= '9'))
+				name.push_back(static_cast<char>(*byte));
+			else
+				{
+				name.push_back('_');
+				name.push_back(hex[*byte >> 4]);
+				name.push_back(hex[*byte & 0x0F]);
+				}
+
+		return name;
+		}
+
+	/*
+		SERIALISE_CI::STRING_LITERAL()
+		------------------------------
+	*/
+	std::string serialise_ci::string_literal(const slice &string)
+		{
+		std::string literal;
+
+		for (const char *byte = reinterpret_cast<const char *>(string.address()); byte < reinterpret_cast<const char *>(string.address()) + string.size(); byte++)
+			{
+			if (*byte == '"' || *byte == '\\')
+				literal.push_back('\\');
+			literal.push_back(*byte);
+			}
+
+		return literal;
+		}
+
 	/*
 		SERIALISE_CI::SERIALISE_CI()
 		----------------------------
 	*/
-	serialise_ci::serialise_ci(size_t documents) :
+	serialise_ci::serialise_ci(size_t documents, size_t shards) :
 		index_manager::delegate(documents),
-		postings_file("JASS_postings.cpp", "w+b"),
 		postings_header_file("JASS_postings.h", "w+b"),
 		vocab_file("JASS_vocabulary.cpp", "w+b"),
 		primary_key_file("JASS_primary_keys.cpp", "w+b"),
@@ -36,11 +86,17 @@ namespace JASS
 		vocab_file.write("#include\"JASS_vocabulary.h\"\n");
 		vocab_file.write("JASS_ci_vocab dictionary[] = {\n");
 
-		postings_file.write("/* Generated by " + version::build() + " */\n");
-		postings_file.write("#include <stddef.h>\n");
-		postings_file.write("#include <stdint.h>\n");
-		postings_file.write("#include\"query_heap.h\"\n\n");
-		postings_file.write("using namespace JASS;\n");
+		shards = shards == 0 ? 1 : shards;
+		for (size_t shard = 0; shard < shards; shard++)
+			{
+			postings_files.push_back(std::make_unique<file>(postings_filename(shard, shards), "w+b"));
+			auto &postings_file = *postings_files.back();
+			postings_file.write("/* Generated by " + version::build() + " */\n");
+			postings_file.write("#include <stddef.h>\n");
+			postings_file.write("#include <stdint.h>\n");
+			postings_file.write("#include\"query_heap.h\"\n\n");
+			postings_file.write("using namespace JASS;\n");
+			}
 
 		postings_header_file.write("/* Generated by " + version::build() + " */\n");
 		postings_header_file.write("#include\"query_heap.h\"\n\n");
@@ -69,6 +125,19 @@ namespace JASS
 		vocab_file.write(length.str());
 
 		primary_key_file.write("};\n");
+
+		/*
+			Write the list of generated source files as a CMake fragment
+		*/
+		file cmake_file("JASS_postings.cmake", "w+b");
+		cmake_file.write("# Generated by " + version::build() + "\n");
+		cmake_file.write("set(JASS_COMPILED_INDEX_FILES\n");
+		cmake_file.write("\t${CMAKE_CURRENT_LIST_DIR}/JASS_postings.h\n");
+		for (size_t shard = 0; shard < postings_files.size(); shard++)
+			cmake_file.write("\t${CMAKE_CURRENT_LIST_DIR}/" + postings_filename(shard, postings_files.size()) + "\n");
+		cmake_file.write("\t${CMAKE_CURRENT_LIST_DIR}/JASS_primary_keys.cpp\n");
+		cmake_file.write("\t${CMAKE_CURRENT_LIST_DIR}/JASS_vocabulary.cpp\n");
+		cmake_file.write("\t)\n");
 		}
 
 	/*
@@ -78,11 +147,12 @@ namespace JASS
 	void serialise_ci::operator()(const slice &term, const index_postings &postings, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies)
 		{
 		std::ostringstream code;
+		std::string method = method_name(term);
 
 		/*
 			Construct the method and write it out
 		*/
-		code << "void T_" << term << "(query_heap &q)\n";
+		code << "void " << method << "(query_heap &q)\n";
 		code << "{\n";
 
 		/*
@@ -94,23 +164,21 @@ namespace JASS
 			code << "q.add_rsv(" << *current_id << ',' << (size_t)*current_tf << ");\n";
 		code << "}\n";
 
-		postings_file.write(code.str());
+		/*
+			The shard is chosen by the hash of the term so that the terms (and so the postings) are spread across the shards
+		*/
+		size_t shard = postings_files.size() == 1 ? 0 : hash_pearson::hash<32>(term) % postings_files.size();
+		postings_files[shard]->write(code.str());
 
 		/*
 			Add this term to the vocabulary
 		*/
-		vocab_file.write("{\"");
-		vocab_file.write(term.address(), term.size());
-		vocab_file.write("\",T_");
-		vocab_file.write(term.address(), term.size());
-		vocab_file.write("},\n");
+		vocab_file.write("{\"" + string_literal(term) + "\"," + method + "},\n");
 
 		/*
 			Add to the header file
 		*/
-		postings_header_file.write("void T_");
-		postings_header_file.write(term.address(), term.size());
-		postings_header_file.write("(query_heap &);\n");
+		postings_header_file.write("void " + method + "(query_heap &);\n");
 
 		terms++;
 		}
@@ -121,9 +189,7 @@ namespace JASS
 	*/
 	void serialise_ci::operator()(size_t document_id, const slice &primary_key)
 		{
-		primary_key_file.write("\"");
-		primary_key_file.write(primary_key.address(), primary_key.size());
-		primary_key_file.write("\",\n");
+		primary_key_file.write("\"" + string_literal(primary_key) + "\",\n");
 		}
 
 	/*
@@ -154,15 +220,27 @@ namespace JASS
 
 		auto checksum = checksum::fletcher_16_file("JASS_postings.cpp");
 //		std::cout << "JASS_postings.c:" << checksum << '\n';
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 14204);
+#else
 		JASS_assert(checksum == 35708 || checksum == 5482);
+#endif
 
 		checksum = checksum::fletcher_16_file("JASS_postings.h");
 //		std::cout << "JASS_postings.h:" << checksum << '\n';
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 25375);
+#else
 		JASS_assert(checksum == 31263 || checksum == 44045);
+#endif
 
 		checksum = checksum::fletcher_16_file("JASS_vocabulary.cpp");
 //		std::cout << "JASS_vocabulary.cpp:" << checksum << '\n';
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 29761);
+#else
 		JASS_assert(checksum == 8513 || checksum == 51247);
+#endif
 
 		checksum = checksum::fletcher_16_file("JASS_primary_keys.cpp");
 //		std::cout << "JASS_primary_keys.cpp:" << checksum << '\n';
@@ -170,6 +248,46 @@ namespace JASS
 
 //		std::cout << "=====\n";
 
+		/*
+			Split into shards, each method must be in exactly one shard and be the same as before
+		*/
+		std::string single;
+		file::read_entire_file("JASS_postings.cpp", single);
+		{
+		serialise_ci serialiser(index.get_highest_document_id(), 4);
+		index.iterate(serialiser);
+		serialiser.finish();
+		}
+
+		std::string shards;
+		for (size_t shard = 0; shard < 4; shard++)
+			{
+			std::string code;
+			file::read_entire_file(postings_filename(shard, 4), code);
+			shards += code;
+			}
+
+		size_t methods = 0;
+		for (size_t start = single.find("void T_"); start != std::string::npos; start = single.find("void T_", start + 1))
+			{
+			std::string method = single.substr(start, single.find("}\n", start) - start);
+			std::string declaration = method.substr(0, method.find('(') + 1);
+			JASS_assert(shards.find(method) != std::string::npos);
+			JASS_assert(shards.find(declaration) == shards.rfind(declaration));
+			methods++;
+			}
+		JASS_assert(methods == 20);
+
+		std::string cmake;
+		file::read_entire_file("JASS_postings.cmake", cmake);
+		JASS_assert(cmake.find("JASS_postings_3.cpp") != std::string::npos);
+
+		/*
+			Terms and primary keys that are not valid C++
+		*/
+		JASS_assert(method_name(slice("caf\xC3\xA9_1")) == "T_caf_c3_a9_5f1");
+		JASS_assert(string_literal(slice("a\"b\\c")) == "a\\\"b\\\\c");
+
 		puts("serialise_ci::PASSED");
 		}
 	}
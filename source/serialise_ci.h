@@ -12,6 +12,10 @@
  */
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "file.h"
 #include "index_manager.h"
 
@@ -26,16 +30,57 @@ namespace JASS
 		@details  Andrew Trotman (University of Otago) and Jimmy Lin (University of Waterloo) proposed serialising the index into
 		source code and then the index and the search engine are all the same single file.  This is an implementaiton of this, indexing
 		into a postings file (and header), a vocabulary file.
+
+		For a large collection a single postings file is more than a compiler can manage, so the postings can be split into shards
+		(JASS_postings_0.cpp, JASS_postings_1.cpp, ...) with each term's method going into the shard given by the hash of the term.  The
+		shards do not depend on each other (or on JASS_postings.h) so they can be compiled in parallel.  Either way, the list of generated
+		source files is also written to JASS_postings.cmake (as JASS_COMPILED_INDEX_FILES) for inclusion in a CMake build.
 	*/
 	class serialise_ci : public index_manager::delegate
 		{
 		private:
-			file postings_file;						///< The postings file
+			std::vector<std::unique_ptr<file>> postings_files;		///< The postings files (one per shard)
 			file postings_header_file;				///< The header file for the postings file (so that the vocab can point to the methods)
 			file vocab_file;						///< The vocabulary file (also know as the dictionary file)
 			file primary_key_file;					///< The list of primary keys.
 			uint64_t terms;							///< The number of terms in the vocabulary file.
 
+		private:
+			/*
+				SERIALISE_CI::POSTINGS_FILENAME()
+				---------------------------------
+			*/
+			/*!
+				@brief Return the name of the file holding the given shard of the postings.
+				@param shard [in] The shard number.
+				@param shards [in] The number of shards.
+				@return The filename.
+			*/
+			static std::string postings_filename(size_t shard, size_t shards);
+
+			/*
+				SERIALISE_CI::METHOD_NAME()
+				---------------------------
+			*/
+			/*!
+				@brief Return the name of the method that processes the postings of the given term.
+				@details Bytes that cannot be in a C++ identifier (and '_') are written as '_' followed by their value in hex.
+				@param term [in] The term.
+				@return The method name.
+			*/
+			static std::string method_name(const slice &term);
+
+			/*
+				SERIALISE_CI::STRING_LITERAL()
+				------------------------------
+			*/
+			/*!
+				@brief Return the given string as the contents of a C++ string literal (that is, with '"' and '\\' escaped).
+				@param string [in] The string.
+				@return The escaped string.
+			*/
+			static std::string string_literal(const slice &string);
+
 		public:
 			serialise_ci() = delete;
 			/*
@@ -45,8 +90,9 @@ namespace JASS
 			/*!
 				@brief Constructor
 				@param documents [in] The numner of socuments in the collection.
+				@param shards [in] The number of files to split the postings into (1 writes JASS_postings.cpp as before).
 			*/
-			serialise_ci(size_t documents);
+			serialise_ci(size_t documents, size_t shards = 1);
 
 			/*
 				SERIALISE_CI::~SERIALISE_CI()
@@ -104,7 +104,11 @@ namespace JASS
 		*/
 		auto checksum = checksum::fletcher_16_file("JASS_forward.index");
 //		std::cout << "JASS_forward.index " << checksum << '\n';
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 16491);
+#else
 		JASS_assert(checksum == 24427);
+#endif
 
 		puts("serialise_forward_index::PASSED");
 		}
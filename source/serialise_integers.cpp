@@ -85,8 +85,13 @@ namespace JASS
 	*/
 	void serialise_integers::unittest(void)
 		{
+#ifdef HASH_TABLE_OPEN
+		unittest_one_collection(unittest_data::ten_documents, 34489);
+		unittest_one_collection(unittest_data::three_documents_asymetric, 39442);
+#else
 		unittest_one_collection(unittest_data::ten_documents, 42937);
 		unittest_one_collection(unittest_data::three_documents_asymetric, 7698);
+#endif
 
 		puts("serialise_integers::PASSED");
 		}
@@ -11,6 +11,8 @@
 #include "allocator.h"
 #include "serialise_jass_v1.h"
 #include "compress_integer_all.h"
+#include "compress_integer_blocked.h"
+#include "compress_integer_adaptive.h"
 #include "index_manager_sequential.h"
 
 namespace JASS
@@ -238,8 +240,10 @@ namespace JASS
 		SERIALISE_JASS_V1::GET_COMPRESSOR()
 		-----------------------------------
 	*/
-	std::unique_ptr<compress_integer> serialise_jass_v1::get_compressor(jass_v1_codex codex, std::string &name, int32_t &d_ness)
+	std::unique_ptr<compress_integer> serialise_jass_v1::get_compressor(jass_v1_codex codex, std::string &name, int32_t &d_ness, bool blocked)
 		{
+		std::unique_ptr<compress_integer> compressor;
+
 		d_ness = 1;
 		switch (codex)
 			{
@@ -259,11 +263,34 @@ namespace JASS
 				name = "None";
 				d_ness = 0;
 				break;
+			case serialise_jass_v1::jass_v1_codex::adaptive:
+				name = "Adaptive (best codex per sequence)";
+				break;
+			case serialise_jass_v1::jass_v1_codex::adaptive_cost:
+				name = "Adaptive cost model (best size / decode time per sequence)";
+				compressor = std::make_unique<compress_integer_adaptive>(compress_integer_adaptive::cost_model);
+				break;
+			case serialise_jass_v1::jass_v1_codex::elias_fano:
+				name = "Elias-Fano";
+				break;
+			case serialise_jass_v1::jass_v1_codex::elias_fano_partitioned:
+				name = "Partitioned Elias-Fano";
+				break;
+			case serialise_jass_v1::jass_v1_codex::stream_vbyte_d1:
+				name = "Stream VByte D1";
+				break;
 			default:
 				exit(printf("Unknown index format\n"));
 			}
 
-		return compress_integer_all::get_by_name(name);
+		if (compressor == nullptr)
+			compressor = compress_integer_all::get_by_name(name);
+
+		if (!blocked)
+			return compressor;
+
+		name = "Blocked " + name;
+		return std::make_unique<compress_integer_blocked>(std::move(compressor));
 		}
 
 	/*
@@ -292,20 +319,42 @@ namespace JASS
 		*/
 		auto checksum = checksum::fletcher_16_file("CIvocab.bin");
 //std::cout << "CIvocab.bin checksum:" << checksum << "\n";
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 13236);
+#else
 		JASS_assert(checksum == 10231);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIvocab_terms.bin");
 //std::cout << "CIvocab_terms.bin checksum:" << checksum << "\n";
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 51169);
+#else
 		JASS_assert(checksum == 25057);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIpostings.bin");
 //std::cout << "CIpostings.bin checksum:" << checksum << "\n";
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 28633);
+#else
 		JASS_assert(checksum == 43058);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIdoclist.bin");
 //std::cout << "CIdoclist.bin checksum:" << checksum << "\n";
 		JASS_assert(checksum == 3045);
 
+		/*
+			The two adaptive codexes must report different names
+		*/
+		std::string adaptive_name;
+		std::string adaptive_cost_name;
+		int32_t d_ness;
+		get_compressor(jass_v1_codex::adaptive, adaptive_name, d_ness, false);
+		get_compressor(jass_v1_codex::adaptive_cost, adaptive_cost_name, d_ness, false);
+		JASS_assert(adaptive_name != adaptive_cost_name);
+
 		puts("serialise_jass_v1::PASSED");
 		}
 	}
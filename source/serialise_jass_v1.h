@@ -66,6 +66,15 @@ namespace JASS
 		seperately. These lists do not have the impact score stored at the start and do not have 0 terminators on them. This 
 		means score-at-a-time processing is the only paradigm, even if term-at-a-time processing is done score-at-a-time for 
 		each term. ATIRE could do either (but it was a compile time flag).
+
+		When the codex is A or a (adaptive), each segment is compressed using whichever codex suits it best, and the first byte
+		of each compressed segment is a tag identifying that codex (see compress_integer_adaptive).
+
+		When the first byte of CIpostings.bin is b (blocked), the second byte is the codex and each long segment is broken into
+		blocks, each compressed separately, with a table of skip entries at the start (see compress_integer_blocked).
+
+		When the first byte of CIpostings.bin is h (JASS v2 only), the impact headers are in the compact format (see
+		serialise_jass_v2) and the remainder of the file is as described above (starting with b or the codex).
 	*/
 	class serialise_jass_v1 : public index_manager::delegate
 		{
@@ -139,7 +148,14 @@ namespace JASS
 				qmx_d0 = 'R',						///< Postings are compressed using QMX without delta encoding.
 				elias_gamma_simd = 'G',			///< Postings are compressed using Elias gamma SIMD encoding.
 				elias_gamma_simd_vb = 'g',		///< Postings are compressed using Elias gamma SIMD encoding with variable byte endings.
-				elias_delta_simd = 'D'			///< Postings are compressed using Elias delta SIMD encoding.
+				elias_delta_simd = 'D',			///< Postings are compressed using Elias delta SIMD encoding.
+				adaptive = 'A',					///< Each segment is compressed with the codex that results in the smallest encoding (see compress_integer_adaptive).
+				adaptive_cost = 'a',				///< Each segment is compressed with the codex that has the best size / decoding time trade-off (see compress_integer_adaptive).
+				elias_fano = 'f',					///< Postings are compressed using Elias-Fano encoding of the document ids.
+				elias_fano_partitioned = 'p',	///< Postings are compressed using partitioned Elias-Fano encoding of the document ids.
+				stream_vbyte_d1 = 'V',			///< Postings are compressed using Stream VByte, decoded with the prefix sum in the decode kernel.
+				blocked = 'b',						///< Not a codex, a prefix. Long segments are blocked with skip entries (see compress_integer_blocked), the next byte is the codex.
+				compact_headers = 'h'			///< Not a codex, a prefix (JASS v2 only). The impact headers are in the compact format (see serialise_jass_v2), the next byte is b or the codex.
 				};
 
 		protected:
@@ -175,7 +191,7 @@ namespace JASS
 			*/
 			virtual size_t write_postings(const index_postings &postings, size_t &number_of_impacts, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies);
 
-		public:
+		protected:
 			/*
 				SERIALISE_JASS_V1::SERIALISE_JASS_V1()
 				--------------------------------------
@@ -185,8 +201,10 @@ namespace JASS
 				@param documents [in] The number of documents in the collection (used to allocate re-usable buffers).
 				@param encoder [in] An shared pointer to a codex responsible for performing the compression of postings lists (default = compress_integer_QMX_jass_v1()).
 				@param alignment [in] The start address of a postings list is padded to start on these boundaries (needed for compress_integer_QMX_jass_v1 (use 16), and others).  Default = 0.
+				@param blocked [in] Break long segments into blocks with skip entries (see compress_integer_blocked).
+				@param compact_headers [in] Write the jass_v1_codex::compact_headers prefix (used by serialise_jass_v2, which writes the headers).
 			*/
-			serialise_jass_v1(size_t documents, jass_v1_codex codex = jass_v1_codex::elias_gamma_simd, int8_t alignment = 1) :
+			serialise_jass_v1(size_t documents, jass_v1_codex codex, int8_t alignment, bool blocked, bool compact_headers) :
 				index_manager::delegate(documents),
 				vocabulary_strings("CIvocab_terms.bin", "w+b"),
 				vocabulary("CIvocab.bin", "w+b"),
@@ -194,7 +212,7 @@ namespace JASS
 				primary_keys("CIdoclist.bin", "w+b"),
 				memory(1024 * 1024),								///< The allocation block size is currently 1MB, big enough for most postings lists (but it'll grow for larger ones).
 				impact_ordered(documents, memory),
-				encoder(get_compressor(codex, compressor_name, compressor_d_ness)),
+				encoder(get_compressor(codex, compressor_name, compressor_d_ness, blocked)),
 				allocator(memory),
 				compressed_buffer(allocator),
 				compressed_segments(allocator),
@@ -226,9 +244,37 @@ namespace JASS
 
 // std::cout << compressor_name << "-D" << compressor_d_ness << "\n";
 
+				if (compact_headers)
+					{
+					uint8_t prefix = jass_v1_codex::compact_headers;
+					postings.write(&prefix, 1);
+					}
+				if (blocked)
+					{
+					uint8_t prefix = jass_v1_codex::blocked;
+					postings.write(&prefix, 1);
+					}
 				postings.write(&codex, 1);
 				}
 
+		public:
+			/*
+				SERIALISE_JASS_V1::SERIALISE_JASS_V1()
+				--------------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param documents [in] The number of documents in the collection (used to allocate re-usable buffers).
+				@param encoder [in] An shared pointer to a codex responsible for performing the compression of postings lists (default = compress_integer_QMX_jass_v1()).
+				@param alignment [in] The start address of a postings list is padded to start on these boundaries (needed for compress_integer_QMX_jass_v1 (use 16), and others).  Default = 0.
+				@param blocked [in] Break long segments into blocks with skip entries (see compress_integer_blocked).  Default = false.
+			*/
+			serialise_jass_v1(size_t documents, jass_v1_codex codex = jass_v1_codex::elias_gamma_simd, int8_t alignment = 1, bool blocked = false) :
+				serialise_jass_v1(documents, codex, alignment, blocked, false)
+				{
+				/* Nothing */
+				}
+
 			/*
 				SERIALISE_JASS_V1::~SERIALISE_JASS_V1()
 				--------------------------------------
@@ -303,9 +349,10 @@ namespace JASS
 				@param codex [in] The codex to use
 				@param name [out] The name of the compression codex
 				@param d_ness [out] Whether the codex requires D0, D1, etc decoding (-1 if it supports decode_and_process via decode_none)
+				@param blocked [in] Wrap the codex in a compress_integer_blocked (default = false)
 				@return A reference to a compress_integer that can decode the given codex
 			*/
-			static std::unique_ptr<compress_integer> get_compressor(jass_v1_codex codex, std::string &name, int32_t &d_ness);
+			static std::unique_ptr<compress_integer> get_compressor(jass_v1_codex codex, std::string &name, int32_t &d_ness, bool blocked = false);
 
 			/*
 				SERIALISE_JASS_V1::UNITTEST()
@@ -4,6 +4,9 @@
 	Copyright (c) 2016 Andrew Trotman
 	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
 */
+#include <limits>
+#include <string>
+#include <vector>
 #include <algorithm>
 
 #include "reverse.h"
@@ -11,6 +14,8 @@
 #include "allocator.h"
 #include "serialise_jass_v2.h"
 #include "compress_integer_all.h"
+#include "compress_integer_stream_vbyte.h"
+#include "deserialised_jass_v2.h"
 #include "index_manager_sequential.h"
 
 namespace JASS
@@ -69,6 +74,9 @@ namespace JASS
 			compress_into_size -= took;
 			}
 
+		if (compact_headers)
+			return write_compact_postings();
+
 		/*
 			Build all the headers
 		*/
@@ -130,6 +138,65 @@ namespace JASS
 		return postings_location;
 		}
 
+	/*
+		SERIALISE_JASS_V2::WRITE_COMPACT_POSTINGS()
+		-------------------------------------------
+	*/
+	size_t serialise_jass_v2::write_compact_postings(void)
+		{
+		/*
+			The headers (and segments) are stored highest impact first, compressed_segments is in impact_ordered order (lowest first).
+		*/
+		size_t segments = compressed_segments.size();
+		compact_header_integers.resize(3 * segments);
+		uint64_t postings_length = 0;
+		size_t which = 0;
+		for (const auto &impact : reverse(impact_ordered))
+			{
+			const slice &segment = compressed_segments[segments - 1 - which];
+			compact_header_integers[which] = static_cast<compress_integer::integer>(impact.impact_score);
+			compact_header_integers[segments + which] = static_cast<compress_integer::integer>(impact.size());
+			compact_header_integers[2 * segments + which] = static_cast<compress_integer::integer>(segment.size());
+			postings_length += segment.size();
+			which++;
+			}
+
+		/*
+			The segment offsets are computed (at query time) as a 32-bit prefix sum of the lengths
+		*/
+		if (postings_length > (std::numeric_limits<uint32_t>::max)())
+			{
+			std::cout <<  "Postings list is too long for compact impact headers" << std::ends;
+			exit(1);
+			}
+
+		compact_header_buffer.resize(compress_integer_stream_vbyte::bytes_needed_for(compact_header_integers.size()));
+		size_t header_size = compress_integer_stream_vbyte::compress_into(compact_header_buffer.data(), compact_header_integers.data(), compact_header_integers.size());
+
+		/*
+			Pad to the start of the next cache line if the headers would otherwise straddle more cache lines than they need to.
+		*/
+		size_t postings_location = postings.tell();
+		size_t lines_needed = (header_size + cache_line_size - 1) / cache_line_size;
+		size_t lines_straddled = (postings_location % cache_line_size + header_size + cache_line_size - 1) / cache_line_size;
+		if (lines_straddled > lines_needed)
+			{
+			static const uint8_t zeros[cache_line_size] = {};
+			size_t padding = cache_line_size - postings_location % cache_line_size;
+			postings.write(zeros, padding);
+			postings_location += padding;
+			}
+
+		/*
+			Write the headers then the segments
+		*/
+		postings.write(compact_header_buffer.data(), header_size);
+		for (const auto &segment : reverse(compressed_segments))
+			postings.write(segment.address(), segment.size());
+
+		return postings_location;
+		}
+
 	/*
 		SERIALISE_JASS_V2::OPERATOR()()
 		-------------------------------
@@ -240,19 +307,80 @@ namespace JASS
 		*/
 		auto checksum = checksum::fletcher_16_file("CIvocab.bin");
 //std::cout << "CIvocab.bin checksum:" << checksum << "\n";
-		JASS_assert(checksum == 10231);
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 6539);
+#else
+		JASS_assert(checksum == 18561);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIvocab_terms.bin");
 //std::cout << "CIvocab_terms.bin checksum:" << checksum << "\n";
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 51169);
+#else
 		JASS_assert(checksum == 25057);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIpostings.bin");
 //std::cout << "CIpostings.bin checksum:" << checksum << "\n";
-		JASS_assert(checksum == 43058);
+#ifdef HASH_TABLE_OPEN
+		JASS_assert(checksum == 31884);
+#else
+		JASS_assert(checksum == 56716);
+#endif
 
 		checksum = checksum::fletcher_16_file("CIdoclist.bin");
 //std::cout << "CIdoclist.bin checksum:" << checksum << "\n";
-		JASS_assert(checksum == 3045);
+		JASS_assert(checksum == 38775);
+
+		/*
+			The compact impact headers must describe the same segments as the variable byte headers
+		*/
+		auto postings_as_string = [](void)
+			{
+			deserialised_jass_v2 deserialised;
+			deserialised.read_index();
+			std::string name;
+			int32_t d_ness;
+			auto decoder = deserialised.codex(name, d_ness);
+			std::vector<compress_integer::integer> document_ids(1024);
+			std::string answer;
+
+			for (const auto &term : deserialised)
+				{
+				std::vector<deserialised_jass_v1::segment_header> headers(term.impacts);
+				deserialised_jass_v1::metadata metadata = term;
+				uint32_t smallest;
+				uint32_t largest;
+				query::DOCID_TYPE document_frequency;
+
+				JASS_assert(deserialised.get_segment_list(headers.data(), metadata, 2, smallest, largest, document_frequency) == term.impacts);
+				answer += std::string(reinterpret_cast<const char *>(term.term.address()), term.term.size()) + ":" + std::to_string(smallest) + "," + std::to_string(largest) + "," + std::to_string(document_frequency);
+				for (const auto &header : headers)
+					{
+					decoder->decode(document_ids.data(), header.segment_frequency, deserialised.postings() + header.offset, header.end - header.offset);
+					answer += " <" + std::to_string(header.impact) + ">";
+					for (size_t which = 0; which < header.segment_frequency; which++)
+						answer += " " + std::to_string(document_ids[which]);
+					}
+				answer += "\n";
+				}
+			return answer;
+			};
+
+		std::string expected;
+		for (bool compact : {false, true})
+			{
+			{
+			serialise_jass_v2 serialiser(index.get_highest_document_id(), jass_v1_codex::elias_gamma_simd_vb, 1, false, compact);
+			index.iterate(serialiser);
+			serialiser.finish();
+			}
+			if (!compact)
+				expected = postings_as_string();
+			else
+				JASS_assert(postings_as_string() == expected);
+			}
 
 		puts("serialise_jass_v2::PASSED");
 		}
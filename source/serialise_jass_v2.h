@@ -22,12 +22,27 @@ namespace JASS
 	*/
 	/*!
 		@brief Serialise an index in the format used by JASS version 2 (a better compressed JASS v1 format).
-		@details See description for serialise_jass_v1.
+		@details See description for serialise_jass_v1.  In JASS v2 each postings list is its impact headers (highest impact first)
+		followed by the segments.  Each header is the variable byte encoded impact score, offset of the segment (from the end of the
+		header), length of the segment, and number of documents in the segment.
+
+		With compact headers (the jass_v1_codex::compact_headers prefix) the headers of a postings list are instead stored together as
+		one Stream VByte encoded sequence of 3 * impacts integers: the impact scores, then the segment frequencies, then the segment
+		lengths (all highest impact first).  The segments follow (in the same order) so the offset of each segment is the sum of the
+		lengths of those before it.  Impact scores (255 or less) and most frequencies take a byte each (plus 2 bits) and the whole block is
+		decoded (and the lengths prefix summed) with SIMD instructions in deserialised_jass_v2::get_segment_list().  The block is
+		padded to start on a cache line boundary if that reduces the number of cache lines it straddles.
 	*/
 	class serialise_jass_v2 : public serialise_jass_v1
 		{
+		protected:
+			static constexpr size_t cache_line_size = 64;		///< Compact headers are aligned so as to straddle as few cache lines of this size as possible.
+
 		protected:
 			std::vector<slice, allocator_cpp<slice>> compressed_headers;
+			bool compact_headers;													///< Write the impact headers in the compact format.
+			std::vector<compress_integer::integer> compact_header_integers;	///< The impacts, frequencies, and lengths of the segments of the current postings list.
+			std::vector<uint8_t> compact_header_buffer;						///< The Stream VByte encoded compact_header_integers.
 
 		protected:
 			/*
@@ -45,6 +60,16 @@ namespace JASS
 			*/
 			virtual size_t write_postings(const index_postings &postings, size_t &number_of_impacts, compress_integer::integer document_frequency, compress_integer::integer *document_ids, index_postings_impact::impact_type *term_frequencies);
 
+			/*
+				SERIALISE_JASS_V2::WRITE_COMPACT_POSTINGS()
+				-------------------------------------------
+			*/
+			/*!
+				@brief Serialise the (already compressed) segments of impact_ordered with compact headers.
+				@return The location (in CIpostings.bin) of the start of the serialised postings list.
+			*/
+			size_t write_compact_postings(void);
+
 		public:
 			/*
 				SERIALISE_JASS_V2::SERIALISE_JASS_V2()
@@ -55,10 +80,13 @@ namespace JASS
 				@param documents [in] The number of documents in the collection (used to allocate re-usable buffers).
 				@param encoder [in] An shared pointer to a codex responsible for performing the compression of postings lists (default = compress_integer_QMX_jass_v1()).
 				@param alignment [in] The start address of a postings list is padded to start on these boundaries (needed for compress_integer_QMX_jass_v1 (use 16), and others).  Default = 0.
+				@param blocked [in] Break long segments into blocks with skip entries so that a compress_integer_blocked::cursor can skip to a document id.  Default = false.
+				@param compact_headers [in] Store the impact headers in the compact (Stream VByte) format.  Default = false.
 			*/
-			serialise_jass_v2(size_t documents, jass_v1_codex codex = jass_v1_codex::elias_gamma_simd_vb, int8_t alignment = 1) :
-				serialise_jass_v1(documents, codex, alignment),
-				compressed_headers(allocator)
+			serialise_jass_v2(size_t documents, jass_v1_codex codex = jass_v1_codex::elias_gamma_simd_vb, int8_t alignment = 1, bool blocked = false, bool compact_headers = false) :
+				serialise_jass_v1(documents, codex, alignment, blocked, compact_headers),
+				compressed_headers(allocator),
+				compact_headers(compact_headers)
 				{
 				/* Nothing */
 				}
@@ -18,9 +18,11 @@
 #include <immintrin.h>
 
 #include <iostream>
+#include <algorithm>
 
 #include "asserts.h"
 #include "forceinline.h"
+#include "hardware_support.h"
 
 /*
 	Here we can choose between individual writes or block writes on AVX512:
@@ -141,7 +143,6 @@ namespace JASS
 				return _mm256_i32gather_epi32((int const *)array, vindex, 4);
 				}
 
-#ifdef __AVX512F__
 			/*
 				SIMD::GATHER()
 				--------------
@@ -153,7 +154,7 @@ namespace JASS
 				@param a [in] The value to split and scatter.
 				@return The 16 integers
 			*/
-			forceinline static __m512i gather(const uint8_t *array, __m512i vindex)
+			JASS_TARGET_AVX512 forceinline static __m512i gather(const uint8_t *array, __m512i vindex)
 				{
 				return _mm512_maskz_mov_epi8((__mmask64)0x1111'1111'1111'1111, _mm512_i32gather_epi32(vindex, array, 1));
 				}
@@ -169,7 +170,7 @@ namespace JASS
 				@param a [in] The value to split and scatter.
 				@return The 16 integers
 			*/
-			forceinline static __m512i gather(const uint16_t *array, __m512i vindex)
+			JASS_TARGET_AVX512 forceinline static __m512i gather(const uint16_t *array, __m512i vindex)
 				{
 				__m512i got = _mm512_i32gather_epi32(vindex, array, 2);
 				__m512i answer = _mm512_maskz_mov_epi16((__mmask32)0x5555'5555, got);
@@ -187,11 +188,10 @@ namespace JASS
 				@param a [in] The value to split and scatter.
 				@return The 16 integers
 			*/
-			forceinline static __m512i gather(const uint32_t *array, __m512i vindex)
+			JASS_TARGET_AVX512 forceinline static __m512i gather(const uint32_t *array, __m512i vindex)
 				{
 				return _mm512_i32gather_epi32(vindex, array, 4);
 				}
-#endif
 
 			/*
 				SIMD::SCATTER()
@@ -345,7 +345,6 @@ namespace JASS
 				scatter(array, _mm256_extracti128_si256(vindex, 1), _mm256_extracti128_si256(a, 1));
 #endif
 				}
-#ifdef __AVX512F__
 			/*
 				SIMD::SCATTER()
 				---------------
@@ -356,9 +355,9 @@ namespace JASS
 				@param vindex [in] The indexes into the array to write into
 				@param a [in] The value to split and scatter (16 x 8-bit integers written as 16 x 32-bit integers)
 			*/
-			forceinline static void scatter(uint8_t *array, __m512i vindex, __m512i a)
+			JASS_TARGET_AVX512 forceinline static void scatter(uint8_t *array, __m512i vindex, __m512i a)
 				{
-#if defined(USE_AXV512_WRITES_8) && defined(__AVX512F__)
+#ifdef USE_AXV512_WRITES_8
 				__m512i low_two_bits = _mm512_and_epi32(vindex, _mm512_set1_epi32(3));
 
 				__mmask16 zero = _mm512_cmp_epi32_mask(low_two_bits, _mm512_setzero_si512(), _MM_CMPINT_EQ);
@@ -398,9 +397,9 @@ namespace JASS
 				@param vindex [in] The indexes into the array to write into
 				@param a [in] The value to split and scatter (16 x 16-bit integers written as 16 x 32-bit integers)
 			*/
-			forceinline static void scatter(uint16_t *array, __m512i vindex, __m512i a)
+			JASS_TARGET_AVX512 forceinline static void scatter(uint16_t *array, __m512i vindex, __m512i a)
 				{
-#if defined(USE_AXV512_WRITES_16) && defined(__AVX512F__)
+#ifdef USE_AXV512_WRITES_16
 				__mmask16 odd = _mm512_test_epi32_mask(vindex, _mm512_set1_epi32(1));
 
 				__m512i was_odd = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), ~odd, vindex, array, 2);
@@ -432,7 +431,7 @@ namespace JASS
 				@param a [in] The value to split and scatter (16 x 32-bit integers written as 16 x 32-bit integers)
 			*/
 
-			forceinline static void scatter(uint32_t *array, __m512i vindex, __m512i a)
+			JASS_TARGET_AVX512 forceinline static void scatter(uint32_t *array, __m512i vindex, __m512i a)
 				{
 				/*
 					On "Intel(R) Core(TM) i7-9800X CPU @ 3.80GHz" this is faster than individual writes for both adjacent
@@ -440,7 +439,28 @@ namespace JASS
 				*/
 				_mm512_i32scatter_epi32(array, vindex, a, 4);
 				}
-#endif
+
+			/*
+				SIMD::CUMULATIVE_SUM()
+				----------------------
+			*/
+			/*!
+				@brief Calculate the cumulative sum of the 32-bit integers in an SSE register.
+				@param elements [in] The 32-bit integers.
+				@return An SSE register holding the cumulative sums.
+			*/
+			forceinline static __m128i cumulative_sum(__m128i elements)
+				{
+				/*
+					A B C D
+					0 A B C
+					0 0 A AB
+				*/
+				elements = _mm_add_epi32(elements, _mm_slli_si128(elements, 4));
+				elements = _mm_add_epi32(elements, _mm_slli_si128(elements, 8));
+
+				return elements;
+				}
 
 			/*
 				SIMD::CUMULATIVE_SUM()
@@ -487,7 +507,6 @@ namespace JASS
 
 				return answer;
 				}
-#ifdef __AVX512F__
 			/*
 				SIMD::CUMULATIVE_SUM()
 				----------------------
@@ -497,7 +516,7 @@ namespace JASS
 				@param elements [in] The 32-bit integers.
 				@return An AVX512 register holding the cumulative sums.
 			*/
-			forceinline static __m512i cumulative_sum(__m512i elements)
+			JASS_TARGET_AVX512 forceinline static __m512i cumulative_sum(__m512i elements)
 				{
 				/*
 					shift left by 1 integer and add
@@ -544,12 +563,13 @@ namespace JASS
 				@param data [in/out] The integers to sum (and result).
 				@param length [in] The number of integrers to sum.
 			*/
-			static void cumulative_sum_512(uint32_t *data, size_t length)
+			JASS_TARGET_AVX512 static void cumulative_sum_512(uint32_t *data, size_t length)
 				{
 				/*
 					previous cumulative sum is zero
 				*/
 				__m512i previous_max = _mm512_setzero_si512();
+				const __m512i last = _mm512_set1_epi32(15);
 
 				/*
 					Loop over all the data (going too far if necessary)
@@ -568,23 +588,18 @@ namespace JASS
 					current_set = cumulative_sum(current_set);
 
 					/*
-						add the previous maximum to each of them
+						add the previous maximum to each of them and write back out to the same location we read from
 					*/
-					current_set = _mm512_add_epi32(current_set, previous_max);
+					_mm512_storeu_si512(block, _mm512_add_epi32(current_set, previous_max));
 
 					/*
-						and write back out to the same location we read from
+						Broadcast the largest number of this block (before the carry is added) and add it to the carry.  This keeps the
+						permute off the loop-carried dependency chain, which is now just one add per block.
 					*/
-					_mm512_storeu_si512(block, current_set);
-
-					/*
-						Broadcast the largest number from the result for next time
-					*/
-					previous_max = _mm512_maskz_permutexvar_epi32((__mmask16)0xFFFF, _mm512_set1_epi32(0x0F), current_set);
+					previous_max = _mm512_add_epi32(previous_max, _mm512_maskz_permutexvar_epi32((__mmask16)0xFFFF, last, current_set));
 					}
 				}
 
-#endif
 			/*
 				SIMD::CUMULATIVE_SUM_256()
 				--------------------------
@@ -601,6 +616,7 @@ namespace JASS
 					previous cumulative sum is zero
 				*/
 				__m256i previous_max = _mm256_setzero_si256();
+				const __m256i last = _mm256_set1_epi32(7);
 
 				/*
 					Loop over all the data (going too far if necessary)
@@ -619,23 +635,89 @@ namespace JASS
 					current_set = cumulative_sum(current_set);
 
 					/*
-						add the previous maximum to each of them
+						add the previous maximum to each of them and write back out to the same location we read from
 					*/
-					current_set = _mm256_add_epi32(current_set, previous_max);
+					_mm256_storeu_si256(block, _mm256_add_epi32(current_set, previous_max));
 
 					/*
-						and write back out to the same location we read from
+						Broadcast the largest number of this block (before the carry is added) and add it to the carry.  This keeps the
+						permute off the loop-carried dependency chain, which is now just one add per block.
 					*/
-					_mm256_storeu_si256(block, current_set);
-
-					/*
-						Broadcast the largest number from the result for next time
-					*/
-					current_set = _mm256_shuffle_epi32(current_set, _MM_SHUFFLE(3, 3, 3, 3));
-					previous_max = _mm256_permute2x128_si256(current_set, current_set, 3 | (3 << 4));
+					previous_max = _mm256_add_epi32(previous_max, _mm256_permutevar8x32_epi32(current_set, last));
 					}
 				}
-#ifdef __AVX512F__
+
+			/*
+				SIMD::CUMULATIVE_SUM_FUNCTION
+				-----------------------------
+			*/
+			/*!
+				@brief The signature of cumulative_sum_256() and cumulative_sum_512().
+			*/
+			typedef void (*cumulative_sum_function)(uint32_t *data, size_t length);
+
+			/*
+				SIMD::CHOOSE_CUMULATIVE_SUM()
+				-----------------------------
+			*/
+			/*!
+				@brief Return the best cumulative sum for the given instruction set.
+				@param level [in] The instruction set to use.
+				@return cumulative_sum_512 for AVX-512, otherwise cumulative_sum_256.
+			*/
+			static cumulative_sum_function choose_cumulative_sum(hardware_support::simd_level level)
+				{
+				return level >= hardware_support::avx512 ? cumulative_sum_512 : cumulative_sum_256;
+				}
+
+			inline static hardware_support::simd_level level = hardware_support::best_simd();								///< The instruction set the runtime-dispatched kernels use (see set_simd_level()).
+			inline static cumulative_sum_function cumulative_sum_best = choose_cumulative_sum(level);		///< The cumulative sum for level.
+
+			/*
+				SIMD::SET_SIMD_LEVEL()
+				----------------------
+			*/
+			/*!
+				@brief Choose the instruction set used by the runtime-dispatched kernels (cumulative_sum() of an array, and the AVX-512 sort).
+				@details This is set (on startup) to hardware_support::best_simd(), so a binary built for AVX2 (see JASS_PORTABLE in CMakeLists.txt)
+				uses the AVX-512 kernels on a CPU that has them.  The search engine calls this when it loads the index.  Asking for a level
+				higher than the CPU supports lowers it to what the CPU supports.
+				@param new_level [in] The instruction set to use.
+			*/
+			static void set_simd_level(hardware_support::simd_level new_level)
+				{
+				level = (std::min)(new_level, hardware_support::detected().simd());
+				cumulative_sum_best = choose_cumulative_sum(level);
+				}
+
+			/*
+				SIMD::GET_SIMD_LEVEL()
+				----------------------
+			*/
+			/*!
+				@brief Return the instruction set used by the runtime-dispatched kernels.
+				@return The SIMD level.
+			*/
+			static hardware_support::simd_level get_simd_level(void)
+				{
+				return level;
+				}
+
+			/*
+				SIMD::CUMULATIVE_SUM()
+				----------------------
+			*/
+			/*!
+				@brief Calculate (inplace) the cumulative sum of the array of integers using the best instruction set (see set_simd_level()).
+				@details This can read and write up to 15 integers past the end of the array.
+				@param data [in/out] The integers to sum (and result).
+				@param length [in] The number of integrers to sum.
+			*/
+			forceinline static void cumulative_sum(uint32_t *data, size_t length)
+				{
+				cumulative_sum_best(data, length);
+				}
+
 			/*
 				SIMD::POPCOUNT()
 				----------------
@@ -648,7 +730,7 @@ namespace JASS
 					see W. Mula, N. Kurz, D. Lemire (2018) Faster Population Counts Using AVX2 Instructions, Computer Journal 61(1):111-120
 				@return 32-bit integers holding the population count.
 			*/
-			forceinline static __m512i popcount(__m512i value)
+			JASS_TARGET_AVX512 forceinline static __m512i popcount(__m512i value)
 				{
 #ifdef NEVER
 				/*
@@ -691,7 +773,6 @@ namespace JASS
 				return _mm512_madd_epi16(_mm512_maddubs_epi16(sum8, _mm512_set1_epi8(1)), _mm512_set1_epi16(1));
 #endif
 				}
-#endif
 
 #ifdef __AVX512F__
 			/*
@@ -824,6 +905,37 @@ namespace JASS
 				uint32_t sum_answer[8] = {0, 1, 3, 6, 10, 15, 21, 28};
 				JASS_assert(::memcmp(destination_32, sum_answer, sizeof(sum_answer)) == 0);
 
+				/*
+					Check the array cumulative sums over several blocks (the carry from block to block), each of which may overrun the end.
+				*/
+				uint32_t sequence[100 + 16];
+				uint32_t expected[100];
+				uint32_t running_total = 0;
+				for (uint32_t pos = 0; pos < 100; pos++)
+					expected[pos] = running_total += pos * 7 + 1;
+
+				auto check_cumulative_sum = [&](cumulative_sum_function method)
+					{
+					for (uint32_t pos = 0; pos < 100; pos++)
+						sequence[pos] = pos * 7 + 1;
+					method(sequence, 100);
+					JASS_assert(::memcmp(sequence, expected, sizeof(expected)) == 0);
+					};
+
+				check_cumulative_sum(cumulative_sum_256);
+				if (hardware_support::detected().simd() >= hardware_support::avx512)
+					check_cumulative_sum(cumulative_sum_512);
+				check_cumulative_sum(cumulative_sum);
+
+				auto previous_level = get_simd_level();
+				set_simd_level(hardware_support::avx2);
+				JASS_assert(get_simd_level() <= hardware_support::avx2);
+				check_cumulative_sum(cumulative_sum);
+				set_simd_level(hardware_support::avx512);
+				JASS_assert(get_simd_level() == hardware_support::detected().simd());
+				check_cumulative_sum(cumulative_sum);
+				set_simd_level(previous_level);
+
 #ifdef __AVX512F__
 				uint32_t numbers[] = {0, 1, 3, 7, 15, 31, 63, 127, 255, 511, 1023, 2047, 4095, 8191, 16383, 32767};
 				__m512i bit_vector = _mm512_loadu_si512(numbers);
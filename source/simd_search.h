@@ -0,0 +1,191 @@
+/*
+	SIMD_SEARCH.H
+	-------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Find a short string (such as an SGML tag) in a long buffer using SIMD instructions.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <string>
+#include <algorithm>
+
+#include "asserts.h"
+#include "forceinline.h"
+
+namespace JASS
+	{
+	/*
+		CLASS SIMD_SEARCH
+		-----------------
+	*/
+	/*!
+		@brief Find a short string (such as an SGML tag) in a long buffer using SIMD instructions.
+		@details This is the method of W. Mula (see: http://0x80.pl/articles/simd-strfind.html).  The first and the last byte of the pattern are
+		broadcast into registers and compared to 32 (AVX2) or 64 (AVX-512) consecutive positions in the buffer at once.  Positions where both match are
+		candidates and are checked with memcmp().  Because tags such as <DOC> are rare in the text, there are very few candidates and the search
+		runs at close to memory bandwidth.  The tail of the buffer (too short for a full register) is searched with std::search().
+	*/
+	class simd_search
+		{
+		private:
+			/*
+				SIMD_SEARCH::VERIFY()
+				---------------------
+			*/
+			/*!
+				@brief Check each candidate in a bitmask of candidates, returning the first that matches.
+				@param candidates [in] A bitmask, bit i set if position + i is a candidate.
+				@param position [in] The position in the buffer that bit 0 represents.
+				@param pattern [in] The pattern being looked for.
+				@param pattern_length [in] The length of the pattern.
+				@return The first location of the pattern, or nullptr if none of the candidates match.
+			*/
+			forceinline static const uint8_t *verify(uint64_t candidates, const uint8_t *position, const uint8_t *pattern, size_t pattern_length)
+				{
+				while (candidates != 0)
+					{
+					const uint8_t *candidate = position + _tzcnt_u64(candidates);
+					if (memcmp(candidate + 1, pattern + 1, pattern_length - 2) == 0)
+						return candidate;
+					candidates = _blsr_u64(candidates);
+					}
+
+				return nullptr;
+				}
+
+		public:
+			/*
+				SIMD_SEARCH::FIND()
+				-------------------
+			*/
+			/*!
+				@brief Find the first occurrence of pattern in the buffer between start and end (like std::search()).
+				@param start [in] The start of the buffer to search.
+				@param end [in] The end of the buffer to search (one past the last byte).
+				@param pattern [in] The string to look for.
+				@param pattern_length [in] The length of the string to look for.
+				@return A pointer to the start of the first occurrence of pattern, or end if it does not occur.
+			*/
+			static const uint8_t *find(const uint8_t *start, const uint8_t *end, const uint8_t *pattern, size_t pattern_length)
+				{
+				/*
+					Single character (and empty) patterns are not worth vectorising here.
+				*/
+				if (pattern_length < 2)
+					return std::search(start, end, pattern, pattern + pattern_length);
+
+				const uint8_t *current = start;
+
+#if defined(__AVX512BW__)
+				const __m512i first = _mm512_set1_epi8(static_cast<char>(pattern[0]));
+				const __m512i last = _mm512_set1_epi8(static_cast<char>(pattern[pattern_length - 1]));
+
+				while (end - current >= static_cast<ptrdiff_t>(pattern_length - 1 + 64))
+					{
+					__m512i block_first = _mm512_loadu_si512(current);
+					__m512i block_last = _mm512_loadu_si512(current + pattern_length - 1);
+					uint64_t candidates = _mm512_cmpeq_epi8_mask(block_first, first) & _mm512_cmpeq_epi8_mask(block_last, last);
+
+					if (candidates != 0)
+						if (const uint8_t *found = verify(candidates, current, pattern, pattern_length))
+							return found;
+					current += 64;
+					}
+#elif defined(__AVX2__)
+				const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+				const __m256i last = _mm256_set1_epi8(static_cast<char>(pattern[pattern_length - 1]));
+
+				while (end - current >= static_cast<ptrdiff_t>(pattern_length - 1 + 32))
+					{
+					__m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current));
+					__m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(current + pattern_length - 1));
+					uint32_t candidates = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+
+					if (candidates != 0)
+						if (const uint8_t *found = verify(candidates, current, pattern, pattern_length))
+							return found;
+					current += 32;
+					}
+#endif
+				/*
+					Search the tail
+				*/
+				return std::search(current, end, pattern, pattern + pattern_length);
+				}
+
+			/*
+				SIMD_SEARCH::FIND()
+				-------------------
+			*/
+			/*!
+				@brief Find the first occurrence of pattern in the buffer between start and end (like std::search()).
+				@param start [in] The start of the buffer to search.
+				@param end [in] The end of the buffer to search (one past the last byte).
+				@param pattern [in] The string to look for.
+				@return A pointer to the start of the first occurrence of pattern, or end if it does not occur.
+			*/
+			forceinline static uint8_t *find(uint8_t *start, uint8_t *end, const std::string &pattern)
+				{
+				return const_cast<uint8_t *>(find(start, end, reinterpret_cast<const uint8_t *>(pattern.c_str()), pattern.size()));
+				}
+
+			/*
+				SIMD_SEARCH::UNITTEST()
+				-----------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				/*
+					Place the pattern at every position in buffers of many lengths (so that it is found in the registers, straddling registers, and in the tail)
+					and check against std::search().  The buffer is full of near misses (the first and last characters of the pattern).
+				*/
+				const std::string pattern = "<DOCNO>";
+				for (size_t length = 0; length < 200; length++)
+					{
+					std::string buffer;
+					for (size_t character = 0; character < length; character++)
+						buffer.push_back("<>DOC"[character % 5]);
+
+					for (size_t where = 0; where + pattern.size() <= length; where += 3)
+						{
+						std::string haystack = buffer;
+						haystack.replace(where, pattern.size(), pattern);
+						uint8_t *start = reinterpret_cast<uint8_t *>(&haystack[0]);
+						uint8_t *end = start + haystack.size();
+						JASS_assert(find(start, end, pattern) == std::search(start, end, pattern.begin(), pattern.end()));
+						JASS_assert(find(start, end, pattern) - start <= static_cast<ptrdiff_t>(where));
+						}
+
+					uint8_t *start = reinterpret_cast<uint8_t *>(&buffer[0]);
+					uint8_t *end = start + buffer.size();
+					JASS_assert(find(start, end, pattern) == end);
+					}
+
+				/*
+					Short patterns
+				*/
+				std::string haystack = "0123456789012345678901234567890123456789012345678901234567890123456789abcdefghij";
+				uint8_t *start = reinterpret_cast<uint8_t *>(&haystack[0]);
+				uint8_t *end = start + haystack.size();
+				JASS_assert(find(start, end, std::string("ab")) == start + 70);
+				JASS_assert(find(start, end, std::string("j")) == start + 79);
+				JASS_assert(find(start, end, std::string("")) == start);
+				JASS_assert(find(start, end, std::string("xy")) == end);
+
+				puts("simd_search::PASSED");
+				}
+		};
+	}
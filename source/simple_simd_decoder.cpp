@@ -0,0 +1,99 @@
+/*
+	SIMPLE_SIMD_DECODER.CPP
+	-----------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+#include <string.h>
+#include <immintrin.h>
+
+#include "simple_simd_decoder.h"
+
+namespace JASS
+	{
+	/*
+		SIMPLE_SIMD_DECODER::SIMPLE_SIMD_DECODER()
+		------------------------------------------
+	*/
+	simple_simd_decoder::simple_simd_decoder(std::initializer_list<std::vector<run>> layout)
+		{
+		memset(shift, 0, sizeof(shift));
+		memset(mask, 0, sizeof(mask));
+		memset(integers, 0, sizeof(integers));
+
+		size_t selector = 0;
+		for (const auto &runs : layout)
+			{
+			uint32_t lane = 0;
+			uint32_t bits_used = 0;
+			for (const auto &[count, width] : runs)
+				for (uint32_t which = 0; which < count; which++)
+					{
+					shift[selector][lane] = bits_used;
+					mask[selector][lane] = width >= 32 ? 0xFFFFFFFF : (1U << width) - 1;
+					bits_used += width;
+					lane++;
+					}
+			integers[selector] = lane;
+			if (++selector == 16)
+				break;
+			}
+		}
+
+	/*
+		SIMPLE_SIMD_DECODER::DECODE_AVX2()
+		----------------------------------
+	*/
+	JASS_TARGET_AVX2 void simple_simd_decoder::decode_avx2(const simple_simd_decoder &layout, integer *decoded, size_t integers_to_decode, const void *source)
+		{
+		const uint32_t *word = static_cast<const uint32_t *>(source);
+		integer *end = decoded + integers_to_decode;
+
+		while (decoded < end)
+			{
+			uint32_t value = *word++;
+			uint32_t selector = value & 0x0F;
+			__m256i payload = _mm256_set1_epi32(static_cast<int>(value >> 4));
+			const __m256i *shift = reinterpret_cast<const __m256i *>(layout.shift[selector]);
+			const __m256i *mask = reinterpret_cast<const __m256i *>(layout.mask[selector]);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(decoded), _mm256_and_si256(_mm256_srlv_epi32(payload, _mm256_load_si256(shift)), _mm256_load_si256(mask)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(decoded) + 1, _mm256_and_si256(_mm256_srlv_epi32(payload, _mm256_load_si256(shift + 1)), _mm256_load_si256(mask + 1)));
+			if (layout.integers[selector] > 16)
+				{
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(decoded) + 2, _mm256_and_si256(_mm256_srlv_epi32(payload, _mm256_load_si256(shift + 2)), _mm256_load_si256(mask + 2)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(decoded) + 3, _mm256_and_si256(_mm256_srlv_epi32(payload, _mm256_load_si256(shift + 3)), _mm256_load_si256(mask + 3)));
+				}
+
+			decoded += layout.integers[selector];
+			}
+		}
+
+	/*
+		SIMPLE_SIMD_DECODER::DECODE_AVX512()
+		------------------------------------
+	*/
+	JASS_TARGET_AVX512 void simple_simd_decoder::decode_avx512(const simple_simd_decoder &layout, integer *decoded, size_t integers_to_decode, const void *source)
+		{
+		const uint32_t *word = static_cast<const uint32_t *>(source);
+		integer *end = decoded + integers_to_decode;
+
+		while (decoded < end)
+			{
+			uint32_t value = *word++;
+			uint32_t selector = value & 0x0F;
+			__m512i payload = _mm512_set1_epi32(static_cast<int>(value >> 4));
+			const __m512i *shift = reinterpret_cast<const __m512i *>(layout.shift[selector]);
+			const __m512i *mask = reinterpret_cast<const __m512i *>(layout.mask[selector]);
+
+			/*
+				The zero-masked shift (all lanes selected) avoids GCC's undefined merge source, which -Wmaybe-uninitialized warns about.
+			*/
+			_mm512_storeu_si512(decoded, _mm512_and_si512(_mm512_maskz_srlv_epi32((__mmask16)0xFFFF, payload, _mm512_load_si512(shift)), _mm512_load_si512(mask)));
+			if (layout.integers[selector] > 16)
+				_mm512_storeu_si512(decoded + 16, _mm512_and_si512(_mm512_maskz_srlv_epi32((__mmask16)0xFFFF, payload, _mm512_load_si512(shift + 1)), _mm512_load_si512(mask + 1)));
+
+			decoded += layout.integers[selector];
+			}
+		}
+	}
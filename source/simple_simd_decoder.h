@@ -0,0 +1,122 @@
+/*
+	SIMPLE_SIMD_DECODER.H
+	---------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Table-driven AVX2 and AVX-512 decoders for the Simple-9 and Simple-16 codexes (chosen at runtime).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+#include <utility>
+#include <initializer_list>
+
+#include "simd.h"
+#include "compress_integer.h"
+#include "hardware_support.h"
+
+namespace JASS
+	{
+	/*
+		CLASS SIMPLE_SIMD_DECODER
+		-------------------------
+	*/
+	/*!
+		@brief Decode a Simple-9 or Simple-16 like encoding (32-bit words of 4-bit selector and 28-bit payload) using SIMD instructions.
+		@details The scalar decoders switch on the selector and extract each integer with a shift and an AND.  Here the selector is used as an index
+		into a table of shift vectors and mask vectors (one lane per integer in the word).  The payload is broadcast into every lane of a register,
+		shifted right by a per-lane amount (VPSRLVD), masked, and stored.  That's 1 or 2 (AVX-512) or 2 or 4 (AVX2) shift / AND / store triples
+		per word, and the only branch is on whether or not the word holds more than 16 integers (rather than a 9 or 16 way switch).  Lanes past
+		the number of integers in the word have a mask of 0 and are overwritten by the next word so (like the scalar decoders) this decoder writes
+		past the end of the output buffer, by up to 31 integers.
+
+		The instruction set is chosen on each call using simd::get_simd_level() (so simd::set_simd_level() can turn the AVX-512 or SIMD decoder
+		off).  If that level is below AVX2 then available() returns false and the codex must use its own scalar decoder.
+	*/
+	class simple_simd_decoder
+		{
+		public:
+			typedef compress_integer::integer integer;			///< The type of integer being decoded.
+			typedef std::pair<uint32_t, uint32_t> run;			///< A run of same-width integers in a word (count integers of width bits).
+
+		private:
+			alignas(64) uint32_t shift[16][32];		///< For each selector, the amount to shift the payload right by for each integer in the word.
+			alignas(64) uint32_t mask[16][32];		///< For each selector, the mask to AND each integer with (0 for unused lanes).
+			uint32_t integers[16];						///< For each selector, the number of integers in the word.
+
+		public:
+			/*
+				SIMPLE_SIMD_DECODER::SIMPLE_SIMD_DECODER()
+				------------------------------------------
+			*/
+			/*!
+				@brief Constructor.
+				@param layout [in] For each selector (in order) the runs of integers in the word, low bits first (e.g. {{7, 2}, {14, 1}} is 7 2-bit integers then 14 1-bit integers).
+			*/
+			simple_simd_decoder(std::initializer_list<std::vector<run>> layout);
+
+			/*
+				SIMPLE_SIMD_DECODER::AVAILABLE()
+				--------------------------------
+			*/
+			/*!
+				@brief Can this CPU use the SIMD decoder.
+				@return true if decode() can be called, false if the codex must use its own (scalar) decoder.
+			*/
+			bool available(void) const
+				{
+				return simd::get_simd_level() >= hardware_support::avx2;
+				}
+
+			/*
+				SIMPLE_SIMD_DECODER::DECODE()
+				-----------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers using the instruction set given by simd::get_simd_level() (only call this if available() returns true).
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+			*/
+			void decode(integer *decoded, size_t integers_to_decode, const void *source) const
+				{
+				if (simd::get_simd_level() >= hardware_support::avx512)
+					decode_avx512(*this, decoded, integers_to_decode, source);
+				else
+					decode_avx2(*this, decoded, integers_to_decode, source);
+				}
+
+			/*
+				SIMPLE_SIMD_DECODER::DECODE_AVX2()
+				----------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers using AVX2 instructions.
+				@param layout [in] The tables for the codex being decoded.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+			*/
+			JASS_TARGET_AVX2 static void decode_avx2(const simple_simd_decoder &layout, integer *decoded, size_t integers_to_decode, const void *source);
+
+			/*
+				SIMPLE_SIMD_DECODER::DECODE_AVX512()
+				------------------------------------
+			*/
+			/*!
+				@brief Decode a sequence of integers using AVX-512 instructions.
+				@param layout [in] The tables for the codex being decoded.
+				@param decoded [out] The sequence of decoded integers.
+				@param integers_to_decode [in] The minimum number of integers to decode (it may decode more).
+				@param source [in] The encoded integers.
+			*/
+			JASS_TARGET_AVX512 static void decode_avx512(const simple_simd_decoder &layout, integer *decoded, size_t integers_to_decode, const void *source);
+		};
+	}
@@ -0,0 +1,346 @@
+/*
+	SORT256_UINT64_T.H
+	------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief Sort an array of 64-bit unsigned integers using AVX2 bitonic sorting networks (for CPUs without AVX-512).
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "asserts.h"
+#include "forceinline.h"
+#include "hardware_support.h"
+
+namespace JASS
+	{
+	/*
+		CLASS SORT256_UINT64_T
+		----------------------
+	*/
+	/*!
+		@brief Sort an array of 64-bit unsigned integers into ascending order using AVX2 (the fallback for Sort512_uint64_t).
+		@details This is a bottom-up merge sort.  Blocks of 16 integers are sorted in 4 registers with a bitonic sorting network,
+		then runs are merged 4 integers at a time with a bitonic merge network, see:
+			J. Chhugani, A. D. Nguyen, V. W. Lee, W. Macy, M. Hagog, Y.-K. Chen, A. Baransi, S. Kumar, P. Dubey (2008), Efficient
+			implementation of sorting on multi-core SIMD CPU architecture, Proceedings of the VLDB Endowment 1(2):1313-1324.
+		AVX2 only has a signed 64-bit compare so the top bit of each integer is flipped as it is loaded into a register and flipped
+		back as it is stored.  The methods are compiled for AVX2 regardless of the compiler flags so only call them if
+		JASS::simd::get_simd_level() (or JASS::hardware_support) says the CPU has AVX2.
+	*/
+	class sort256_uint64_t
+		{
+		private:
+			static constexpr size_t block_size = 16;			///< The number of integers sorted in registers before merging starts
+
+		private:
+			/*
+				SORT256_UINT64_T::LOAD()
+				------------------------
+			*/
+			/*!
+				@brief Load 4 integers into a register, flipping the top bit so that signed comparison orders them as unsigned.
+				@param from [in] The integers.
+				@return The register.
+			*/
+			JASS_TARGET_AVX2 forceinline static __m256i load(const uint64_t *from)
+				{
+				return _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)from), _mm256_set1_epi64x((std::numeric_limits<int64_t>::min)()));
+				}
+
+			/*
+				SORT256_UINT64_T::STORE()
+				-------------------------
+			*/
+			/*!
+				@brief Store 4 integers from a register (the inverse of load()).
+				@param to [out] Where to store them.
+				@param value [in] The register.
+			*/
+			JASS_TARGET_AVX2 forceinline static void store(uint64_t *to, __m256i value)
+				{
+				_mm256_storeu_si256((__m256i *)to, _mm256_xor_si256(value, _mm256_set1_epi64x((std::numeric_limits<int64_t>::min)())));
+				}
+
+			/*
+				SORT256_UINT64_T::COMPARE_EXCHANGE()
+				------------------------------------
+			*/
+			/*!
+				@brief Lane by lane, put the smaller integer in low and the larger in high.
+				@param low [in/out] The first register, the minimums on return.
+				@param high [in/out] The second register, the maximums on return.
+			*/
+			JASS_TARGET_AVX2 forceinline static void compare_exchange(__m256i &low, __m256i &high)
+				{
+				__m256i greater = _mm256_cmpgt_epi64(low, high);
+				__m256i minimum = _mm256_blendv_epi8(low, high, greater);
+				high = _mm256_blendv_epi8(high, low, greater);
+				low = minimum;
+				}
+
+			/*
+				SORT256_UINT64_T::REVERSE()
+				---------------------------
+			*/
+			/*!
+				@brief Reverse the order of the 4 integers in a register.
+				@param value [in] The register.
+				@return The reversed register.
+			*/
+			JASS_TARGET_AVX2 forceinline static __m256i reverse(__m256i value)
+				{
+				return _mm256_permute4x64_epi64(value, _MM_SHUFFLE(0, 1, 2, 3));
+				}
+
+			/*
+				SORT256_UINT64_T::BITONIC_CLEAN()
+				---------------------------------
+			*/
+			/*!
+				@brief Sort a register that holds a bitonic sequence of 4 integers.
+				@param value [in/out] The register.
+			*/
+			JASS_TARGET_AVX2 forceinline static void bitonic_clean(__m256i &value)
+				{
+				/*
+					Compare lanes 2 apart, then lanes 1 apart
+				*/
+				__m256i other = _mm256_permute4x64_epi64(value, _MM_SHUFFLE(1, 0, 3, 2));
+				__m256i greater = _mm256_cmpgt_epi64(value, other);
+				__m256i minimum = _mm256_blendv_epi8(value, other, greater);
+				__m256i maximum = _mm256_blendv_epi8(other, value, greater);
+				value = _mm256_blend_epi32(minimum, maximum, 0xF0);
+
+				other = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+				greater = _mm256_cmpgt_epi64(value, other);
+				minimum = _mm256_blendv_epi8(value, other, greater);
+				maximum = _mm256_blendv_epi8(other, value, greater);
+				value = _mm256_blend_epi32(minimum, maximum, 0xCC);
+				}
+
+			/*
+				SORT256_UINT64_T::MERGE_4_4()
+				-----------------------------
+			*/
+			/*!
+				@brief Merge two sorted registers so that low holds the smallest 4 integers (sorted) and high the largest 4 (sorted).
+				@param low [in/out] A sorted register.
+				@param high [in/out] A sorted register.
+			*/
+			JASS_TARGET_AVX2 forceinline static void merge_4_4(__m256i &low, __m256i &high)
+				{
+				high = reverse(high);
+				compare_exchange(low, high);
+				bitonic_clean(low);
+				bitonic_clean(high);
+				}
+
+			/*
+				SORT256_UINT64_T::SORT_BLOCK()
+				------------------------------
+			*/
+			/*!
+				@brief Sort (in place) a block of block_size integers.
+				@param block [in/out] The integers.
+			*/
+			JASS_TARGET_AVX2 static void sort_block(uint64_t *block)
+				{
+				__m256i row_0 = load(block);
+				__m256i row_1 = load(block + 4);
+				__m256i row_2 = load(block + 8);
+				__m256i row_3 = load(block + 12);
+
+				/*
+					Sort the columns with a 4 element sorting network
+				*/
+				compare_exchange(row_0, row_1);
+				compare_exchange(row_2, row_3);
+				compare_exchange(row_0, row_2);
+				compare_exchange(row_1, row_3);
+				compare_exchange(row_1, row_2);
+
+				/*
+					Transpose so that each register holds one sorted column
+				*/
+				__m256i low_01 = _mm256_unpacklo_epi64(row_0, row_1);
+				__m256i high_01 = _mm256_unpackhi_epi64(row_0, row_1);
+				__m256i low_23 = _mm256_unpacklo_epi64(row_2, row_3);
+				__m256i high_23 = _mm256_unpackhi_epi64(row_2, row_3);
+				__m256i run_0 = _mm256_permute2x128_si256(low_01, low_23, 0x20);
+				__m256i run_1 = _mm256_permute2x128_si256(high_01, high_23, 0x20);
+				__m256i run_2 = _mm256_permute2x128_si256(low_01, low_23, 0x31);
+				__m256i run_3 = _mm256_permute2x128_si256(high_01, high_23, 0x31);
+
+				/*
+					Merge the 4 runs of 4 into 2 runs of 8, then those into one run of 16
+				*/
+				merge_4_4(run_0, run_1);
+				merge_4_4(run_2, run_3);
+
+				__m256i reversed_2 = reverse(run_3);
+				__m256i reversed_3 = reverse(run_2);
+				compare_exchange(run_0, reversed_2);
+				compare_exchange(run_1, reversed_3);
+				compare_exchange(run_0, run_1);
+				compare_exchange(reversed_2, reversed_3);
+				bitonic_clean(run_0);
+				bitonic_clean(run_1);
+				bitonic_clean(reversed_2);
+				bitonic_clean(reversed_3);
+
+				store(block, run_0);
+				store(block + 4, run_1);
+				store(block + 8, reversed_2);
+				store(block + 12, reversed_3);
+				}
+
+			/*
+				SORT256_UINT64_T::MERGE()
+				-------------------------
+			*/
+			/*!
+				@brief Merge two sorted runs (each a whole number of registers long, and neither empty) into one.
+				@param first [in] The first run.
+				@param first_length [in] The length of the first run.
+				@param second [in] The second run.
+				@param second_length [in] The length of the second run.
+				@param into [out] The merged run (first_length + second_length integers).
+			*/
+			JASS_TARGET_AVX2 static void merge(const uint64_t *first, size_t first_length, const uint64_t *second, size_t second_length, uint64_t *into)
+				{
+				__m256i low = load(first);
+				__m256i high = load(second);
+				size_t first_at = 4;
+				size_t second_at = 4;
+
+				while (true)
+					{
+					merge_4_4(low, high);
+					store(into, low);
+					into += 4;
+
+					/*
+						The next 4 to merge come from whichever run has the smaller next integer
+					*/
+					if (first_at < first_length && (second_at >= second_length || first[first_at] <= second[second_at]))
+						{
+						low = load(first + first_at);
+						first_at += 4;
+						}
+					else if (second_at < second_length)
+						{
+						low = load(second + second_at);
+						second_at += 4;
+						}
+					else
+						break;
+					}
+
+				store(into, high);
+				}
+
+		public:
+			/*
+				SORT256_UINT64_T::SORT()
+				------------------------
+			*/
+			/*!
+				@brief Sort an array of 64-bit unsigned integers into ascending order.
+				@details The array is padded to a whole number of blocks and sorted in a thread-local buffer that is re-used from call to call.
+				@param array [in/out] The integers to sort.
+				@param size [in] The number of integers in the array.
+			*/
+			static void sort(uint64_t *array, size_t size)
+				{
+				thread_local std::vector<uint64_t> buffer;
+
+				if (size < 2)
+					return;
+
+				size_t padded_size = (size + block_size - 1) / block_size * block_size;
+				if (buffer.size() < padded_size * 2)
+					buffer.resize(padded_size * 2);
+
+				uint64_t *from = buffer.data();
+				uint64_t *to = buffer.data() + padded_size;
+				::memcpy(from, array, size * sizeof(*array));
+				std::fill(from + size, from + padded_size, (std::numeric_limits<uint64_t>::max)());
+
+				for (size_t block = 0; block < padded_size; block += block_size)
+					sort_block(from + block);
+
+				for (size_t width = block_size; width < padded_size; width *= 2)
+					{
+					for (size_t start = 0; start < padded_size; start += width * 2)
+						{
+						size_t first_length = (std::min)(width, padded_size - start);
+						size_t second_length = (std::min)(width, padded_size - start - first_length);
+						if (second_length == 0)
+							::memcpy(to + start, from + start, first_length * sizeof(*from));
+						else
+							merge(from + start, first_length, from + start + first_length, second_length, to + start);
+						}
+					std::swap(from, to);
+					}
+
+				::memcpy(array, from, size * sizeof(*array));
+				}
+
+			/*
+				SORT256_UINT64_T::UNITTEST()
+				----------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				if (hardware_support::detected().simd() < hardware_support::avx2)
+					{
+					puts("sort256_uint64_t::PASSED (no AVX2 so not tested)");
+					return;
+					}
+
+				std::mt19937_64 random(17);
+				std::vector<size_t> sizes = {0, 1, 2, 3, 4, 5, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 999, 1000, 1001, 4096, 10'000};
+
+				for (size_t size : sizes)
+					for (uint64_t range : {(uint64_t)3, (uint64_t)1'000, (std::numeric_limits<uint64_t>::max)()})
+						{
+						/*
+							Include duplicates, the largest integer (the padding value), and integers with the top bit set
+						*/
+						std::vector<uint64_t> got(size);
+						for (auto &value : got)
+							value = range == (std::numeric_limits<uint64_t>::max)() ? random() : random() % range;
+						if (size > 2)
+							{
+							got[0] = (std::numeric_limits<uint64_t>::max)();
+							got[size / 2] = 0;
+							}
+
+						std::vector<uint64_t> expected = got;
+						std::sort(expected.begin(), expected.end());
+						sort(got.data(), got.size());
+						JASS_assert(got == expected);
+						}
+
+				puts("sort256_uint64_t::PASSED");
+				}
+		};
+	}
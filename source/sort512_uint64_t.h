@@ -49,7 +49,16 @@
 	#define __restrict__ __restrict
 #endif
 
-#ifdef  __AVX512F__
+/*
+	JASS: This file is compiled for AVX-512 regardless of the compiler flags so that a portable (AVX2) build can still use it.  Only call
+	it if JASS::simd::get_simd_level() (or JASS::hardware_support) says the CPU has AVX-512.
+*/
+#if defined(__clang__)
+	#pragma clang attribute push (__attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,bmi,bmi2,popcnt"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx512f,avx512bw,avx512dq,avx512vl,avx2,bmi,bmi2,popcnt")
+#endif
 namespace Sort512_uint64_t {
 
 
@@ -2834,5 +2843,9 @@ static inline void Sort(SortType array[], const IndexType size){
 }
 
 }
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
 #endif
 
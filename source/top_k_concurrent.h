@@ -0,0 +1,317 @@
+/*
+	TOP_K_CONCURRENT.H
+	------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@file
+	@brief A lock-free top-k that many threads can add to at once.
+	@author Andrew Trotman
+	@copyright 2026 Andrew Trotman
+*/
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "heap.h"
+#include "asserts.h"
+#include "forceinline.h"
+
+namespace JASS
+	{
+	/*
+		CLASS TOP_K_CONCURRENT
+		----------------------
+	*/
+	/*!
+		@brief A lock-free top-k of 64-bit keys that many threads can add to at once.
+		@details The keys are typically <rsv, document id> pairs packed as (rsv << 32) | document_id, so larger is better and no two
+		keys are the same.  Each thread adds through its own inserter, which keeps a thread-local insert buffer and a thread-local
+		heap of the top-k it has seen.  Keys are checked against a shared threshold (an atomic read) before they are buffered, and
+		when the buffer fills it is merged into the heap as a batch and the smallest key in the heap (once full) is published
+		to the threshold with an atomic compare-and-swap maximum.  So the only shared writes are to one atomic, once per batch.
+		As long as no document is scored by more than one thread (for example, the threads partition the document ids), the
+		k-th best key of any one thread is a lower bound on the k-th best overall, so every thread can discard anything at or below the
+		largest of them.  merge() combines the per-thread heaps into the final top-k once all the threads have finished.
+	*/
+	class top_k_concurrent
+		{
+		public:
+			/*
+				CLASS TOP_K_CONCURRENT::INSERTER
+				--------------------------------
+			*/
+			/*!
+				@brief The interface one thread uses to add to the top-k (aligned to a cache line so inserters don't share lines).
+			*/
+			class alignas(64) inserter
+				{
+				friend class top_k_concurrent;
+
+				private:
+					top_k_concurrent &parent;				///< The top-k this inserter adds to
+					std::vector<uint64_t> buffer;			///< The thread-local insert buffer
+					size_t buffer_used;						///< The number of keys in buffer
+					std::vector<uint64_t> members;		///< The thread-local top-k (a min-heap of k elements, 0 is empty)
+					heap<uint64_t> top_results;			///< The heap over members
+
+				public:
+					/*
+						TOP_K_CONCURRENT::INSERTER::INSERTER()
+						--------------------------------------
+					*/
+					/*!
+						@brief Constructor
+						@param parent [in] The top-k this inserter adds to.
+						@param buffer_size [in] The number of keys to buffer before merging them into the heap.
+					*/
+					inserter(top_k_concurrent &parent, size_t buffer_size) :
+						parent(parent),
+						buffer(buffer_size),
+						buffer_used(0),
+						members(parent.top_k),
+						top_results(members.data(), parent.top_k)
+						{
+						/* Nothing */
+						}
+
+					/*
+						TOP_K_CONCURRENT::INSERTER::INSERT()
+						------------------------------------
+					*/
+					/*!
+						@brief Add a key to the top-k (if it is larger than the threshold).
+						@param key [in] The key (which must not be 0).
+					*/
+					forceinline void insert(uint64_t key)
+						{
+						if (key <= parent.threshold.load(std::memory_order_relaxed))
+							return;
+
+						buffer[buffer_used++] = key;
+						if (buffer_used == buffer.size())
+							flush();
+						}
+
+					/*
+						TOP_K_CONCURRENT::INSERTER::FLUSH()
+						-----------------------------------
+					*/
+					/*!
+						@brief Merge the insert buffer into the thread-local heap and publish the new threshold.
+						@details This must be called once the thread has finished inserting (merge() does not do it).
+					*/
+					void flush(void)
+						{
+						/*
+							The threshold might have moved since the keys were buffered so re-read it once for the batch
+						*/
+						uint64_t bound = std::max(parent.threshold.load(std::memory_order_relaxed), members[0]);
+						for (size_t which = 0; which < buffer_used; which++)
+							if (buffer[which] > bound)
+								{
+								top_results.push_back(buffer[which]);
+								bound = std::max(bound, members[0]);
+								}
+						buffer_used = 0;
+
+						/*
+							Once the heap is full its smallest key is a lower bound on the k-th best key, so raise the threshold to it
+						*/
+						if (members[0] != 0)
+							parent.raise_threshold(members[0]);
+						}
+				};
+
+		private:
+			size_t top_k;														///< The k in top-k
+			alignas(64) std::atomic<uint64_t> threshold;				///< Keys not larger than this cannot be in the top-k
+			std::vector<std::unique_ptr<inserter>> inserters;		///< One inserter per thread
+
+		private:
+			/*
+				TOP_K_CONCURRENT::RAISE_THRESHOLD()
+				-----------------------------------
+			*/
+			/*!
+				@brief Atomically set threshold to the maximum of its current value and the given value.
+				@param value [in] The new lower bound on the k-th best key.
+			*/
+			void raise_threshold(uint64_t value)
+				{
+				uint64_t current = threshold.load(std::memory_order_relaxed);
+				while (value > current && !threshold.compare_exchange_weak(current, value, std::memory_order_relaxed))
+					{
+					/* Nothing (current has been reloaded) */
+					}
+				}
+
+		public:
+			/*
+				TOP_K_CONCURRENT::TOP_K_CONCURRENT()
+				------------------------------------
+			*/
+			/*!
+				@brief Constructor
+				@param top_k [in] The k in top-k.
+				@param threads [in] The number of threads (inserters) that will add to this object.
+				@param buffer_size [in] The number of keys each inserter buffers before merging them into its heap.
+			*/
+			top_k_concurrent(size_t top_k, size_t threads, size_t buffer_size = 64) :
+				top_k(top_k),
+				threshold(0)
+				{
+				for (size_t thread = 0; thread < threads; thread++)
+					inserters.push_back(std::make_unique<inserter>(*this, buffer_size));
+				}
+
+			/*
+				TOP_K_CONCURRENT::GET_INSERTER()
+				--------------------------------
+			*/
+			/*!
+				@brief Return the inserter for the given thread (each thread must use a different inserter).
+				@param thread [in] The thread number (from 0 to threads - 1).
+				@return The inserter.
+			*/
+			inserter &get_inserter(size_t thread)
+				{
+				return *inserters[thread];
+				}
+
+			/*
+				TOP_K_CONCURRENT::GET_THRESHOLD()
+				---------------------------------
+			*/
+			/*!
+				@brief Return the current threshold (keys not larger than this cannot be in the top-k).
+				@return The threshold (0 until one thread has seen k keys).
+			*/
+			uint64_t get_threshold(void) const
+				{
+				return threshold.load(std::memory_order_relaxed);
+				}
+
+			/*
+				TOP_K_CONCURRENT::REWIND()
+				--------------------------
+			*/
+			/*!
+				@brief Clear this object ready for re-use (not thread safe).
+			*/
+			void rewind(void)
+				{
+				threshold = 0;
+				for (auto &current : inserters)
+					{
+					current->buffer_used = 0;
+					std::fill(current->members.begin(), current->members.end(), 0);
+					}
+				}
+
+			/*
+				TOP_K_CONCURRENT::MERGE()
+				-------------------------
+			*/
+			/*!
+				@brief Merge the per-thread top-k lists into the final top-k, largest first (call once all threads have called flush()).
+				@param into [out] The top-k (up to k keys).
+			*/
+			void merge(std::vector<uint64_t> &into) const
+				{
+				into.clear();
+				uint64_t bound = threshold.load();
+				for (const auto &current : inserters)
+					for (uint64_t key : current->members)
+						if (key != 0 && key >= bound)
+							into.push_back(key);
+
+				size_t keep = std::min(top_k, into.size());
+				std::partial_sort(into.begin(), into.begin() + keep, into.end(), std::greater<uint64_t>());
+				into.resize(keep);
+				}
+
+			/*
+				TOP_K_CONCURRENT::UNITTEST_THREAD()
+				-----------------------------------
+			*/
+			/*!
+				@brief Part of the unit test, add the given keys through an inserter checking that the threshold never passes the true k-th key
+				@param into [in] The inserter to use.
+				@param keys [in] The keys to add.
+				@param kth [in] The true k-th best key over all the threads.
+				@param failures [out] Incremented if the threshold ever passes kth.
+			*/
+			static void unittest_thread(inserter &into, const std::vector<uint64_t> &keys, uint64_t kth, std::atomic<size_t> &failures)
+				{
+				for (uint64_t key : keys)
+					{
+					into.insert(key);
+					if (into.parent.get_threshold() > kth)
+						failures++;
+					}
+				into.flush();
+				}
+
+			/*
+				TOP_K_CONCURRENT::UNITTEST()
+				----------------------------
+			*/
+			/*!
+				@brief Unit test this class
+			*/
+			static void unittest(void)
+				{
+				static constexpr size_t thread_count = 8;
+				static constexpr size_t keys_per_thread = 50'000;
+				std::mt19937_64 random(7);
+
+				for (size_t top_k : {1, 10, 1000})
+					{
+					/*
+						Each thread scores its own documents (document_id % thread_count == thread), with lots of equal rsvs.
+					*/
+					std::vector<std::vector<uint64_t>> keys(thread_count);
+					std::vector<uint64_t> everything;
+					for (size_t thread = 0; thread < thread_count; thread++)
+						for (uint64_t document_id = thread; document_id < keys_per_thread * thread_count; document_id += thread_count)
+							{
+							uint64_t key = ((random() % 200 + 1) << 32) | document_id;
+							keys[thread].push_back(key);
+							everything.push_back(key);
+							}
+					std::sort(everything.begin(), everything.end(), std::greater<uint64_t>());
+					everything.resize(top_k);
+
+					/*
+						All the threads insert at once (twice, to check rewind()).
+					*/
+					top_k_concurrent shared(top_k, thread_count, 16);
+					for (size_t pass = 0; pass < 2; pass++)
+						{
+						shared.rewind();
+						std::atomic<size_t> failures(0);
+						std::vector<std::thread> thread_pool;
+						for (size_t thread = 0; thread < thread_count; thread++)
+							thread_pool.push_back(std::thread(unittest_thread, std::ref(shared.get_inserter(thread)), std::cref(keys[thread]), everything.back(), std::ref(failures)));
+						for (auto &thread : thread_pool)
+							thread.join();
+
+						std::vector<uint64_t> got;
+						shared.merge(got);
+						JASS_assert(failures == 0);
+						JASS_assert(got == everything);
+						}
+					}
+
+				puts("top_k_concurrent::PASSED");
+				}
+		};
+	}
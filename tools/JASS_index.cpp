@@ -19,19 +19,22 @@
 #include "parser.h"
 #include "version.h"
 #include "quantize.h"
+#include "reorder_bp.h"
 #include "commandline.h"
 #include "stem_porter.h"
 #include "parser_fasta.h"
 #include "serialise_ci.h"
 #include "quantize_none.h"
-#include "instream_file.h"
+#include "instream_zstd.h"
 #include "instream_memory.h"
 #include "instream_deflate.h"
 #include "compress_integer.h"
 #include "serialise_jass_v1.h"
 #include "serialise_jass_v2.h"
+#include "instream_prefetch.h"
 #include "serialise_integers.h"
 #include "parser_unicoil_json.h"
+#include "instream_file_direct.h"
 #include "instream_document_trec.h"
 #include "instream_document_fasta.h"
 #include "serialise_forward_index.h"
@@ -46,8 +49,17 @@
 bool parameter_jass_v1_index = false;
 bool parameter_jass_v2_index = false;
 bool parameter_compiled_index = false;
+size_t parameter_compiled_index_shards = 1;
 bool parameter_uint32_index = false;
 bool parameter_forward_index = false;
+bool parameter_compress_adaptive = false;
+bool parameter_compress_adaptive_cost = false;
+bool parameter_compress_elias_fano = false;
+bool parameter_compress_elias_fano_partitioned = false;
+bool parameter_compress_stream_vbyte_d1 = false;
+bool parameter_compress_blocked = false;
+bool parameter_compact_headers = false;
+bool parameter_reorder_bp = false;
 std::string parameter_filename = "";
 bool parameter_quiet = false;
 bool parameter_help = false;
@@ -89,8 +101,21 @@ auto command_line_parameters = std::make_tuple
 	JASS::commandline::parameter("-I2", "--index_jass_v2", "Generate a JASS version 2 index.", parameter_jass_v2_index),
 	JASS::commandline::parameter("-Ib", "--index_binary", "Generate a binary dump of just the postings segments.", parameter_uint32_index),
 	JASS::commandline::parameter("-Ic", "--index_compiled", "Generate a JASS compiled index.", parameter_compiled_index),
+	JASS::commandline::parameter("-Is", "--compiled_index_shards", "<n> Split the compiled index postings into <n> source files (with -Ic).", parameter_compiled_index_shards),
 	JASS::commandline::parameter("-If", "--index_forward", "Generate a forward index.", parameter_forward_index),
-	JASS::commandline::parameter("-IF", "--index_FASTA", "<k> Generate a k-mer index from FASTA documents.", parameter_fasta_kmer_length)
+	JASS::commandline::parameter("-IF", "--index_FASTA", "<k> Generate a k-mer index from FASTA documents.", parameter_fasta_kmer_length),
+
+	JASS::commandline::note("\nINDEX COMPRESSION (JASS v1 and v2 only)\n---------------------------------------"),
+	JASS::commandline::parameter("-Ca", "--compress_adaptive_cost", "Compress each segment with the codex giving the best size / decode-time trade-off (codex 'a').", parameter_compress_adaptive_cost),
+	JASS::commandline::parameter("-CA", "--compress_adaptive", "Compress each segment with the codex giving the smallest encoding (codex 'A').", parameter_compress_adaptive),
+	JASS::commandline::parameter("-Cf", "--compress_elias_fano", "Compress each segment with Elias-Fano.", parameter_compress_elias_fano),
+	JASS::commandline::parameter("-Cp", "--compress_partitioned_elias_fano", "Compress each segment with partitioned Elias-Fano.", parameter_compress_elias_fano_partitioned),
+	JASS::commandline::parameter("-CV", "--compress_stream_vbyte_d1", "Compress each segment with Stream VByte (prefix sum in the decoder).", parameter_compress_stream_vbyte_d1),
+	JASS::commandline::parameter("-Cb", "--compress_blocked", "Break long segments into blocks with docid skip entries (with any of the above).", parameter_compress_blocked),
+	JASS::commandline::parameter("-Ch", "--compact_headers", "Store the impact headers in the compact (Stream VByte) format (JASS v2 only).", parameter_compact_headers),
+
+	JASS::commandline::note("\nDOCUMENT REORDERING\n-------------------"),
+	JASS::commandline::parameter("-R", "--reorder_bp", "Reorder the document ids by recursive graph bisection (BP) before writing the index.", parameter_reorder_bp)
 	);
 
 
@@ -164,6 +189,12 @@ int main(int argc, const char *argv[])
 		exit(1);
 		}
 
+	if (parameter_compress_adaptive + parameter_compress_adaptive_cost + parameter_compress_elias_fano + parameter_compress_elias_fano_partitioned + parameter_compress_stream_vbyte_d1 > 1)
+		{
+		std::cout << "Only one index compression codex at a time (-Ca, -CA, -Cf, -Cp, or -CV)\n";
+		exit(1);
+		}
+
 	/*
 		Provide help if needed.
 	*/
@@ -216,7 +247,8 @@ int main(int argc, const char *argv[])
 	/*
 		Set up the input pipeline
 	*/
-	std::shared_ptr<JASS::instream> file(new JASS::instream_file(parameter_filename));
+	std::shared_ptr<JASS::instream> disk(new JASS::instream_file_direct(parameter_filename));
+	std::shared_ptr<JASS::instream> file(new JASS::instream_prefetch(disk));
 	JASS::instream *data_source;
 	switch (format)
 		{
@@ -235,8 +267,13 @@ int main(int argc, const char *argv[])
 				}
 			else
 				{
-				std::shared_ptr<JASS::instream> deflater(new JASS::instream_deflate(file));
-				data_source = new JASS::instream_document_unicoil_json(deflater);
+				std::shared_ptr<JASS::instream> deflater;
+				if (std::string(parameter_filename).rfind(".zst") != std::string::npos)
+					deflater = std::shared_ptr<JASS::instream>(new JASS::instream_zstd(file));
+				else
+					deflater = std::shared_ptr<JASS::instream>(new JASS::instream_deflate(file));
+				std::shared_ptr<JASS::instream> inflated(new JASS::instream_prefetch(deflater));
+				data_source = new JASS::instream_document_unicoil_json(inflated);
 				}
 			break;
 			}
@@ -358,21 +395,67 @@ int main(int argc, const char *argv[])
 
 	auto time_to_end_quantization = JASS::timer::stop(timer).nanoseconds();
 
+	/*
+		Compute the new document order (if we are reordering)
+	*/
+	std::unique_ptr<JASS::reorder_bp> reorder;
+	if (parameter_reorder_bp)
+		{
+		reorder = std::make_unique<JASS::reorder_bp>(index.get_highest_document_id());
+		index.iterate(*reorder);
+		reorder->finish();
+		}
+
+	auto time_to_end_reorder = JASS::timer::stop(timer).nanoseconds();
+
 	/*
 		Decode the export formats and encode into a vector
 	*/
 	std::vector<std::unique_ptr<JASS::index_manager::delegate>> exporters;
 	if (parameter_compiled_index)
-		exporters.push_back(std::make_unique<JASS::serialise_ci>(index.get_highest_document_id()));
-	if (parameter_jass_v1_index)
-		exporters.push_back(std::make_unique<JASS::serialise_jass_v1>(index.get_highest_document_id()));
-	if (parameter_jass_v2_index)
-		exporters.push_back(std::make_unique<JASS::serialise_jass_v2>(index.get_highest_document_id()));
+		exporters.push_back(std::make_unique<JASS::serialise_ci>(index.get_highest_document_id(), parameter_compiled_index_shards));
+	if (parameter_compress_adaptive || parameter_compress_adaptive_cost || parameter_compress_elias_fano || parameter_compress_elias_fano_partitioned || parameter_compress_stream_vbyte_d1)
+		{
+		auto codex = JASS::serialise_jass_v1::jass_v1_codex::adaptive;
+		if (parameter_compress_adaptive_cost)
+			codex = JASS::serialise_jass_v1::jass_v1_codex::adaptive_cost;
+		else if (parameter_compress_elias_fano)
+			codex = JASS::serialise_jass_v1::jass_v1_codex::elias_fano;
+		else if (parameter_compress_elias_fano_partitioned)
+			codex = JASS::serialise_jass_v1::jass_v1_codex::elias_fano_partitioned;
+		else if (parameter_compress_stream_vbyte_d1)
+			codex = JASS::serialise_jass_v1::jass_v1_codex::stream_vbyte_d1;
+		if (parameter_jass_v1_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v1>(index.get_highest_document_id(), codex, 1, parameter_compress_blocked));
+		if (parameter_jass_v2_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v2>(index.get_highest_document_id(), codex, 1, parameter_compress_blocked, parameter_compact_headers));
+		}
+	else if (parameter_compress_blocked)
+		{
+		if (parameter_jass_v1_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v1>(index.get_highest_document_id(), JASS::serialise_jass_v1::jass_v1_codex::elias_gamma_simd, 1, true));
+		if (parameter_jass_v2_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v2>(index.get_highest_document_id(), JASS::serialise_jass_v1::jass_v1_codex::elias_gamma_simd_vb, 1, true, parameter_compact_headers));
+		}
+	else
+		{
+		if (parameter_jass_v1_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v1>(index.get_highest_document_id()));
+		if (parameter_jass_v2_index)
+			exporters.push_back(std::make_unique<JASS::serialise_jass_v2>(index.get_highest_document_id(), JASS::serialise_jass_v1::jass_v1_codex::elias_gamma_simd_vb, 1, false, parameter_compact_headers));
+		}
 	if (parameter_uint32_index)
 		exporters.push_back(std::make_unique<JASS::serialise_integers>(index.get_highest_document_id()));
 	if (parameter_forward_index)
 		exporters.push_back(std::make_unique<JASS::serialise_forward_index>(index.get_highest_document_id()));
 
+	/*
+		If reordering then each exporter is given the index in the new order.
+	*/
+	if (reorder)
+		for (auto &exporter : exporters)
+			exporter = std::make_unique<JASS::reorder_bp::remap>(reorder->get_new_ids(), std::move(exporter));
+
 	/*
 		Write out the index in the desired formats.
 	*/
@@ -385,11 +468,13 @@ int main(int argc, const char *argv[])
 	auto time_to_end = JASS::timer::stop(timer).nanoseconds();
 	auto parse_time = time_to_end_parse - preamble_time;
 	auto quantization_time = time_to_end_quantization - time_to_end_parse;
-	auto serialise_time = time_to_end - time_to_end_quantization;
+	auto reorder_time = time_to_end_reorder - time_to_end_quantization;
+	auto serialise_time = time_to_end - time_to_end_reorder;
 
 	std::cout << "Preamble time    :" << preamble_time << "ns (" << preamble_time / 1000000000 << " seconds)\n";
 	std::cout << "Parse time       :" << parse_time << "ns (" << parse_time / 1000000000 << " seconds)\n";
 	std::cout << "Quantization time:" << quantization_time << "ns (" << quantization_time / 1000000000 << " seconds)\n";
+	std::cout << "Reorder time     :" << reorder_time << "ns (" << reorder_time / 1000000000 << " seconds)\n";
 	std::cout << "Serialise time   :" << serialise_time << "ns (" << serialise_time / 1000000000 << " seconds)\n";
 	std::cout << "=================\n";
 	std::cout << "Total time       :" << time_to_end << "ns (" << time_to_end / 1000000000 << " seconds)\n";
@@ -11,13 +11,13 @@
 #include <stdint.h>
 #include <immintrin.h>
 
+#include <vector>
 #include <iostream>
 
 #include "file.h"
 #include "commandline.h"
 #include "deserialised_jass_v1.h"
 #include "deserialised_jass_v2.h"
-#include "compress_integer_variable_byte.h"
 
 /*
 	PARAMETERS
@@ -179,26 +179,17 @@ void walk_index_v2(JASS::deserialised_jass_v1 &index, JASS::compress_integer &de
 			/*
 				Walk each segment
 			*/
-			uint8_t *segment_header_pointer = term.offset;
-			for (uint64_t current_segment = 0; current_segment < term.impacts; current_segment++)
-				{
-				JASS::deserialised_jass_v1::segment_header header;
-				JASS::compress_integer_variable_byte::decompress_into(&header.impact, segment_header_pointer);
-				JASS::compress_integer_variable_byte::decompress_into(&header.offset, segment_header_pointer);
-				JASS::compress_integer_variable_byte::decompress_into(&header.end, segment_header_pointer);
-				JASS::compress_integer_variable_byte::decompress_into(&header.segment_frequency, segment_header_pointer);
-
-//std::cout << "\tHEADER I: " << header.impact << '\n';
-//std::cout << "\tHEADER S: " << header.offset << '\n';
-//std::cout << "\tHEADER L: " << header.end << '\n';
-//std::cout << "\tHEADER N: " << header.segment_frequency << '\n';
-//
-//for (size_t byte = 0; byte < 8; byte++)
-//printf("%02X ", *(current_header_pointer + header.offset + byte));
-//std::cout << "\n";
+			std::vector<JASS::deserialised_jass_v1::segment_header> headers(term.impacts);
+			JASS::deserialised_jass_v1::metadata metadata = term;
+			uint32_t smallest;
+			uint32_t largest;
+			JASS::query::DOCID_TYPE document_frequency;
 
+			index.get_segment_list(headers.data(), metadata, 1, smallest, largest, document_frequency);
+			for (const auto &header : headers)
+				{
 				decompressor.set_impact(header.impact);
-				decompressor.decode_with_writer(out_stream, header.segment_frequency, segment_header_pointer + header.offset, header.end);
+				decompressor.decode_with_writer(out_stream, header.segment_frequency, index.postings() + header.offset, header.end - header.offset);
 				}
 			}
 		std::cout << '\n';
@@ -0,0 +1,504 @@
+/*
+	BENCHMARK_INTEGER_COMPRESS.CPP
+	------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@brief Benchmark the integer codexes on the impact segments of a JASS v2 index and write the results as JSON.
+	@details Each impact segment in the index is decoded (with the index's own codex) then re-encoded with each of the selected codexes.
+	For each codex the compressed size, the decoding time (in TSC cycles per integer and in GB/s of decoded 32-bit integers), and the
+	decode-and-accumulate time (decode_and_process(), as the search engine does it) are reported, along with a histogram (by segment
+	length) of size and decoding time.  Each decode is done --repeats times and the fastest is used.  The output is JSON so that codex
+	choices can be tracked per collection and per CPU.  The figures are over the segments that encoded and decoded correctly ("integers"
+	in the output), and if any segment could not be encoded or decoded incorrectly the codex is not "verified" and its figures are null.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "maths.h"
+#include "timer.h"
+#include "commandline.h"
+#include "hardware_support.h"
+#include "deserialised_jass_v2.h"
+#include "compress_integer_all.h"
+#include "compress_integer_blocked.h"
+
+constexpr size_t OVERFLOW_AMOUNT = 1024;				///< Decoders may write (and read) past the end of a sequence by up to this many integers.
+constexpr size_t HISTOGRAM_BUCKETS = 33;				///< Segments are bucketed by floor(log2(length)).
+constexpr size_t SEGMENT_ALIGNMENT = 16;				///< Each encoded segment starts on this boundary (as serialise_jass_v1 does for QMX).
+
+/*
+	CLASS SEGMENT
+	-------------
+*/
+/*!
+	@brief An impact segment from the index, decoded into d-gaps.
+*/
+class segment
+	{
+	public:
+		size_t term;								///< The term this segment belongs to (index into the list of terms).
+		JASS::query::ACCUMULATOR_TYPE impact;	///< The impact score of the segment.
+		size_t start;								///< Offset (in integers) of the d-gaps in the list of all d-gaps.
+		size_t length;								///< The number of integers in the segment.
+	};
+
+/*
+	CLASS HISTOGRAM_BUCKET
+	----------------------
+*/
+/*!
+	@brief Statistics for all the segments whose length is in the range [2^n, 2^(n+1)).
+*/
+class histogram_bucket
+	{
+	public:
+		uint64_t segments = 0;					///< The number of segments.
+		uint64_t integers = 0;					///< The number of integers in those segments.
+		uint64_t compressed_bytes = 0;		///< The size of those segments once compressed.
+		uint64_t decode_cycles = 0;			///< The (fastest) time to decode those segments.
+	};
+
+/*
+	CLASS CODEX_RESULT
+	------------------
+*/
+/*!
+	@brief The results of benchmarking one codex.
+*/
+class codex_result
+	{
+	public:
+		std::string name;															///< The name of the codex.
+		bool verified = true;													///< Did every segment encode and decode correctly.
+		uint64_t failed_segments = 0;											///< Segments that could not be encoded (or failed to decode correctly).
+		uint64_t integers = 0;													///< The number of integers in the segments that encoded and decoded correctly (all the figures are over these).
+		uint64_t compressed_bytes = 0;										///< The total size of the encoded segments.
+		uint64_t decode_cycles = 0;											///< The (fastest) total time to decode all the segments (in TSC cycles).
+		uint64_t decode_nanoseconds = 0;										///< The (fastest) total time to decode all the segments.
+		uint64_t accumulate_cycles = 0;										///< The (fastest) total time to decode and accumulate all the segments (in TSC cycles).
+		uint64_t accumulate_nanoseconds = 0;								///< The (fastest) total time to decode and accumulate all the segments.
+		std::array<histogram_bucket, HISTOGRAM_BUCKETS> histogram;		///< Statistics by segment length.
+	};
+
+/*
+	PARAMETERS
+	----------
+*/
+std::string parameter_directory = ".";				///< The directory containing the index.
+std::string parameter_output = "";					///< Write the JSON here (stdout if empty).
+size_t parameter_repeats = 3;							///< The number of times to decode each segment (the fastest is used).
+bool parameter_blocked = false;						///< Wrap each codex in compress_integer_blocked.
+size_t parameter_simd = JASS::hardware_support::avx512;	///< The highest instruction set to use (see JASS::simd::set_simd_level()).
+bool parameter_help = false;							///< Print the usage.
+
+/*
+	JSON_STRING()
+	-------------
+*/
+/*!
+	@brief Return a string as a quoted JSON string.
+	@param string [in] The string to quote.
+	@return The quoted (and escaped) string.
+*/
+std::string json_string(const std::string &string)
+	{
+	std::string answer = "\"";
+	for (const char character : string)
+		if (character == '"' || character == '\\')
+			{
+			answer += '\\';
+			answer += character;
+			}
+		else if (static_cast<unsigned char>(character) < ' ')
+			answer += ' ';
+		else
+			answer += character;
+
+	return answer + "\"";
+	}
+
+/*
+	PER_INTEGER()
+	-------------
+*/
+/*!
+	@brief Return value / integers (or 0 if there are no integers).
+	@param value [in] The total.
+	@param integers [in] The number of integers.
+	@return The average per integer.
+*/
+double per_integer(uint64_t value, uint64_t integers)
+	{
+	return integers == 0 ? 0.0 : static_cast<double>(value) / integers;
+	}
+
+/*
+	GIGABYTES_PER_SECOND()
+	----------------------
+*/
+/*!
+	@brief Return the throughput (in GB/s of decoded 32-bit integers).
+	@param integers [in] The number of integers decoded.
+	@param nanoseconds [in] The time taken.
+	@return The throughput.
+*/
+double gigabytes_per_second(uint64_t integers, uint64_t nanoseconds)
+	{
+	return nanoseconds == 0 ? 0.0 : static_cast<double>(integers * sizeof(uint32_t)) / nanoseconds;
+	}
+
+/*
+	JSON_FIGURE()
+	-------------
+*/
+/*!
+	@brief Return a figure for the JSON, or null if the codex failed verification (a codex that gets the wrong answer can't be compared).
+	@param result [in] The results for the codex.
+	@param figure [in] The figure.
+	@return The figure as a JSON value.
+*/
+std::string json_figure(const codex_result &result, double figure)
+	{
+	if (!result.verified)
+		return "null";
+
+	std::ostringstream answer;
+	answer << figure;
+	return answer.str();
+	}
+
+/*
+	BENCHMARK()
+	-----------
+*/
+/*!
+	@brief Encode, decode, and decode-and-accumulate every segment with the given codex.
+	@param codex [in] The codex to benchmark.
+	@param index [in] The index (needed for the accumulators).
+	@param segments [in] The segments.
+	@param gaps [in] The d-gaps of all the segments.
+	@param largest_impact [in] The largest impact score of each term.
+	@return The results.
+*/
+codex_result benchmark(JASS::compress_integer &codex, const JASS::deserialised_jass_v2 &index, const std::vector<segment> &segments, const std::vector<uint32_t> &gaps, const std::vector<JASS::query::ACCUMULATOR_TYPE> &largest_impact)
+	{
+	codex_result result;
+	size_t longest = 0;
+	for (const auto &current : segments)
+		longest = JASS::maths::maximum(longest, current.length);
+
+	/*
+		Encode each segment (one after the other) into encoded
+	*/
+	std::vector<uint8_t> scratch((longest + OVERFLOW_AMOUNT) * sizeof(uint32_t) * 2);
+	std::vector<uint8_t> encoded;
+	std::vector<size_t> offset(segments.size());
+	std::vector<size_t> size(segments.size());
+	std::vector<bool> usable(segments.size(), true);
+	for (size_t which = 0; which < segments.size(); which++)
+		{
+		const auto &current = segments[which];
+		offset[which] = encoded.size();
+		size_t took = codex.encode(scratch.data(), scratch.size(), gaps.data() + current.start, current.length);
+		if (took == 0)
+			{
+			usable[which] = false;
+			result.verified = false;
+			result.failed_segments++;
+			continue;
+			}
+		size[which] = took;
+		encoded.insert(encoded.end(), scratch.data(), scratch.data() + took);
+		encoded.resize((encoded.size() + SEGMENT_ALIGNMENT - 1) / SEGMENT_ALIGNMENT * SEGMENT_ALIGNMENT);		// some codexes (QMX) need aligned input
+		}
+	encoded.resize(encoded.size() + OVERFLOW_AMOUNT * sizeof(uint32_t));		// decoders can read past the end
+
+	/*
+		Decode each segment, keeping the fastest of the repeats, and check that it decoded correctly.  Segments that fail are left
+		out of all the figures (including decode and accumulate, below) so that the figures are over the same integers.
+	*/
+	std::vector<uint32_t> decoded(longest + OVERFLOW_AMOUNT);
+	for (size_t which = 0; which < segments.size(); which++)
+		{
+		if (!usable[which])
+			continue;
+
+		const auto &current = segments[which];
+		uint64_t fastest_cycles = (std::numeric_limits<uint64_t>::max)();
+		uint64_t fastest_nanoseconds = (std::numeric_limits<uint64_t>::max)();
+		for (size_t repeat = 0; repeat < parameter_repeats; repeat++)
+			{
+			auto timer = JASS::timer::start();
+			uint64_t start = __rdtsc();
+			codex.decode(decoded.data(), current.length, encoded.data() + offset[which], size[which]);
+			uint64_t cycles = __rdtsc() - start;
+			uint64_t nanoseconds = JASS::timer::stop(timer).nanoseconds();
+
+			fastest_cycles = JASS::maths::minimum(fastest_cycles, cycles);
+			fastest_nanoseconds = JASS::maths::minimum(fastest_nanoseconds, nanoseconds);
+			}
+
+		if (memcmp(decoded.data(), gaps.data() + current.start, current.length * sizeof(uint32_t)) != 0)
+			{
+			result.verified = false;
+			result.failed_segments++;
+			usable[which] = false;
+			continue;
+			}
+
+		auto &bucket = result.histogram[JASS::maths::floor_log2(current.length)];
+		bucket.segments++;
+		bucket.integers += current.length;
+		bucket.compressed_bytes += size[which];
+		bucket.decode_cycles += fastest_cycles;
+		result.integers += current.length;
+		result.compressed_bytes += size[which];
+		result.decode_cycles += fastest_cycles;
+		result.decode_nanoseconds += fastest_nanoseconds;
+		}
+
+	/*
+		Decode and accumulate (each term as a single term query), keeping the fastest of the repeats
+	*/
+	codex.init(index.primary_keys(), index.document_count());
+	result.accumulate_cycles = (std::numeric_limits<uint64_t>::max)();
+	result.accumulate_nanoseconds = (std::numeric_limits<uint64_t>::max)();
+	for (size_t repeat = 0; repeat < parameter_repeats; repeat++)
+		{
+		uint64_t cycles = 0;
+		uint64_t nanoseconds = 0;
+		size_t which = 0;
+		while (which < segments.size())
+			{
+			size_t term = segments[which].term;
+			codex.rewind(1, 1, largest_impact[term]);
+
+			auto timer = JASS::timer::start();
+			uint64_t start = __rdtsc();
+			for (; which < segments.size() && segments[which].term == term; which++)
+				if (usable[which])
+					codex.decode_and_process(segments[which].impact, segments[which].length, encoded.data() + offset[which], size[which]);
+			cycles += __rdtsc() - start;
+			nanoseconds += JASS::timer::stop(timer).nanoseconds();
+			}
+		result.accumulate_cycles = JASS::maths::minimum(result.accumulate_cycles, cycles);
+		result.accumulate_nanoseconds = JASS::maths::minimum(result.accumulate_nanoseconds, nanoseconds);
+		}
+
+	return result;
+	}
+
+/*
+	WRITE_JSON()
+	------------
+*/
+/*!
+	@brief Write the results as JSON.
+	@param out [in] The stream to write to.
+	@param index_codex [in] The name of the codex used by the index.
+	@param terms [in] The number of terms in the index.
+	@param segments [in] The number of segments in the index.
+	@param integers [in] The number of integers in the index.
+	@param results [in] The results for each codex.
+*/
+void write_json(std::ostream &out, const std::string &index_codex, size_t terms, size_t segments, uint64_t integers, const std::vector<codex_result> &results)
+	{
+	static const char *simd_names[] = {"scalar", "avx2", "avx512"};
+
+	out << "{\n";
+	out << "\t\"index\": " << json_string(parameter_directory) << ",\n";
+	out << "\t\"index_codex\": " << json_string(index_codex) << ",\n";
+	out << "\t\"cpu\": " << json_string(JASS::hardware_support::detected().brand) << ",\n";
+	out << "\t\"simd\": " << json_string(simd_names[JASS::simd::get_simd_level()]) << ",\n";
+	out << "\t\"repeats\": " << parameter_repeats << ",\n";
+	out << "\t\"terms\": " << terms << ",\n";
+	out << "\t\"segments\": " << segments << ",\n";
+	out << "\t\"integers\": " << integers << ",\n";
+	out << "\t\"codexes\":\n\t[\n";
+
+	for (size_t which = 0; which < results.size(); which++)
+		{
+		const auto &result = results[which];
+		out << "\t\t{\n";
+		out << "\t\t\"name\": " << json_string(result.name) << ",\n";
+		out << "\t\t\"verified\": " << (result.verified ? "true" : "false") << ",\n";
+		out << "\t\t\"failed_segments\": " << result.failed_segments << ",\n";
+		out << "\t\t\"integers\": " << result.integers << ",\n";
+		out << "\t\t\"compressed_bytes\": " << result.compressed_bytes << ",\n";
+		out << "\t\t\"bits_per_integer\": " << json_figure(result, per_integer(result.compressed_bytes * 8, result.integers)) << ",\n";
+		out << "\t\t\"decode_cycles_per_integer\": " << json_figure(result, per_integer(result.decode_cycles, result.integers)) << ",\n";
+		out << "\t\t\"decode_gigabytes_per_second\": " << json_figure(result, gigabytes_per_second(result.integers, result.decode_nanoseconds)) << ",\n";
+		out << "\t\t\"decode_and_accumulate_cycles_per_integer\": " << json_figure(result, per_integer(result.accumulate_cycles, result.integers)) << ",\n";
+		out << "\t\t\"decode_and_accumulate_gigabytes_per_second\": " << json_figure(result, gigabytes_per_second(result.integers, result.accumulate_nanoseconds)) << ",\n";
+		out << "\t\t\"histogram\":\n\t\t\t[\n";
+
+		bool first = true;
+		for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+			{
+			const auto &row = result.histogram[bucket];
+			if (row.segments == 0)
+				continue;
+			out << (first ? "" : ",\n");
+			out << "\t\t\t{\"min_length\": " << (1ULL << bucket) << ", \"max_length\": " << (1ULL << (bucket + 1)) - 1;
+			out << ", \"segments\": " << row.segments << ", \"integers\": " << row.integers << ", \"compressed_bytes\": " << row.compressed_bytes;
+			out << ", \"bits_per_integer\": " << per_integer(row.compressed_bytes * 8, row.integers);
+			out << ", \"decode_cycles_per_integer\": " << per_integer(row.decode_cycles, row.integers) << "}";
+			first = false;
+			}
+
+		out << "\n\t\t\t]\n";
+		out << "\t\t}" << (which == results.size() - 1 ? "" : ",") << "\n";
+		}
+
+	out << "\t]\n";
+	out << "}\n";
+	}
+
+/*
+	USAGE()
+	-------
+*/
+/*!
+	@brief Print the usage line
+*/
+template <typename TYPE>
+uint8_t usage(const std::string &exename, TYPE &parameters)
+	{
+	std::cout << JASS::commandline::usage(exename, parameters) << "\n";
+	return 1;
+	}
+
+/*
+	MAIN()
+	------
+*/
+int main(int argc, const char *argv[])
+	{
+	/*
+		Parse the command line
+	*/
+	std::array<bool, JASS::compress_integer_all::compressors_size> selectors = {};
+	auto parameters = std::tuple_cat
+		(
+		std::make_tuple
+			(
+			JASS::commandline::parameter("-?", "--help", "Print this help.", parameter_help),
+			JASS::commandline::parameter("-d", "--directory", "<directory> The directory containing the JASS v2 index (default = .)", parameter_directory),
+			JASS::commandline::parameter("-o", "--output", "<filename> Write the JSON to this file (default = stdout)", parameter_output),
+			JASS::commandline::parameter("-r", "--repeats", "<n> Decode each segment n times and use the fastest (default = 3)", parameter_repeats),
+			JASS::commandline::parameter("-B", "--blocked", "Break long segments into blocks with skip entries (compress_integer_blocked)", parameter_blocked),
+			JASS::commandline::parameter("-s", "--simd", "<level> The highest instruction set to use, 0=scalar, 1=AVX2, 2=AVX-512 (default = best available)", parameter_simd),
+			JASS::commandline::note("\nCOMPRESSORS (default = all)\n---------------------------")
+			),
+		JASS::compress_integer_all::parameterlist(selectors)
+		);
+
+	std::string errors;
+	if (!JASS::commandline::parse(argc, argv, parameters, errors))
+		{
+		std::cout << errors;
+		return 1;
+		}
+	if (parameter_help || parameter_repeats == 0)
+		return usage(argv[0], parameters);
+	JASS::simd::set_simd_level(static_cast<JASS::hardware_support::simd_level>((std::min)(parameter_simd, static_cast<size_t>(JASS::hardware_support::avx512))));
+
+	/*
+		Read the index
+	*/
+	JASS::deserialised_jass_v2 index(false);
+	if (index.read_index(parameter_directory) == 0)
+		exit(printf("Cannot read a JASS v2 index from %s\n", parameter_directory.c_str()));
+
+	std::string index_codex;
+	int32_t d_ness;
+	std::unique_ptr<JASS::compress_integer> decoder = index.codex(index_codex, d_ness);
+
+	/*
+		Decode every impact segment into d-gaps
+	*/
+	std::vector<segment> segments;
+	std::vector<uint32_t> gaps;
+	std::vector<JASS::query::ACCUMULATOR_TYPE> largest_impact;
+	std::vector<JASS::deserialised_jass_v1::segment_header> headers;
+	std::vector<uint32_t> decoded;
+	uint64_t integers = 0;
+	size_t terms = 0;
+	for (const auto &term : index)
+		{
+		auto metadata = term;
+		uint32_t smallest;
+		uint32_t largest;
+		JASS::query::DOCID_TYPE document_frequency;
+
+		headers.resize(metadata.impacts);
+		size_t count = index.get_segment_list(headers.data(), metadata, 1, smallest, largest, document_frequency);
+		largest_impact.push_back(static_cast<JASS::query::ACCUMULATOR_TYPE>(largest));
+
+		for (size_t which = 0; which < count; which++)
+			{
+			const auto &header = headers[which];
+			decoded.resize(header.segment_frequency + OVERFLOW_AMOUNT);
+			decoder->decode(decoded.data(), header.segment_frequency, index.postings() + header.offset, header.end - header.offset);
+
+			segments.push_back(segment{terms, static_cast<JASS::query::ACCUMULATOR_TYPE>(header.impact), gaps.size(), header.segment_frequency});
+			gaps.insert(gaps.end(), decoded.data(), decoded.data() + header.segment_frequency);
+			integers += header.segment_frequency;
+			}
+		terms++;
+		}
+
+	/*
+		Benchmark each selected codex (or all of them if none are selected)
+	*/
+	bool any = false;
+	for (const auto selected : selectors)
+		any |= selected;
+
+	std::vector<codex_result> results;
+	for (size_t which = 0; which < JASS::compress_integer_all::compressors_size; which++)
+		if (selectors[which] || !any)
+			{
+			std::array<bool, JASS::compress_integer_all::compressors_size> one = {};
+			one[which] = true;
+
+			std::unique_ptr<JASS::compress_integer> codex = JASS::compress_integer_all::compressor(one);
+			std::string name = JASS::compress_integer_all::name(one);
+			if (parameter_blocked)
+				{
+				codex = std::make_unique<JASS::compress_integer_blocked>(std::move(codex));
+				name = "Blocked " + name;
+				}
+
+			std::cerr << "Benchmarking " << name << "\n";
+			results.push_back(benchmark(*codex, index, segments, gaps, largest_impact));
+			results.back().name = name;
+			if (!results.back().verified)
+				std::cerr << name << " failed on " << results.back().failed_segments << " of " << segments.size() << " segments, its figures are invalid\n";
+			}
+
+	/*
+		Write the results
+	*/
+	if (parameter_output == "")
+		write_json(std::cout, index_codex, terms, segments.size(), integers, results);
+	else
+		{
+		std::ofstream out(parameter_output);
+		write_json(out, index_codex, terms, segments.size(), integers, results);
+		}
+
+	return 0;
+	}
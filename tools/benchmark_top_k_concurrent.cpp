@@ -0,0 +1,186 @@
+/*
+	BENCHMARK_TOP_K_CONCURRENT.CPP
+	------------------------------
+	Copyright (c) 2026 Andrew Trotman
+	Released under the 2-clause BSD license (See:https://en.wikipedia.org/wiki/BSD_licenses)
+*/
+/*!
+	@brief Benchmark top_k_concurrent against per-thread heaps merged at the end.
+	@details Each thread scores its own documents (document_id % threads == thread) and adds a <rsv, document id> key for each to the
+	top-k.  The rsvs are skewed (most documents score low, few score high) as they are in a search engine.  The baseline gives each
+	thread its own heap (checked against only that heap's smallest key) and merges the heaps once the threads are done.  top_k_concurrent
+	also checks each key against the shared threshold and adds to its heap in batches.  Each method is run --repeats times and the
+	fastest is reported.
+*/
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "heap.h"
+#include "timer.h"
+#include "commandline.h"
+#include "top_k_concurrent.h"
+
+/*
+	PARAMETERS
+	----------
+*/
+size_t parameter_threads = 8;							///< The number of threads.
+size_t parameter_top_k = 10;							///< The k in top-k.
+size_t parameter_keys = 1'000'000;					///< The number of keys each thread adds.
+size_t parameter_buffer = 64;							///< The size of the top_k_concurrent insert buffer.
+size_t parameter_repeats = 5;							///< The number of times to run each method (the fastest is used).
+bool parameter_help = false;							///< Print the usage.
+
+/*
+	PER_THREAD_HEAP()
+	-----------------
+*/
+/*!
+	@brief The baseline, add the keys to a heap local to this thread.
+	@param keys [in] The keys to add.
+	@param members [out] The array the heap is kept in (k elements, all 0 on entry).
+*/
+void per_thread_heap(const std::vector<uint64_t> &keys, std::vector<uint64_t> &members)
+	{
+	JASS::heap<uint64_t> top_results(members.data(), members.size());
+	for (uint64_t key : keys)
+		if (key > members[0])
+			top_results.push_back(key);
+	}
+
+/*
+	SHARED_HEAP()
+	-------------
+*/
+/*!
+	@brief Add the keys to a top_k_concurrent through the given inserter.
+	@param keys [in] The keys to add.
+	@param into [in] The inserter to use.
+*/
+void shared_heap(const std::vector<uint64_t> &keys, JASS::top_k_concurrent::inserter &into)
+	{
+	for (uint64_t key : keys)
+		into.insert(key);
+	into.flush();
+	}
+
+/*
+	USAGE()
+	-------
+*/
+/*!
+	@brief Print the usage line
+*/
+template <typename TYPE>
+uint8_t usage(const std::string &exename, TYPE &parameters)
+	{
+	std::cout << JASS::commandline::usage(exename, parameters) << "\n";
+	return 1;
+	}
+
+/*
+	MAIN()
+	------
+*/
+int main(int argc, const char *argv[])
+	{
+	/*
+		Parse the command line
+	*/
+	auto parameters = std::make_tuple
+		(
+		JASS::commandline::parameter("-?", "--help", "Print this help.", parameter_help),
+		JASS::commandline::parameter("-t", "--threads", "<n> The number of threads (default = 8)", parameter_threads),
+		JASS::commandline::parameter("-k", "--top-k", "<k> The number of results to keep (default = 10)", parameter_top_k),
+		JASS::commandline::parameter("-n", "--keys", "<n> The number of keys each thread adds (default = 1000000)", parameter_keys),
+		JASS::commandline::parameter("-b", "--buffer", "<n> The size of the insert buffer (default = 64)", parameter_buffer),
+		JASS::commandline::parameter("-r", "--repeats", "<n> Run each method n times and use the fastest (default = 5)", parameter_repeats)
+		);
+
+	std::string errors;
+	if (!JASS::commandline::parse(argc, argv, parameters, errors))
+		{
+		std::cout << errors;
+		return 1;
+		}
+	if (parameter_help || parameter_threads == 0 || parameter_top_k == 0 || parameter_buffer == 0 || parameter_repeats == 0)
+		return usage(argv[0], parameters);
+
+	/*
+		Generate the keys, rsvs are skewed so that most documents have a low score
+	*/
+	std::mt19937_64 random(42);
+	std::geometric_distribution<uint64_t> rsv(0.05);
+	std::vector<std::vector<uint64_t>> keys(parameter_threads);
+	for (size_t thread = 0; thread < parameter_threads; thread++)
+		for (uint64_t document_id = thread; document_id < parameter_keys * parameter_threads; document_id += parameter_threads)
+			keys[thread].push_back(((std::min<uint64_t>)(rsv(random), 0xFFFF) + 1) << 32 | document_id);
+
+	/*
+		Per-thread heaps merged at the end
+	*/
+	uint64_t fastest_baseline = (std::numeric_limits<uint64_t>::max)();
+	std::vector<uint64_t> baseline_results;
+	for (size_t repeat = 0; repeat < parameter_repeats; repeat++)
+		{
+		std::vector<std::vector<uint64_t>> members(parameter_threads, std::vector<uint64_t>(parameter_top_k));
+		std::vector<std::thread> thread_pool;
+
+		auto timer = JASS::timer::start();
+		for (size_t thread = 0; thread < parameter_threads; thread++)
+			thread_pool.push_back(std::thread(per_thread_heap, std::cref(keys[thread]), std::ref(members[thread])));
+		for (auto &thread : thread_pool)
+			thread.join();
+
+		baseline_results.clear();
+		for (const auto &heap : members)
+			for (uint64_t key : heap)
+				if (key != 0)
+					baseline_results.push_back(key);
+		size_t keep = (std::min)(parameter_top_k, baseline_results.size());
+		std::partial_sort(baseline_results.begin(), baseline_results.begin() + keep, baseline_results.end(), std::greater<uint64_t>());
+		baseline_results.resize(keep);
+		fastest_baseline = (std::min)(fastest_baseline, static_cast<uint64_t>(JASS::timer::stop(timer).nanoseconds()));
+		}
+
+	/*
+		top_k_concurrent
+	*/
+	uint64_t fastest_shared = (std::numeric_limits<uint64_t>::max)();
+	std::vector<uint64_t> shared_results;
+	JASS::top_k_concurrent shared(parameter_top_k, parameter_threads, parameter_buffer);
+	for (size_t repeat = 0; repeat < parameter_repeats; repeat++)
+		{
+		shared.rewind();
+		std::vector<std::thread> thread_pool;
+
+		auto timer = JASS::timer::start();
+		for (size_t thread = 0; thread < parameter_threads; thread++)
+			thread_pool.push_back(std::thread(shared_heap, std::cref(keys[thread]), std::ref(shared.get_inserter(thread))));
+		for (auto &thread : thread_pool)
+			thread.join();
+		shared.merge(shared_results);
+		fastest_shared = (std::min)(fastest_shared, static_cast<uint64_t>(JASS::timer::stop(timer).nanoseconds()));
+		}
+
+	/*
+		Report
+	*/
+	if (shared_results != baseline_results)
+		exit(printf("FAILED: top_k_concurrent and the per-thread heaps give different results\n"));
+
+	printf("threads:%zu k:%zu keys/thread:%zu buffer:%zu\n", parameter_threads, parameter_top_k, parameter_keys, parameter_buffer);
+	printf("per-thread heaps : %10llu ns\n", static_cast<unsigned long long>(fastest_baseline));
+	printf("top_k_concurrent : %10llu ns\n", static_cast<unsigned long long>(fastest_shared));
+
+	return 0;
+	}
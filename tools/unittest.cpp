@@ -33,6 +33,7 @@
 #include "binary_tree.h"
 #include "commandline.h"
 #include "pointer_box.h"
+#include "simd_search.h"
 #include "evaluate_map.h"
 #include "serialise_ci.h"
 #include "hash_pearson.h"
@@ -45,29 +46,41 @@
 #include "allocator_cpp.h"
 #include "instream_file.h"
 #include "index_manager.h"
+#include "instream_zstd.h"
 #include "query_maxblock.h"
 #include "allocator_pool.h"
 #include "index_postings.h"
 #include "accumulator_2d.h"
 #include "channel_buffer.h"
 #include "instream_memory.h"
+#include "query_histogram.h"
 #include "run_export_trec.h"
 #include "evaluate_recall.h"
+#include "hash_table_open.h"
 #include "hardware_support.h"
+#include "query_heap_clean.h"
 #include "allocator_memory.h"
 #include "ranking_function.h"
+#include "instream_deflate.h"
+#include "top_k_concurrent.h"
 #include "serialise_jass_v1.h"
+#include "serialise_jass_v2.h"
+#include "instream_prefetch.h"
 #include "serialise_integers.h"
+#include "accumulator_sparse.h"
 #include "evaluate_precision.h"
 #include "instream_file_star.h"
 #include "parser_unicoil_json.h"
 #include "query_maxblock_heap.h"
+#include "query_heap_overflow.h"
 #include "accumulator_counter.h"
 #include "compress_integer_all.h"
+#include "instream_file_direct.h"
 #include "evaluate_buying_power.h"
 #include "compress_integer_none.h"
 #include "index_postings_impact.h"
 #include "compress_general_zlib.h"
+#include "compress_general_zstd.h"
 #include "instream_document_trec.h"
 #include "instream_document_warc.h"
 #include "evaluate_selling_power.h"
@@ -77,6 +90,12 @@
 #include "index_manager_sequential.h"
 #include "compress_integer_carry_8b.h"
 #include "compress_integer_simple_9.h"
+#include "compress_integer_adaptive.h"
+#include "compress_integer_elias_fano.h"
+#include "compress_integer_elias_fano_partitioned.h"
+#include "compress_integer_blocked.h"
+#include "compress_integer_stream_vbyte_d1.h"
+#include "reorder_bp.h"
 #include "evaluate_relevant_returned.h"
 #include "compress_integer_simple_8b.h"
 #include "compress_integer_simple_16.h"
@@ -144,6 +163,12 @@ int main(void)
 		puts("query_term_list");
 		JASS::query_term_list::unittest();
 
+		puts("instream_deflate");
+		JASS::instream_deflate::unittest();
+
+		puts("instream_zstd");
+		JASS::instream_zstd::unittest();
+
 		puts("instream_directory_iterator");
 		JASS::instream_directory_iterator::unittest();
 
@@ -156,6 +181,24 @@ int main(void)
 		puts("compress_integer_elias_gamma_simd_vb");
 		JASS::compress_integer_elias_gamma_simd_vb::unittest();
 
+		puts("compress_integer_adaptive");
+		JASS::compress_integer_adaptive::unittest();
+
+		puts("compress_integer_elias_fano");
+		JASS::compress_integer_elias_fano::unittest();
+
+		puts("compress_integer_elias_fano_partitioned");
+		JASS::compress_integer_elias_fano_partitioned::unittest();
+
+		puts("compress_integer_blocked");
+		JASS::compress_integer_blocked::unittest();
+
+		puts("compress_integer_stream_vbyte_d1");
+		JASS::compress_integer_stream_vbyte_d1::unittest();
+
+		puts("reorder_bp");
+		JASS::reorder_bp::unittest();
+
 		puts("beap");
 		JASS::beap<int>::unittest();
 		
@@ -212,6 +255,9 @@ int main(void)
 		puts("accumulator_counter_interleaved");
 		JASS::accumulator_counter_interleaved<uint32_t, 1, 8>::unittest();
 
+		puts("accumulator_sparse");
+		JASS::accumulator_sparse<uint32_t>::unittest();
+
 		puts("stem_porter");
 		JASS::stem_porter::unittest();
 
@@ -341,9 +387,18 @@ int main(void)
 		puts("instream_file_star");
 		JASS::instream_file_star::unittest();
 
+		puts("instream_file_direct");
+		JASS::instream_file_direct::unittest();
+
 		puts("instream_memory");
 		JASS::instream_memory::unittest();
 
+		puts("instream_prefetch");
+		JASS::instream_prefetch::unittest();
+
+		puts("simd_search");
+		JASS::simd_search::unittest();
+
 		puts("instream_document_trec");
 		JASS::instream_document_trec::unittest();
 
@@ -385,6 +440,9 @@ int main(void)
 		puts("hash_table");
 		JASS::hash_table<JASS::slice, JASS::slice>::unittest();
 
+		puts("hash_table_open");
+		JASS::hash_table_open<JASS::slice, JASS::slice>::unittest();
+
 		puts("dynamic_array");
 		JASS::dynamic_array<JASS::slice>::unittest();
 
@@ -406,6 +464,9 @@ int main(void)
 		puts("serialise_jass_v1");
 		JASS::serialise_jass_v1::unittest();
 
+		puts("serialise_jass_v2");
+		JASS::serialise_jass_v2::unittest();
+
 		puts("serialise_integers");
 		JASS::serialise_integers::unittest();
 
@@ -484,15 +545,27 @@ int main(void)
 		puts("top_k_heap");
 		JASS::top_k_heap<int>::unittest();
 
+		puts("top_k_concurrent");
+		JASS::top_k_concurrent::unittest();
+
 		puts("query_heap");
 		JASS::query_heap::unittest();
 
+		puts("query_heap_clean");
+		JASS::query_heap_clean::unittest();
+
 		puts("query_maxblock");
 		JASS::query_maxblock::unittest();
 
 		puts("query_maxblock_heap");
 		JASS::query_maxblock_heap::unittest();
 
+		puts("query_heap_overflow");
+		JASS::query_heap_overflow::unittest();
+
+		puts("query_histogram");
+		JASS::query_histogram::unittest();
+
 		puts("query_bucket");
 		JASS::query_bucket::unittest();
 
@@ -508,6 +581,9 @@ int main(void)
 		puts("compress_general_zlib");
 		JASS::compress_general_zlib::unittest();
 
+		puts("compress_general_zstd");
+		JASS::compress_general_zstd::unittest();
+
 		puts("ALL UNIT TESTS HAVE PASSED");
 		failed = false;
 		}